@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#pragma once
+
+#include "ofMain.h"
+
+#include <chrono>
+#include <random>
+
+/// simple wall clock timer in microseconds
+class BenchmarkTimer {
+
+	public:
+	
+		BenchmarkTimer() {start();}
+	
+		/// restart the timer
+		void start() {
+			begin = std::chrono::steady_clock::now();
+		}
+	
+		/// get the elapsed time in microseconds
+		double elapsed() {
+			std::chrono::duration<double, std::micro> d = std::chrono::steady_clock::now() - begin;
+			return d.count();
+		}
+	
+	protected:
+	
+		std::chrono::steady_clock::time_point begin;
+};
+
+/// one benchmark measurement, timing samples are in microseconds
+struct BenchmarkResult {
+	std::string name;     //< benchmark name
+	std::string lang;     //< buffer language
+	int lines;            //< buffer lines
+	int chars;            //< buffer chars
+	float comments;       //< comment line density 0-1
+	float strings;        //< string line density 0-1
+	std::vector<double> samples; //< per operation time in microseconds
+	double bytes;         //< bytes processed per sample, 0 if not a throughput test
+	std::map<std::string, double> extra; //< additional named values
+	
+	BenchmarkResult() : lines(0), chars(0), comments(0), strings(0), bytes(0) {}
+	
+	/// get a percentile 0-100 of the samples
+	double percentile(float p) const {
+		if(samples.empty()) {return 0;}
+		std::vector<double> sorted = samples;
+		std::sort(sorted.begin(), sorted.end());
+		size_t i = ofClamp(p/100.0f * (sorted.size()-1) + 0.5f, 0, sorted.size()-1);
+		return sorted[i];
+	}
+	
+	/// get the mean of the samples
+	double mean() const {
+		if(samples.empty()) {return 0;}
+		double sum = 0;
+		for(auto s : samples) {sum += s;}
+		return sum / samples.size();
+	}
+};
+
+/// collects benchmark results & writes them as JSON
+class BenchmarkReport {
+
+	public:
+	
+		/// add a result
+		void add(const BenchmarkResult &result) {
+			results.push_back(result);
+			ofLogNotice("benchmark") << result.name << " " << result.lang << " "
+				<< result.lines << " lines: mean " << result.mean() << " us p95 "
+				<< result.percentile(95) << " us";
+		}
+	
+		/// get the report as JSON
+		std::string toJson(const std::map<std::string, std::string> &info) {
+			std::ostringstream json;
+			json.precision(10);
+			json << "{\n";
+			json << "\t\"version\": 1,\n";
+			for(auto &i : info) {
+				json << "\t\"" << escape(i.first) << "\": \"" << escape(i.second) << "\",\n";
+			}
+			json << "\t\"results\": [\n";
+			for(size_t i = 0; i < results.size(); ++i) {
+				const BenchmarkResult &r = results[i];
+				json << "\t\t{"
+				     << "\"name\": \"" << escape(r.name) << "\", "
+				     << "\"lang\": \"" << escape(r.lang) << "\", "
+				     << "\"lines\": " << r.lines << ", "
+				     << "\"chars\": " << r.chars << ", "
+				     << "\"comments\": " << r.comments << ", "
+				     << "\"strings\": " << r.strings << ", "
+				     << "\"samples\": " << r.samples.size() << ", "
+				     << "\"mean_us\": " << r.mean() << ", "
+				     << "\"median_us\": " << r.percentile(50) << ", "
+				     << "\"p95_us\": " << r.percentile(95) << ", "
+				     << "\"min_us\": " << r.percentile(0) << ", "
+				     << "\"max_us\": " << r.percentile(100);
+				if(r.bytes > 0 && r.mean() > 0) {
+					json << ", \"mb_per_s\": " << (r.bytes / r.mean()); // bytes/us == MB/s
+				}
+				for(auto &e : r.extra) {
+					json << ", \"" << escape(e.first) << "\": " << e.second;
+				}
+				json << "}" << (i+1 < results.size() ? "," : "") << "\n";
+			}
+			json << "\t]\n";
+			json << "}\n";
+			return json.str();
+		}
+	
+	protected:
+	
+		/// escape a JSON string
+		static std::string escape(const std::string &s) {
+			std::string out;
+			for(auto c : s) {
+				switch(c) {
+					case '"':  out += "\\\""; break;
+					case '\\': out += "\\\\"; break;
+					case '\n': out += "\\n"; break;
+					case '\t': out += "\\t"; break;
+					default:   out += c; break;
+				}
+			}
+			return out;
+		}
+	
+		std::vector<BenchmarkResult> results;
+};
+
+/// synthetic source buffer generator, reproducible for a given seed
+class BenchmarkSource {
+
+	public:
+	
+		enum Lang {
+			LUA,
+			GLSL
+		};
+	
+		/// generate a buffer with a number of lines, comments & strings are the
+		/// fraction of lines (0-1) which are comments or contain strings
+		static std::string generate(Lang lang, int lines, float comments, float strings, unsigned int seed=1) {
+			std::mt19937 rng(seed);
+			std::uniform_real_distribution<float> chance(0, 1);
+			std::ostringstream s;
+			int block = 0; // lines left in current function body
+			for(int i = 0; i < lines; ++i) {
+				int n = rng() % 1000;
+				
+				// function bodies of 10 lines for nesting & matching chars
+				if(block == 0 && i+10 < lines) {
+					s << (lang == LUA ? "function fn" : "void fn") << i
+					  << (lang == LUA ? "(a, b)\n" : "(vec2 a, float b) {\n");
+					block = 9;
+					continue;
+				}
+				if(block == 1) {
+					s << (lang == LUA ? "end\n" : "}\n");
+					block = 0;
+					continue;
+				}
+				if(block > 0) {
+					block--;
+				}
+				
+				float r = chance(rng);
+				if(r < comments) {
+					if(n % 10 == 0 && i+3 < lines && block > 3) { // multi line
+						s << (lang == LUA ? "\t--[[ block comment " : "\t/* block comment ") << n << "\n";
+						s << "\t   spanning several lines with (parens) & [brackets]\n";
+						s << (lang == LUA ? "\t]]\n" : "\t*/\n");
+						i += 2;
+						block = MAX(block-2, 1);
+					}
+					else {
+						s << (lang == LUA ? "\t-- comment " : "\t// comment ") << n << " about a = b + c\n";
+					}
+				}
+				else if(r < comments + strings) {
+					if(lang == LUA) {
+						s << "\tlocal s" << n << " = \"string " << n << "\" .. 'quoted (" << n << ")'\n";
+					}
+					else {
+						s << "\t#include \"lib" << n << ".glsl\"\n";
+					}
+				}
+				else {
+					switch(n % 3) {
+						case 0:
+							s << (lang == LUA ? "\tlocal x" : "\tfloat x") << n << " = a * " << n << ".5 + b / 2\n";
+							break;
+						case 1:
+							s << (lang == LUA ? "\tprint(math.sin(a[" : "\tvec3 v = vec3(sin(a[") << n % 4 << "]), b, 1.0)"
+							  << (lang == LUA ? "\n" : ";\n");
+							break;
+						case 2:
+							s << (lang == LUA ? "\tif a > " : "\tif(a.x > ") << n
+							  << (lang == LUA ? " then b = b - 1 end\n" : ") { b -= 1.0; }\n");
+							break;
+					}
+				}
+			}
+			return s.str();
+		}
+};
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#include "ofMain.h"
+#include "ofAppNoWindow.h"
+#include "ofApp.h"
+
+// usage: benchmarkExample [--quick] [--max-lines N] [--output file.json]
+//
+// --quick: only run buffers up to 10K lines
+// --max-lines: largest buffer size in lines, default 1000000
+// --output: JSON results file, default: bin/data/benchmark.json
+//
+// exits with 1 if a check fails, ie. idle frames allocated with
+// OFXEDITOR_COUNT_ALLOCATIONS defined
+int main(int argc, char *argv[]) {
+	int maxLines = 1000000;
+	std::string output = "benchmark.json";
+	for(int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if(arg == "--quick") {
+			maxLines = 10000;
+		}
+		else if(arg == "--max-lines" && i+1 < argc) {
+			maxLines = ofToInt(argv[++i]);
+		}
+		else if(arg == "--output" && i+1 < argc) {
+			output = argv[++i];
+		}
+	}
+	
+	// no window or GL context needed, the editor draws with a headless renderer
+	ofInit();
+	auto window = std::make_shared<ofAppNoWindow>();
+	auto app = std::make_shared<ofApp>(maxLines, output);
+	ofRunApp(window, app);
+	return ofRunMainLoop();
+}
@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#include "ofApp.h"
+
+#include "ofxEditorAllocationCounter.h"
+
+// buffer sizes to benchmark, up to the max lines
+static const int s_bufferLines[] = {1000, 10000, 100000, 1000000};
+
+// buffer size for the comment & string density variations
+#define DENSITY_LINES 10000
+
+// default comment & string line density
+#define DEFAULT_COMMENTS 0.1
+#define DEFAULT_STRINGS 0.1
+
+// number of frames to draw per buffer
+#define DRAW_FRAMES 60
+
+//--------------------------------------------------------------
+ofApp::ofApp(int maxLines, const std::string &output) {
+	this->maxLines = maxLines;
+	this->output = output;
+	failed = false;
+}
+
+//--------------------------------------------------------------
+void ofApp::setup() {
+
+	// record draw commands only, don't rasterize
+	renderer = std::make_shared<ofxEditorHeadlessRenderer>();
+	ofxEditor::setRenderer(renderer);
+	ofxEditor::loadFont("fonts/PrintChar21.ttf", 24);
+	
+	// keep enough undo actions for the undo churn
+	ofxEditor::setUndoDepth(1000);
+	
+	luaSyntax.loadFile("luaSyntax.xml");
+	glslSyntax.loadFile("glslSyntax.xml");
+	editor.getSettings().addSyntax(&luaSyntax);
+	editor.getSettings().addSyntax(&glslSyntax);
+	colorScheme.loadFile("colorScheme.xml");
+	editor.setColorScheme(&colorScheme);
+	editor.setLineNumbers(true);
+	editor.resize(1024, 768);
+	
+	// buffer size sweep
+	for(auto lines : s_bufferLines) {
+		if(lines > maxLines) {
+			break;
+		}
+		runBuffer(BenchmarkSource::LUA, lines, DEFAULT_COMMENTS, DEFAULT_STRINGS, true);
+		runBuffer(BenchmarkSource::GLSL, lines, DEFAULT_COMMENTS, DEFAULT_STRINGS, true);
+	}
+	
+	// comment & string density variations
+	int lines = MIN(DENSITY_LINES, maxLines);
+	for(int lang = BenchmarkSource::LUA; lang <= BenchmarkSource::GLSL; ++lang) {
+		runBuffer((BenchmarkSource::Lang)lang, lines, 0, 0, false);
+		runBuffer((BenchmarkSource::Lang)lang, lines, 0.5, 0, false);
+		runBuffer((BenchmarkSource::Lang)lang, lines, 0, 0.5, false);
+	}
+	
+	// write results
+	std::map<std::string, std::string> info;
+	info["date"] = ofGetTimestampString("%Y-%m-%d %H:%M:%S");
+	info["max_lines"] = ofToString(maxLines);
+	ofFile file;
+	if(file.open(ofToDataPath(output), ofFile::WriteOnly)) {
+		file << report.toJson(info);
+		file.close();
+		ofLogNotice("benchmark") << "wrote " << ofToDataPath(output);
+	}
+	else {
+		ofLogError("benchmark") << "couldn't write " << output;
+	}
+}
+
+//--------------------------------------------------------------
+void ofApp::update() {
+	ofExit(failed ? 1 : 0);
+}
+
+//--------------------------------------------------------------
+void ofApp::runBuffer(BenchmarkSource::Lang lang, int lines, float comments, float strings, bool full) {
+	BenchmarkTimer timer;
+	std::string text = BenchmarkSource::generate(lang, lines, comments, strings);
+	std::mt19937 rng(lines);
+	editor.clearText();
+	editor.clearUndo();
+	editor.setLangSyntax(lang == BenchmarkSource::LUA ? "Lua" : "GLSL");
+	
+	// initial load including the first parse
+	BenchmarkResult set = result("set_text", lang, lines, comments, strings);
+	timer.start();
+	editor.setText(text);
+	set.samples.push_back(timer.elapsed());
+	set.chars = editor.getNumCharacters();
+	set.bytes = text.size();
+	report.add(set);
+	
+	// full reparse of the text blocks
+	BenchmarkResult parse = result("parse", lang, lines, comments, strings);
+	parse.bytes = text.size();
+	for(int i = 0; i < numSamples(lines, 20); ++i) {
+		timer.start();
+		editor.textBufferUpdated();
+		parse.samples.push_back(timer.elapsed());
+	}
+	report.add(parse);
+	
+	// typing in the middle of the buffer, each keystroke reparses
+	BenchmarkResult keystroke = result("keystroke", lang, lines, comments, strings);
+	editor.setCurrentLine(lines/2);
+	int numKeys = numSamples(lines, 50);
+	for(int i = 0; i < numKeys; ++i) {
+		timer.start();
+		editor.keyPressed('x');
+		keystroke.samples.push_back(timer.elapsed());
+	}
+	for(int i = 0; i < numKeys; ++i) {
+		editor.keyPressed(OF_KEY_BACKSPACE);
+	}
+	report.add(keystroke);
+	
+	// draw the middle of the buffer
+	BenchmarkResult draw = result("draw", lang, lines, comments, strings);
+	editor.setCurrentLine(lines/2);
+	unsigned int allocations = 0;
+	for(int i = 0; i < DRAW_FRAMES; ++i) {
+		renderer->clearCommands();
+		ofxEditor::resetFontDrawStats();
+		timer.start();
+		editor.draw();
+		draw.samples.push_back(timer.elapsed());
+		if(i > 0) { // the first frame warms the glyph atlas & batches
+			allocations += editor.getNumFrameAllocations();
+		}
+	}
+	draw.extra["vertices"] = ofxEditor::getFontNumVertices();
+	draw.extra["draw_calls"] = ofxEditor::getFontNumDrawCalls();
+	draw.extra["commands"] = renderer->getCommands().size();
+	if(ofxEditorAllocationCounter::isCountingAllocations()) {
+		draw.extra["idle_allocations"] = allocations;
+		if(allocations > 0) {
+			ofLogError("benchmark") << draw.lang << " " << lines << " lines: "
+				<< allocations << " heap allocations in idle frames";
+			failed = true;
+		}
+	}
+	report.add(draw);
+	
+	if(!full) {
+		return;
+	}
+	
+	// save & open round trip
+	std::string path = (lang == BenchmarkSource::LUA ? "benchmark.lua" : "benchmark.frag");
+	BenchmarkResult save = result("save", lang, lines, comments, strings);
+	BenchmarkResult open = result("open", lang, lines, comments, strings);
+	save.bytes = open.bytes = text.size();
+	for(int i = 0; i < numSamples(lines, 10); ++i) {
+		timer.start();
+		editor.saveFile(path);
+		save.samples.push_back(timer.elapsed());
+		timer.start();
+		editor.openFile(path);
+		open.samples.push_back(timer.elapsed());
+	}
+	ofFile::removeFile(path);
+	report.add(save);
+	report.add(open);
+	
+	// position lookups
+	BenchmarkResult lineForPos = result("line_number_for_pos", lang, lines, comments, strings);
+	BenchmarkResult setLine = result("set_current_line", lang, lines, comments, strings);
+	unsigned int numChars = MAX(editor.getNumCharacters(), 1);
+	for(int i = 0; i < numSamples(lines, 200); ++i) {
+		unsigned int pos = rng() % numChars;
+		timer.start();
+		editor.lineNumberForPos(pos);
+		lineForPos.samples.push_back(timer.elapsed());
+		
+		unsigned int line = rng() % lines;
+		timer.start();
+		editor.setCurrentLine(line);
+		setLine.samples.push_back(timer.elapsed());
+	}
+	report.add(lineForPos);
+	report.add(setLine);
+	
+	// undo & redo of alternating insert & backspace edits
+	BenchmarkResult undo = result("undo", lang, lines, comments, strings);
+	BenchmarkResult redo = result("redo", lang, lines, comments, strings);
+	editor.clearUndo();
+	editor.setCurrentLine(lines/2);
+	int numEdits = numSamples(lines, 100);
+	for(int i = 0; i < numEdits; ++i) {
+		editor.keyPressed('x');
+		editor.keyPressed(OF_KEY_BACKSPACE);
+	}
+	for(int i = 0; i < numEdits; ++i) {
+		timer.start();
+		editor.undo();
+		undo.samples.push_back(timer.elapsed());
+	}
+	for(int i = 0; i < numEdits; ++i) {
+		timer.start();
+		editor.redo();
+		redo.samples.push_back(timer.elapsed());
+	}
+	report.add(undo);
+	report.add(redo);
+}
+
+//--------------------------------------------------------------
+BenchmarkResult ofApp::result(const std::string &name, BenchmarkSource::Lang lang,
+                              int lines, float comments, float strings) {
+	BenchmarkResult r;
+	r.name = name;
+	r.lang = (lang == BenchmarkSource::LUA ? "Lua" : "GLSL");
+	r.lines = lines;
+	r.chars = editor.getNumCharacters();
+	r.comments = comments;
+	r.strings = strings;
+	return r;
+}
+
+//--------------------------------------------------------------
+int ofApp::numSamples(int lines, int samples) {
+	if(lines >= 1000000) {
+		return MAX(samples/20, 3);
+	}
+	else if(lines >= 100000) {
+		return MAX(samples/5, 3);
+	}
+	return samples;
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#pragma once
+
+#include "ofMain.h"
+#include "ofxEditor.h"
+#include "ofxEditorHeadlessRenderer.h"
+#include "Benchmark.h"
+
+/// editor subclass with access to the internal update for benchmarking
+class BenchmarkEditor : public ofxEditor {
+	public:
+		using ofxEditor::textBufferUpdated;
+		using ofxEditor::lineNumberForPos;
+};
+
+// runs the editor benchmarks without a window or GPU & writes the results
+// as JSON, see main.cpp for options
+//
+// buffers are synthetic Lua & GLSL sources from 1K lines up to the max lines
+// (default 1M), drawing uses a headless renderer which only records commands
+// so draw() CPU time is measured without the GL driver
+//
+class ofApp : public ofBaseApp {
+
+	public:
+	
+		ofApp(int maxLines, const std::string &output);
+	
+		void setup();
+		void update();
+	
+		/// run all benchmarks on a generated buffer
+		void runBuffer(BenchmarkSource::Lang lang, int lines, float comments, float strings, bool full);
+	
+		/// fill in the result buffer description
+		BenchmarkResult result(const std::string &name, BenchmarkSource::Lang lang,
+		                       int lines, float comments, float strings);
+	
+		/// number of samples to take for per edit benchmarks, fewer for big buffers
+		int numSamples(int lines, int samples);
+	
+		int maxLines;       //< largest buffer size in lines
+		std::string output; //< JSON output path
+		bool failed; //< did a check fail? exits with 1 if so
+	
+		BenchmarkEditor editor;
+		ofxEditorSyntax luaSyntax;
+		ofxEditorSyntax glslSyntax;
+		ofxEditorColorScheme colorScheme;
+		std::shared_ptr<ofxEditorHeadlessRenderer> renderer;
+		BenchmarkReport report;
+};
@@ -129,22 +129,38 @@ void ofApp::openFileEvent(int &whichEditor) {
 
 //--------------------------------------------------------------
 void ofApp::saveFileEvent(int &whichEditor) {
-	// received an editor save via CTRL/Super + s or CTRL/Super + d
+	// received when an editor save via CTRL/Super + s or CTRL/Super + d has
+	// been written in the background
 	
+	if(editor.getSaveFileError(whichEditor) != "") {
+		ofLogError() << "couldn't save editor " << whichEditor
+			<< ": " << editor.getSaveFileError(whichEditor);
+		return;
+	}
 	ofLogNotice() << "received save event for editor " << whichEditor
 		<< " with filename " << editor.getEditorFilename(whichEditor);
 }
 
 //--------------------------------------------------------------
-void ofApp::executeScriptEvent(int &whichEditor) {
+void ofApp::reloadFileEvent(int &whichEditor) {
+	// received when an open file was changed on disk & reloaded
+	
+	ofLogNotice() << "received reload event for editor " << whichEditor
+		<< " with filename " << editor.getEditorFilename(whichEditor);
+}
+
+//--------------------------------------------------------------
+void ofApp::executeScriptTextEvent(int whichEditor, const string &text) {
 	// received on editor CTRL/Super + e
 	
-	// get the text buffer with:
-	// string txt = editor.getText(whichEditor);
-	// note: returns only the selected area when holding SHIFT + arrow keys
+	// text is the editor text buffer copied when the key was pressed
+	// note: only the selected area when holding SHIFT + arrow keys
+	// use it instead of editor.getText(whichEditor) as this may run on a
+	// worker thread if getEvalExecutor() returns WORKER
 	
 	// if you have some scripting language (e.g. ofxLua)
-	ofLogNotice() << "received execute script event for editor " << whichEditor;
+	ofLogNotice() << "received execute script event for editor " << whichEditor
+		<< ": " << text.size() << " chars";
 }
 
 //--------------------------------------------------------------
@@ -46,7 +46,8 @@ class ofApp : public ofBaseApp, public ofxGLEditorListener {
 		/// ofxGLEditor events
 		void saveFileEvent(int &whichEditor);
 		void openFileEvent(int &whichEditor);
-		void executeScriptEvent(int &whichEditor);
+		void reloadFileEvent(int &whichEditor);
+		void executeScriptTextEvent(int whichEditor, const string &text);
 		void evalReplEvent(const string &text);
 		
 		ofxGLEditor editor;
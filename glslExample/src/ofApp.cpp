@@ -12,6 +12,16 @@ void ofApp::setup() {
 	// handle ESC internally since we use it to exit selection
 	ofSetEscapeQuitsApp(false);
 
+	// use signed distance field glyphs so the text stays sharp when scaled
+	// by auto focus, must be set before loading the font
+	ofxEditor::setSignedDistanceField(true);
+	
+	// rasterize latin-1 & box drawing glyphs up front and cache the font atlas
+	// in bin/data/fontcache so a relaunch doesn't need to rasterize anything
+	ofxEditor::addFontPrewarmRange(0x20, 0xFF);
+	ofxEditor::addFontPrewarmRange(0x2500, 0x257F);
+	ofxEditor::setFontCacheDirectory("fontcache");
+
 	// make sure to load editor font before anything else!
     ofxEditor::loadFont("fonts/PrintChar21.ttf", 24);
 	
@@ -32,8 +42,13 @@ void ofApp::setup() {
 	shaderName = "shader";
 	editor.openFile(shaderName+".frag");
 	ofLogNotice() << "num chars: " << editor.getNumCharacters() << " num lines: " << editor.getNumLines();
+	
+	// reload & recompile when the shader files are changed by another editor
+	watcher.watch(ofToDataPath(shaderName+".frag"));
+	watcher.watch(ofToDataPath(shaderName+".vert"));
 
     bToggleVisible = true;
+    loadOnSaveId = 0;
 	debug = false;
     
     /// shader stuff
@@ -49,6 +64,41 @@ void ofApp::setup() {
 
 //--------------------------------------------------------------
 void ofApp::draw() {
+	
+	// saves are written on a worker, reload the shader once the evaluated
+	// save is written
+	std::vector<ofxEditorFileSaver::Result> saves;
+	if(saver.pop(saves)) {
+		for(auto &save : saves) {
+			if(save.error == "") {
+				watcher.update(save.path); // don't reload our own save
+			}
+			if(save.id == loadOnSaveId) {
+				if(save.error == "") {
+					shader.load(shaderName);
+				}
+				loadOnSaveId = 0;
+			}
+		}
+	}
+	
+	// changed files are read on a worker, so this doesn't block
+	std::vector<ofxEditorFileWatcher::Change> changes;
+	if(watcher.pop(changes)) {
+		bool changed = false;
+		for(auto &change : changes) {
+			if(saver.isSaving(change.path)) {
+				continue; // our own save
+			}
+			if(change.path == ofToDataPath(shaderName+".frag")) {
+				editor.reloadText(change.text); // keeps the cursor line
+			}
+			changed = true;
+		}
+		if(changed) {
+			shader.load(shaderName);
+		}
+	}
     
     fbo.begin();
 		ofClear(0, 0, 0, 0);
@@ -62,6 +112,7 @@ void ofApp::draw() {
     fbo.end();
     fbo.draw(0, 0, ofGetWidth(), ofGetHeight());
 
+    ofxEditor::resetFontDrawStats();
     if(bToggleVisible){
         editor.draw();
     }
@@ -69,9 +120,20 @@ void ofApp::draw() {
 	if(debug) {
 		ofSetColor(255);
 		ofDrawBitmapString("fps: "+ofToString((int)ofGetFrameRate()), ofGetWidth()-70, ofGetHeight()-10);
+		ofDrawBitmapString("font verts: "+ofToString(ofxEditor::getFontNumVertices())+
+		                   " draws: "+ofToString(ofxEditor::getFontNumDrawCalls())+
+		                   " pages: "+ofToString(ofxEditor::getFontNumAtlasPages())+
+		                   (ofxEditor::getTextShadowSinglePass() ? " (single pass)" : " (two pass)"),
+		                   10, ofGetHeight()-10);
 	}
 }
 
+//--------------------------------------------------------------
+void ofApp::exit() {
+	// keep glyphs rasterized while running for the next launch
+	ofxEditor::saveFontCache();
+}
+
 //--------------------------------------------------------------
 void ofApp::keyPressed(int key) {
 	bool modifierPressed = ofxEditor::getSuperAsModifier() ? ofGetKeyPressed(OF_KEY_SUPER) : ofGetKeyPressed(OF_KEY_CONTROL);
@@ -79,12 +141,11 @@ void ofApp::keyPressed(int key) {
 		switch(key) {
             case 't':
                 bToggleVisible = !bToggleVisible;
-            case 's': // save file
-                editor.saveFile(shaderName+".frag");
+            case 's': // save file in the background
+                saver.save(ofToDataPath(shaderName+".frag"), editor.getWideText());
                 break;
-			case 'e': // evaluate aka save & reload shader
-                editor.saveFile(shaderName+".frag");
-                shader.load(shaderName);
+			case 'e': // evaluate aka save & reload shader once saved
+                loadOnSaveId = saver.save(ofToDataPath(shaderName+".frag"), editor.getWideText());
                 break;
 			case 'd':
 				debug = !debug;
@@ -104,6 +165,9 @@ void ofApp::keyPressed(int key) {
 			case 'w':
 				ofxEditor::setTextShadow(!ofxEditor::getTextShadow());
 				return;
+			case 'p':
+				ofxEditor::setTextShadowSinglePass(!ofxEditor::getTextShadowSinglePass());
+				return;
 		}
 	}
 	editor.keyPressed(key);
@@ -5,6 +5,8 @@
 
 #include "ofMain.h"
 #include "ofxEditor.h"
+#include "ofxEditorFileWatcher.h"
+#include "ofxEditorFileSaver.h"
 
 // a live glsl pixel shader editor example using a single ofxEditor
 //
@@ -13,12 +15,17 @@
 //
 // MOD + s: save pixel shader
 // MOD + e: save & evaluate pixel shader
+//
+// the shader is also reloaded when shader.frag or shader.vert are changed by
+// another editor
+//
 // MOD + l: toggle line wrapping
 // MOD + n: toggle line numbers
 // MOD + f: toggle fullscreen
 // MOD + t: show/hide editor
 // MOD + k: toggle auto focus
 // MOD + w: toggle text shadow
+// MOD + p: toggle single pass text shadow
 // MOD + d: toggle debug
 //
 // see ofxEditor.h for editor key commands
@@ -28,6 +35,7 @@ class ofApp : public ofBaseApp {
 	public:
 		void setup();
 		void draw();
+		void exit();
 
 		void keyPressed(int key);
 		void windowResized(int w, int h);
@@ -35,13 +43,16 @@ class ofApp : public ofBaseApp {
 		ofxEditor editor;
 		ofxEditorColorScheme colorScheme;
 		ofxEditorSyntax syntax;
-		bool debug; //< show fps?
+		bool debug; //< show fps & font draw stats?
     
         ofShader shader;
         ofFbo fbo;
+        ofxEditorFileWatcher watcher; //< reloads shader files changed on disk
+        ofxEditorFileSaver saver; //< saves the shader without blocking drawing
     
     private:
         string shaderName;
         int width, height;
         bool bToggleVisible;
+        unsigned int loadOnSaveId; //< reload the shader when this save is finished, 0 if none
 };
@@ -22,6 +22,9 @@
  */
 #include "ofxEditor.h"
 #include "ofxEditorFont.h"
+#include "ofxEditorGLRenderer.h"
+#include "ofxEditorFileSaver.h"
+#include "ofxEditorAllocationCounter.h"
 #include "ofMath.h"
 
 // string conversion, this will be replaced when OF has internal unicode support
@@ -50,6 +53,13 @@
 // timeout between chars when building an undo action
 #define UNDO_TIMEOUT 1000
 
+// max decimal digits in a line number
+#define LINE_NUMBER_DIGITS 10
+
+// max changed lines the reload line diff looks for before lines are mapped
+// proportionally instead
+#define DIFF_MAX_EDITS 1000
+
 // uncomment to see the viewport and auto focus bounding boxes
 //#define DEBUG_AUTO_FOCUS
 
@@ -57,11 +67,14 @@
 //#define DEBUG_UNDO
 
 ofPtr<ofxEditorFont> ofxEditor::s_font;
+ofPtr<ofxEditorRenderer> ofxEditor::s_renderer;
 int ofxEditor::s_charWidth = 1;
 int ofxEditor::s_zeroWidth = 1;
 int ofxEditor::s_charHeight = 1;
 int ofxEditor::s_cursorWidth = 1;
 bool ofxEditor::s_textShadow = true;
+bool ofxEditor::s_textShadowSinglePass = true;
+bool ofxEditor::s_signedDistanceField = false;
 
 u32string ofxEditor::s_copyBuffer;
 
@@ -75,6 +88,8 @@ float ofxEditor::s_autoFocusMaxScale = 1;
 bool ofxEditor::s_undo = true;
 unsigned int ofxEditor::s_undoMaxDepth = 10;
 
+uint64_t ofxEditor::s_keyTime = 0;
+
 // use CMD on OSX, CTRL for Windows & Linux by default
 #ifdef __APPLE__
 	bool ofxEditor::s_superAsModifier = true;
@@ -112,6 +127,7 @@ ofxEditor::ofxEditor() {
 	m_syntax = NULL;
 	m_lineWrapping = false;
 	m_lineNumbers = false;
+	m_readOnly = false;
 	m_lineNumWidth = 0;
 	
 	m_delta = 0;
@@ -128,6 +144,9 @@ ofxEditor::ofxEditor() {
 	m_BBMinY = 0; m_BBMaxY = 0;
 	
 	m_undoPos = -1;
+	
+	m_keyTime = 0;
+	m_frameAllocations = 0;
 }
 
 //--------------------------------------------------------------
@@ -160,6 +179,7 @@ ofxEditor::ofxEditor(ofxEditorSettings &sharedSettings) {
 	m_syntax = NULL;
 	m_lineWrapping = false;
 	m_lineNumbers = false;
+	m_readOnly = false;
 	m_lineNumWidth = 0;
 	
 	m_delta = 0;
@@ -176,6 +196,9 @@ ofxEditor::ofxEditor(ofxEditorSettings &sharedSettings) {
 	m_BBMinY = 0; m_BBMaxY = 0;
 	
 	m_undoPos = -1;
+	
+	m_keyTime = 0;
+	m_frameAllocations = 0;
 }
 
 //--------------------------------------------------------------
@@ -200,6 +223,9 @@ bool ofxEditor::loadFont(const std::string &font, int size) {
 	if(s_font == NULL) {
 		s_font = ofPtr<ofxEditorFont>(new ofxEditorFont());
 	}
+	s_font->setRenderer(getRenderer());
+	s_font->setSinglePassShadow(s_textShadowSinglePass);
+	s_font->setSignedDistanceField(s_signedDistanceField);
 	if(s_font->load(font, size)) {
 		s_charWidth = s_font->characterWidth(' ');
 		s_zeroWidth = s_font->characterWidth('0');
@@ -212,7 +238,7 @@ bool ofxEditor::loadFont(const std::string &font, int size) {
 
 //--------------------------------------------------------------
 bool ofxEditor::isFontLoaded() {
-	return s_font.get();
+	return s_font && s_font->isLoaded();
 }
 
 //--------------------------------------------------------------
@@ -235,6 +261,112 @@ bool ofxEditor::getTextShadow() {
 	return s_textShadow;
 }
 
+//--------------------------------------------------------------
+void ofxEditor::setTextShadowSinglePass(bool singlePass) {
+	s_textShadowSinglePass = singlePass;
+	if(s_font) {
+		s_font->setSinglePassShadow(singlePass);
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxEditor::getTextShadowSinglePass() {
+	return s_textShadowSinglePass;
+}
+
+//--------------------------------------------------------------
+unsigned int ofxEditor::getFontNumVertices() {
+	return s_font ? s_font->getNumVertices() : 0;
+}
+
+//--------------------------------------------------------------
+unsigned int ofxEditor::getFontNumDrawCalls() {
+	return s_font ? s_font->getNumDrawCalls() : 0;
+}
+
+//--------------------------------------------------------------
+void ofxEditor::resetFontDrawStats() {
+	if(s_font) {
+		s_font->resetDrawStats();
+	}
+}
+
+//--------------------------------------------------------------
+void ofxEditor::setSignedDistanceField(bool sdf) {
+	s_signedDistanceField = sdf;
+}
+
+//--------------------------------------------------------------
+bool ofxEditor::getSignedDistanceField() {
+	return isFontLoaded() ? s_font->getSignedDistanceField() : s_signedDistanceField;
+}
+
+//--------------------------------------------------------------
+void ofxEditor::setFontMaxAtlasPages(int maxPages) {
+	if(s_font == NULL) {
+		s_font = ofPtr<ofxEditorFont>(new ofxEditorFont());
+	}
+	s_font->setMaxPages(maxPages);
+}
+
+//--------------------------------------------------------------
+int ofxEditor::getFontNumAtlasPages() {
+	return s_font ? s_font->getNumPages() : 0;
+}
+
+//--------------------------------------------------------------
+size_t ofxEditor::getFontMemoryUsage() {
+	return s_font ? s_font->getMemoryUsage() : 0;
+}
+
+//--------------------------------------------------------------
+void ofxEditor::addFontFallback(const std::string &filename) {
+	if(s_font == NULL) {
+		s_font = ofPtr<ofxEditorFont>(new ofxEditorFont());
+	}
+	s_font->addFallbackFont(filename);
+}
+
+//--------------------------------------------------------------
+void ofxEditor::addFontPrewarmRange(unsigned int first, unsigned int last) {
+	if(s_font == NULL) {
+		s_font = ofPtr<ofxEditorFont>(new ofxEditorFont());
+	}
+	s_font->addPrewarmRange(first, last);
+}
+
+//--------------------------------------------------------------
+void ofxEditor::setFontCacheDirectory(const std::string &dir) {
+	if(s_font == NULL) {
+		s_font = ofPtr<ofxEditorFont>(new ofxEditorFont());
+	}
+	s_font->setCacheDirectory(dir);
+}
+
+//--------------------------------------------------------------
+bool ofxEditor::saveFontCache() {
+	return s_font ? s_font->saveCache() : false;
+}
+
+//--------------------------------------------------------------
+void ofxEditor::setRenderer(ofPtr<ofxEditorRenderer> renderer) {
+	if(!renderer) {
+		return;
+	}
+	s_renderer = renderer;
+	if(s_font) {
+		s_font->setRenderer(s_renderer);
+	}
+}
+
+//--------------------------------------------------------------
+ofPtr<ofxEditorRenderer> ofxEditor::getRenderer() {
+	if(s_renderer == NULL) {
+		s_renderer = s_font ? s_font->getRenderer() : ofPtr<ofxEditorRenderer>(new ofxEditorGLRenderer());
+	}
+	return s_renderer;
+}
+
 //--------------------------------------------------------------
 void ofxEditor::setSuperAsModifier(bool useSuper) {
 	s_superAsModifier = useSuper;
@@ -295,11 +427,80 @@ unsigned int ofxEditor::getUndoDepth() {
 	return s_undoMaxDepth;
 }
 
+//--------------------------------------------------------------
+void ofxEditor::drawProfiler(float x, float y, ofxEditor *editor) {
+#ifdef OFXEDITOR_PROFILING
+	if(!isFontLoaded()) {
+		return;
+	}
+	
+	// phase, mean, p95, & max in ms
+	vector<string> lines;
+	lines.push_back("phase                  mean    p95    max");
+	for(int i = 0; i < ofxEditorProfiler::NUM_PHASES + 1; ++i) {
+		string name;
+		ofxEditorProfiler::Stats stats;
+		if(i < ofxEditorProfiler::NUM_PHASES) {
+			ofxEditorProfiler::Phase phase = (ofxEditorProfiler::Phase)i;
+			name = ofxEditorProfiler::getPhaseName(phase);
+			stats = ofxEditorProfiler::getStats(phase);
+		}
+		else if(editor) {
+			name = "key latency";
+			stats = editor->getKeyLatency();
+		}
+		else {
+			break;
+		}
+		lines.push_back(name + string(20-MIN(name.length(), 20), ' ') +
+			ofToString(stats.mean/1000.0f, 2, 7, ' ') +
+			ofToString(stats.p95/1000.0f, 2, 7, ' ') +
+			ofToString(stats.max/1000.0f, 2, 7, ' '));
+	}
+	
+	int width = lines[0].length() * s_zeroWidth + s_charWidth * 2;
+	int height = (lines.size() + 1) * s_charHeight;
+	ofColor background(0, 180), text(255);
+	
+	getRenderer()->begin();
+		s_renderer->drawRectangle(x, y, width, height, background);
+		s_font->pushState();
+		s_font->setColor(text);
+		s_font->beginBatch();
+		for(int i = 0; i < lines.size(); ++i) {
+			s_font->drawString(lines[i], x + s_charWidth, y + (i + 1) * s_charHeight);
+		}
+		s_font->endBatch();
+		s_font->popState();
+	s_renderer->end();
+#endif
+}
+
+//--------------------------------------------------------------
+void ofxEditor::markKeyPressed(int key) {
+#ifdef OFXEDITOR_PROFILING
+	switch(key) {
+		case OF_KEY_ALT: case OF_KEY_LEFT_ALT: case OF_KEY_RIGHT_ALT:
+		case OF_KEY_SHIFT: case OF_KEY_LEFT_SHIFT: case OF_KEY_RIGHT_SHIFT:
+		case OF_KEY_CONTROL: case OF_KEY_LEFT_CONTROL: case OF_KEY_RIGHT_CONTROL:
+		case OF_KEY_SUPER: case OF_KEY_LEFT_SUPER: case OF_KEY_RIGHT_SUPER:
+			return;
+	}
+	if(s_keyTime == 0) {
+		s_keyTime = ofGetElapsedTimeMicros();
+	}
+#endif
+}
+
 // MAIN
 
 //--------------------------------------------------------------
 // TODO: check for some easy performance improvements here
 void ofxEditor::draw() {
+	OFXEDITOR_PROFILE_BEGIN(DRAW);
+#ifdef OFXEDITOR_COUNT_ALLOCATIONS
+	uint64_t allocations = ofxEditorAllocationCounter::getNumAllocations();
+#endif
 
 	// default size if not set
 	if(m_width == 0 || m_height == 0) {
@@ -309,9 +510,11 @@ void ofxEditor::draw() {
 	// update scrolling
 	m_posX = 0;
 	if(!m_lineWrapping) {
+		OFXEDITOR_PROFILE_SCOPE(DRAW_SCROLL);
+		unsigned int start = lineStart(m_position);
 		int currentLineWidth =
 			m_lineNumWidth +
-			s_font->stringWidth(m_text.substr(lineStart(m_position), m_desiredXPos)) +
+			s_font->stringWidth(m_text.data()+start, MIN(m_desiredXPos, m_text.size()-start)) +
 			(s_charWidth == s_zeroWidth ? 0 : s_charWidth); // fixed width fonts don't need the extra padding
 		if(currentLineWidth > m_visibleWidth) {
 			m_posX = -(currentLineWidth-m_visibleWidth);
@@ -328,31 +531,27 @@ void ofxEditor::draw() {
 		}
 	}
 
-	ofPushStyle();
-	ofPushView();
-		ofEnableAlphaBlending(); // for fontstash
-		ofViewport(0, 0, m_width, m_height);
-		ofPushMatrix();
+	s_renderer->begin();
+		s_renderer->setViewport(0, 0, m_width, m_height);
+		s_renderer->pushMatrix();
 		
 		// scale when using auto focus
 		if(m_autoFocus) {
 			#ifdef DEBUG_AUTO_FOCUS
-				ofNoFill();
-				ofSetColor(ofColor::green);
-				ofRectMode rectMode = ofGetRectMode();
-				ofSetRectMode(OF_RECTMODE_CORNER);
-				ofDrawRectangle(0, 0, m_width, m_height);
-				ofSetRectMode(rectMode);
-				ofFill();
+				s_renderer->drawRectangle(0, 0, m_width, m_height, ofColor::green, false);
 			#endif
-			ofTranslate(0, m_height/2);
-			ofScale(m_scale, m_scale);
+			s_renderer->translate(0, m_height/2);
+			s_renderer->scale(m_scale, m_scale);
 		}
-		ofTranslate(m_posX, m_posY);
+		s_renderer->translate(m_posX, m_posY);
+	
+		// collect glyphs & draw them with one call per atlas page at the end
+		s_font->beginBatch();
 	
 		m_matchingCharsHighlight[0] = -1;
 		m_matchingCharsHighlight[1] = -1;
 		if(m_settings->getHighlightMatchingChars()) {
+			OFXEDITOR_PROFILE_SCOPE(DRAW_MATCHING_CHARS);
 			parseMatchingChars();
 		}
 	
@@ -366,9 +565,8 @@ void ofxEditor::draw() {
 		int currentLine = 0;
 
 		// draw text
+		OFXEDITOR_PROFILE_BEGIN(DRAW_TEXT);
 		if(m_colorScheme) { // with colorScheme
-			ofFill();
-			
 			s_font->setColor(m_settings->getTextColor(), m_settings->getAlpha());
 			s_font->setShadowColor(m_settings->getTextShadowColor(), m_settings->getAlpha());
 			
@@ -589,8 +787,6 @@ void ofxEditor::draw() {
 			}
 		}
 		else { // without syntax highlighting
-			ofFill();
-			
 			s_font->setColor(m_settings->getTextColor(), m_settings->getAlpha());
 			s_font->setShadowColor(m_settings->getTextShadowColor(), m_settings->getAlpha());
 			
@@ -676,8 +872,16 @@ void ofxEditor::draw() {
 			expandBoundingBox(x+s_zeroWidth, y); // extra space for the cursor
 		}
 	
+		OFXEDITOR_PROFILE_END(DRAW_TEXT);
+	
+		// draw text on top of highlights & cursor
+		OFXEDITOR_PROFILE_BEGIN(DRAW_GLYPHS);
+		s_font->endBatch();
+		OFXEDITOR_PROFILE_END(DRAW_GLYPHS);
+	
 		// calculate auto focus bounding box and scaling
 		if(m_autoFocus) {
+			OFXEDITOR_PROFILE_SCOPE(DRAW_AUTO_FOCUS);
 			
 			// add top and bottom padding for small text
 			m_BBMinY -= s_charHeight;
@@ -706,14 +910,7 @@ void ofxEditor::draw() {
 			m_scale = ofClamp(m_scale, s_autoFocusMinScale, s_autoFocusMaxScale);
 			
 			#ifdef DEBUG_AUTO_FOCUS
-				ofNoFill();
-				ofSetColor(ofColor::red);
-				ofBeginShape();
-					ofVertex(m_BBMinX, m_BBMinY, 0);
-					ofVertex(m_BBMaxX, m_BBMinY, 0);
-					ofVertex(m_BBMaxX, m_BBMaxY, 0);
-					ofVertex(m_BBMinX, m_BBMaxY, 0);
-				ofEndShape();
+				s_renderer->drawRectangle(m_BBMinX, m_BBMinY, m_BBMaxX-m_BBMinX, m_BBMaxY-m_BBMinY, ofColor::red, false);
 			#endif
 		}
 		else {
@@ -721,15 +918,22 @@ void ofxEditor::draw() {
 			m_scale = 1.0;
 		}
 	
-		ofPopMatrix();
-	ofPopView();
-	ofPopStyle();
+		s_renderer->popMatrix();
+	s_renderer->end();
 	
 	updateTimestamps();
+	
+#ifdef OFXEDITOR_COUNT_ALLOCATIONS
+	m_frameAllocations = ofxEditorAllocationCounter::getNumAllocations() - allocations;
+#endif
+	OFXEDITOR_PROFILE_END(DRAW);
+	OFXEDITOR_PROFILE_COMMIT(DRAW, DRAW_AUTO_FOCUS);
+	keyLatencyEnd();
 }
 
 //--------------------------------------------------------------
 void ofxEditor::keyPressed(int key) {
+	OFXEDITOR_TRACE_SCOPE_ARG("ofxEditor::keyPressed", "input", "key", key);
 
 	// filter out modifier key events, except SHIFT & current modifier
 	switch(key) {
@@ -739,8 +943,12 @@ void ofxEditor::keyPressed(int key) {
 		case OF_KEY_SUPER: case OF_KEY_LEFT_SUPER: case OF_KEY_RIGHT_SUPER:
 		return;
 	}
+	keyLatencyBegin();
 	
 	bool modifierPressed = s_superAsModifier ? ofGetKeyPressed(OF_KEY_SUPER) : ofGetKeyPressed(OF_KEY_CONTROL);
+	if(m_readOnly && isEditKey(key, modifierPressed)) {
+		return;
+	}
 	if(modifierPressed) {
 	
 		// check control chars too if CTRL is modifier
@@ -1126,6 +1334,7 @@ void ofxEditor::resize(int width, int height) {
 
 //--------------------------------------------------------------
 bool ofxEditor::openFile(std::string filename) {
+	OFXEDITOR_TRACE_SCOPE("ofxEditor::openFile", "file");
 	ofFile file;
 	if(!file.open(ofToDataPath(filename), ofFile::ReadOnly)) {
 		ofLogError("ofxEditor") << "couldn't load \""
@@ -1141,19 +1350,14 @@ bool ofxEditor::openFile(std::string filename) {
 		
 //--------------------------------------------------------------
 bool ofxEditor::saveFile(std::string filename) {
-	ofFile file;
-	if(!file.open(ofToDataPath(filename), ofFile::WriteOnly)) {
+	OFXEDITOR_TRACE_SCOPE("ofxEditor::saveFile", "file");
+	std::string error;
+	if(!ofxEditorFileSaver::write(ofToDataPath(filename), getText(), error)) {
 		ofLogError("ofxEditor") << "couldn't save \""
-			<< ofFilePath::getFileName(filename) << "\"";
+			<< ofFilePath::getFileName(filename) << "\": " << error;
 		return false;
 	}
-	file << getText();
-	file.close();
-	ofxEditorSyntax *syntax = m_settings->getSyntaxForFileExt(ofFilePath::getFileExt(filename));
-	if(m_syntax != syntax) {
-		m_syntax = syntax;
-		if(m_colorScheme) parseTextBlocks();
-	}
+	updateFileSyntax(filename);
 	return true;
 }
 
@@ -1195,6 +1399,60 @@ void ofxEditor::setText(const std::string& text) {
 	setText(string_to_wstring(text));
 }
 
+//--------------------------------------------------------------
+void ofxEditor::reloadText(const std::u32string& text) {
+	OFXEDITOR_TRACE_SCOPE("ofxEditor::reloadText", "file");
+	std::u32string oldText;
+	oldText.swap(m_text);
+	m_text = text;
+	if(m_settings->getConvertTabs()) {
+		processTabs();
+	}
+	if(m_text == oldText) {
+		return;
+	}
+	
+	// replace the changed chars as one undo action, so unsaved edits can be
+	// brought back & the older actions stay valid
+	if(s_undo) {
+		size_t head = 0, tail = 0, common = MIN(oldText.size(), m_text.size());
+		while(head < common && oldText[head] == m_text[head]) {
+			head++;
+		}
+		while(tail < common-head &&
+		      oldText[oldText.size()-1-tail] == m_text[m_text.size()-1-tail]) {
+			tail++;
+		}
+		updateUndo(ACTION_REPLACE, head, m_text.substr(head, m_text.size()-head-tail),
+		           oldText.substr(head, oldText.size()-head-tail));
+	}
+	
+	// map each position to the same column on its new line
+	std::vector<unsigned int> oldLines, newLines, lineMap;
+	lineStarts(oldText, oldLines);
+	lineStarts(m_text, newLines);
+	mapLines(oldText, oldLines, m_text, newLines, lineMap);
+	unsigned int *positions[] = {
+		&m_position, &m_selectAllStartPos, &m_highlightStart, &m_highlightEnd,
+		&m_topTextPosition, &m_flashStart, &m_flashEnd
+	};
+	for(auto p : positions) {
+		unsigned int line = upper_bound(oldLines.begin(), oldLines.end()-1, *p) - oldLines.begin() - 1;
+		unsigned int column = *p - oldLines[line];
+		line = lineMap[line];
+		*p = newLines[line] + MIN(column, newLines[line+1] - newLines[line] - 1);
+	}
+	m_bottomTextPosition = m_text.size()+1; // updated when drawn
+	if(m_selection == ALL) {
+		m_highlightStart = 0;
+		m_highlightEnd = m_text.size();
+	}
+	else if(m_highlightStart == m_highlightEnd) {
+		m_selection = NONE;
+	}
+	textBufferUpdated();
+}
+
 //--------------------------------------------------------------
 void ofxEditor::insertText(const std::u32string& text) {
 	if(m_selection != NONE) {
@@ -1348,6 +1606,16 @@ bool ofxEditor::getLineNumbers() {
 	return m_lineNumbers;
 }
 
+//--------------------------------------------------------------
+void ofxEditor::setReadOnly(bool readOnly) {
+	m_readOnly = readOnly;
+}
+
+//--------------------------------------------------------------
+bool ofxEditor::getReadOnly() {
+	return m_readOnly;
+}
+
 //--------------------------------------------------------------
 void ofxEditor::setAutoFocus(bool focus) {
 	m_autoFocus = focus;
@@ -1528,6 +1796,7 @@ void ofxEditor::undo() {
 	}
 	if(m_undoPos > -1) {
 		UndoAction &a = m_undoActions[m_undoPos];
+		m_selection = NONE; // otherwise the selection would be deleted
 		setCurrentPos(a.pos);
 		switch(a.type) {
 			case ACTION_INSERT:
@@ -1556,6 +1825,7 @@ void ofxEditor::redo() {
 	if(m_undoPos < (int)m_undoActions.size()-1) {
 		m_undoPos++;
 		UndoAction &a = m_undoActions[m_undoPos];
+		m_selection = NONE;
 		setCurrentPos(a.pos);
 		switch(a.type) {
 			case ACTION_INSERT:
@@ -1589,6 +1859,80 @@ void ofxEditor::clearUndo() {
 	#endif
 }
 
+//--------------------------------------------------------------
+unsigned int ofxEditor::getNumUndoActions() {
+	return m_undoActions.size();
+}
+
+//--------------------------------------------------------------
+void ofxEditor::trimUndo(unsigned int num) {
+	if(m_undoActions.size() <= num) {
+		return;
+	}
+	int pop = m_undoActions.size() - num;
+	if(m_undoPos < pop-1) { // would pop actions which can still be redone
+		m_undoActions.clear();
+		m_undoPos = -1;
+	}
+	else {
+		m_undoActions.erase(m_undoActions.begin(), m_undoActions.begin()+pop);
+		m_undoPos -= pop;
+	}
+	#ifdef DEBUG_UNDO
+		printUndo();
+	#endif
+}
+
+// MEMORY
+
+//--------------------------------------------------------------
+ofxEditor::MemoryUsage& ofxEditor::MemoryUsage::operator+=(const MemoryUsage &usage) {
+	text += usage.text;
+	tokens += usage.tokens;
+	undo += usage.undo;
+	scrollback += usage.scrollback;
+	atlas += usage.atlas;
+	listing += usage.listing;
+	return *this;
+}
+
+//--------------------------------------------------------------
+ofxEditor::MemoryUsage ofxEditor::getMemoryUsage() {
+	MemoryUsage usage;
+	usage.text = stringMemory(m_text);
+	
+	// estimated without walking the list: list nodes plus the block text,
+	// which adds up to about the text buffer length
+	if(m_colorScheme) {
+		usage.tokens = m_textBlocks.size() * (sizeof(TextBlock) + 2*sizeof(void*)) +
+			m_text.size() * sizeof(char32_t);
+	}
+	
+	usage.undo = m_undoActions.capacity() * sizeof(UndoAction);
+	for(auto &a : m_undoActions) {
+		usage.undo += stringMemory(a.insertText) + stringMemory(a.deleteText);
+	}
+	return usage;
+}
+
+// PROFILING
+
+//--------------------------------------------------------------
+ofxEditorProfiler::Stats ofxEditor::getKeyLatency() {
+	return m_keyLatency.getStats();
+}
+
+//--------------------------------------------------------------
+void ofxEditor::clearKeyLatency() {
+	m_keyLatency.clear();
+	m_keyTime = 0;
+}
+
+//--------------------------------------------------------------
+unsigned int ofxEditor::getNumFrameAllocations() {
+	return m_frameAllocations;
+}
+
 // UTILS
 
 //--------------------------------------------------------------
@@ -1694,6 +2038,16 @@ void ofxEditor::printUndo() {
 
 // PROTECTED
 
+//--------------------------------------------------------------
+size_t ofxEditor::stringMemory(const std::u32string &s) {
+	// small strings are stored within the string object itself
+	const char *data = (const char*)s.data();
+	if(data >= (const char*)&s && data < (const char*)(&s+1)) {
+		return 0;
+	}
+	return (s.capacity()+1) * sizeof(char32_t);
+}
+
 //--------------------------------------------------------------
 float ofxEditor::characterWidth(int c) {
 	switch(c) {
@@ -1708,35 +2062,24 @@ float ofxEditor::characterWidth(int c) {
 
 //--------------------------------------------------------------
 void ofxEditor::drawMatchingCharBlock(int c, int x, int y) {
-	ofSetColor(
-		m_settings->getMatchingCharsColor().r, m_settings->getMatchingCharsColor().g,
-		m_settings->getMatchingCharsColor().b, m_settings->getMatchingCharsColor().a * m_settings->getAlpha());
-	ofRectMode rectMode = ofGetRectMode();
-	ofSetRectMode(OF_RECTMODE_CORNER);
-	ofDrawRectangle(x, y-s_charHeight, characterWidth(c), s_charHeight);
-	ofSetRectMode(rectMode);
+	ofColor color = m_settings->getMatchingCharsColor();
+	color.a *= m_settings->getAlpha();
+	s_renderer->drawRectangle(x, y-s_charHeight, characterWidth(c), s_charHeight, color);
 }
 
 //--------------------------------------------------------------
 void ofxEditor::drawSelectionCharBlock(int c, int x, int y) {
-	ofSetColor(
-		m_settings->getSelectionColor().r, m_settings->getSelectionColor().g,
-		m_settings->getSelectionColor().b, m_settings->getSelectionColor().a * m_settings->getAlpha());
-	ofRectMode rectMode = ofGetRectMode();
-	ofSetRectMode(OF_RECTMODE_CORNER);
-	ofDrawRectangle(x, y-s_charHeight, characterWidth(c), s_charHeight);
-	ofSetRectMode(rectMode);
+	ofColor color = m_settings->getSelectionColor();
+	color.a *= m_settings->getAlpha();
+	s_renderer->drawRectangle(x, y-s_charHeight, characterWidth(c), s_charHeight, color);
 }
 
 //--------------------------------------------------------------
 void ofxEditor::drawFlashCharBlock(int c, int x, int y) {
 	float cur_alpha = (SELECTION_FLASH_DURATION - m_flashSelTime) / SELECTION_FLASH_DURATION;
-	ofColor &color = m_settings->getFlashColor();
-	ofSetColor(color.r, color.g, color.b, cur_alpha * color.a * m_settings->getAlpha());
-	ofRectMode rectMode = ofGetRectMode();
-	ofSetRectMode(OF_RECTMODE_CORNER);
-	ofDrawRectangle(x, y-s_charHeight, characterWidth(c), s_charHeight);
-	ofSetRectMode(rectMode);
+	ofColor color = m_settings->getFlashColor();
+	color.a *= cur_alpha * m_settings->getAlpha();
+	s_renderer->drawRectangle(x, y-s_charHeight, characterWidth(c), s_charHeight, color);
 }
 
 //--------------------------------------------------------------
@@ -1752,12 +2095,10 @@ void ofxEditor::drawCursor(int x, int y) {
 		else {
 			float maxCW = (BLOWUP_FLASHES - m_blowup) / BLOWUP_FLASHES * (CURSOR_MAX_WIDTH * s_cursorWidth * 0.5f) + s_cursorWidth * 0.5f;
 			float maxCH = (BLOWUP_FLASHES - m_blowup) / BLOWUP_FLASHES * (CURSOR_MAX_HEIGHT * s_charHeight) + s_charHeight;
-			ofSetColor(m_settings->getCursorColor().r, m_settings->getCursorColor().g,
-					   m_settings->getCursorColor().b, m_settings->getCursorColor().a * m_settings->getAlpha() * m_blowup/BLOWUP_FLASHES);
-			ofRectMode rectMode = ofGetRectMode();
-			ofSetRectMode(OF_RECTMODE_CORNER);
-			ofDrawRectangle(MAX(x+maxCW/2, x), MAX(y-s_charHeight+maxCH/2, y-s_charHeight), MAX(maxCW, s_cursorWidth), MAX(maxCH, s_charHeight));
-			ofSetRectMode(rectMode);
+			ofColor color = m_settings->getCursorColor();
+			color.a *= m_settings->getAlpha() * m_blowup/BLOWUP_FLASHES;
+			s_renderer->drawRectangle(MAX(x+maxCW/2, x), MAX(y-s_charHeight+maxCH/2, y-s_charHeight),
+			                          MAX(maxCW, s_cursorWidth), MAX(maxCH, s_charHeight), color);
 		}
 	}
 	else {
@@ -1766,26 +2107,37 @@ void ofxEditor::drawCursor(int x, int y) {
 			m_flash = 0;
 		}
 		if(m_flash > HALF_FLASH_RATE) {
-			ofSetColor(m_settings->getCursorColor().r, m_settings->getCursorColor().g,
-					   m_settings->getCursorColor().b, m_settings->getCursorColor().a * m_settings->getAlpha());
-			ofRectMode rectMode = ofGetRectMode();
-			ofSetRectMode(OF_RECTMODE_CORNER);
-			ofDrawRectangle(x, y-s_charHeight, s_cursorWidth, s_charHeight);
-			ofSetRectMode(rectMode);
+			ofColor color = m_settings->getCursorColor();
+			color.a *= m_settings->getAlpha();
+			s_renderer->drawRectangle(x, y-s_charHeight, s_cursorWidth, s_charHeight, color);
 		}
 	}
 }
 
 //--------------------------------------------------------------
 void ofxEditor::drawLineNumber(int &x, int &y, int &currentLine) {
+	OFXEDITOR_PROFILE_SCOPE(DRAW_LINE_NUMBERS);
 	s_font->pushState();
 	s_font->setColor(m_settings->getLineNumberColor(), m_settings->getAlpha());
 	
 	currentLine++;
-	string currentLineString = ofToString(currentLine);
-	x += s_zeroWidth*(ofToString(m_numLines).length()-currentLineString.length()); // leading space padding
-	for(int i = 0; i < currentLineString.length(); ++i) {
-		x = s_font->drawCharacter(currentLineString[i], x, y, s_textShadow);
+	
+	// format right to left on the stack instead of ofToString
+	char digits[LINE_NUMBER_DIGITS];
+	int start = LINE_NUMBER_DIGITS;
+	unsigned int n = currentLine;
+	do {
+		digits[--start] = '0' + n % 10;
+		n /= 10;
+	} while(n > 0);
+	int padding = 1;
+	for(n = m_numLines; n >= 10; n /= 10) {
+		padding++;
+	}
+	padding -= LINE_NUMBER_DIGITS - start;
+	x += s_zeroWidth*padding; // leading space padding
+	for(int i = start; i < LINE_NUMBER_DIGITS; ++i) {
+		x = s_font->drawCharacter(digits[i], x, y, s_textShadow);
 	}
 	x += s_charWidth; // the trailing space
 	
@@ -1802,6 +2154,38 @@ void ofxEditor::processTabs() {
 	}
 }
 
+//--------------------------------------------------------------
+void ofxEditor::updateFileSyntax(const std::string &filename) {
+	ofxEditorSyntax *syntax = m_settings->getSyntaxForFileExt(ofFilePath::getFileExt(filename));
+	if(m_syntax != syntax) {
+		m_syntax = syntax;
+		if(m_colorScheme) parseTextBlocks();
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxEditor::isEditKey(int key, bool modifierPressed) {
+	if(modifierPressed) {
+		switch(key) {
+			case 'a': case 10: // clear all text
+				return ofGetKeyPressed(OF_KEY_SHIFT);
+			case 'x': case 24: case 'v': case 22:
+			case 'z': case 26: case 'y': case 25:
+				return true;
+			default:
+				return false;
+		}
+	}
+	switch(key) {
+		case OF_KEY_RIGHT: case OF_KEY_LEFT: case OF_KEY_UP: case OF_KEY_DOWN:
+		case OF_KEY_END: case OF_KEY_HOME: case OF_KEY_PAGE_UP: case OF_KEY_PAGE_DOWN:
+		case OF_KEY_SHIFT: case OF_KEY_ESC:
+			return false;
+		default:
+			return true;
+	}
+}
+
 //--------------------------------------------------------------
 int ofxEditor::offsetToCurrentLineStart() {
 	return m_position - lineStart(m_position);
@@ -1952,6 +2336,119 @@ unsigned int ofxEditor::lineNumberForPos(unsigned int pos) {
 	return ret;
 }
 
+//--------------------------------------------------------------
+void ofxEditor::lineStarts(const std::u32string &text, std::vector<unsigned int> &starts) {
+	starts.clear();
+	starts.push_back(0);
+	for(size_t pos = text.find('\n'); pos != u32string::npos; pos = text.find('\n', pos+1)) {
+		starts.push_back(pos+1);
+	}
+	starts.push_back(text.size()+1);
+}
+
+//--------------------------------------------------------------
+// Myers' O(ND) diff on line hashes between the common leading & trailing
+// lines, see "An O(ND) Difference Algorithm and Its Variations"
+void ofxEditor::mapLines(const std::u32string &oldText, const std::vector<unsigned int> &oldLines,
+                         const std::u32string &newText, const std::vector<unsigned int> &newLines,
+                         std::vector<unsigned int> &lineMap) {
+	int n = oldLines.size()-1, m = newLines.size()-1;
+	auto hashLines = [](const std::u32string &text, const std::vector<unsigned int> &lines) {
+		std::vector<uint64_t> hashes(lines.size()-1);
+		for(size_t i = 0; i < hashes.size(); ++i) {
+			uint64_t hash = 14695981039346656037ULL; // FNV-1a
+			for(unsigned int c = lines[i]; c < lines[i+1]-1; ++c) {
+				hash = (hash ^ text[c]) * 1099511628211ULL;
+			}
+			hashes[i] = hash;
+		}
+		return hashes;
+	};
+	std::vector<uint64_t> oldHashes = hashLines(oldText, oldLines);
+	std::vector<uint64_t> newHashes = hashLines(newText, newLines);
+	auto equal = [&](int a, int b) {
+		unsigned int size = oldLines[a+1] - oldLines[a];
+		return oldHashes[a] == newHashes[b] && size == newLines[b+1] - newLines[b] &&
+		       oldText.compare(oldLines[a], size-1, newText, newLines[b], size-1) == 0;
+	};
+	lineMap.resize(n);
+	
+	// common leading & trailing lines
+	int start = 0, end = 0;
+	while(start < n && start < m && equal(start, start)) {
+		lineMap[start] = start;
+		start++;
+	}
+	while(end < n-start && end < m-start && equal(n-1-end, m-1-end)) {
+		lineMap[n-1-end] = m-1-end;
+		end++;
+	}
+	int oldSize = n-start-end, newSize = m-start-end;
+	if(oldSize == 0) {
+		return;
+	}
+	if(newSize == 0) { // removed, map to the following line
+		for(int i = 0; i < oldSize; ++i) {
+			lineMap[start+i] = MIN(start, m-1);
+		}
+		return;
+	}
+	
+	// furthest reaching paths for each number of edits d, kept for each d
+	// to walk back along the shortest edit script
+	int maxEdits = MIN(oldSize+newSize, DIFF_MAX_EDITS);
+	std::vector<int> v(2*maxEdits+3, 0);
+	std::vector<int> trace;
+	int offset = maxEdits+1, edits = -1;
+	for(int d = 0; d <= maxEdits && edits < 0; ++d) {
+		for(int k = -d; k <= d; k += 2) {
+			int x = (k == -d || (k != d && v[offset+k-1] < v[offset+k+1])) ?
+			         v[offset+k+1] : v[offset+k-1]+1;
+			int y = x - k;
+			while(x < oldSize && y < newSize && equal(start+x, start+y)) {
+				x++;
+				y++;
+			}
+			v[offset+k] = x;
+			if(x >= oldSize && y >= newSize) {
+				edits = d;
+				break;
+			}
+		}
+		trace.insert(trace.end(), v.begin()+offset-d, v.begin()+offset+d+1);
+	}
+	if(edits < 0) { // too many changes, map proportionally
+		for(int i = 0; i < oldSize; ++i) { // 64 bit, i*newSize overflows int
+			lineMap[start+i] = MIN(start + (int)((int64_t)i*newSize/oldSize), m-1);
+		}
+		return;
+	}
+	
+	// walk back, removed lines map to the new line at the same place
+	int x = oldSize, y = newSize;
+	for(int d = edits; d > 0; --d) {
+		const int *prev = &trace[(d-1)*(d-1)] + d-1; // d-1 edits, indexed by k
+		int k = x - y;
+		int prevK = (k == -d || (k != d && prev[k-1] < prev[k+1])) ? k+1 : k-1;
+		int prevX = prev[prevK], prevY = prevX - prevK;
+		while(x > prevX && y > prevY) {
+			x--;
+			y--;
+			lineMap[start+x] = start+y;
+		}
+		if(prevK == k-1) { // removed
+			lineMap[start+prevX] = MIN(start+prevY, m-1);
+		}
+		x = prevX;
+		y = prevY;
+	}
+	while(x > 0 && y > 0) {
+		x--;
+		y--;
+		lineMap[start+x] = start+y;
+	}
+}
+
 //--------------------------------------------------------------
 void ofxEditor::copySelection() {
 	
@@ -1993,7 +2490,7 @@ void ofxEditor::pasteSelection() {
 				updateUndo(ACTION_REPLACE, m_highlightStart, s_copyBuffer, m_text.substr(m_highlightStart, m_highlightEnd-m_highlightStart));
 			}
 			else {
-				updateUndo(ACTION_INSERT, m_position, s_copyBuffer, L"");
+				updateUndo(ACTION_INSERT, m_position, s_copyBuffer, U"");
 			}
 		}
 		insertText(s_copyBuffer);
@@ -2036,8 +2533,10 @@ void ofxEditor::clearBoundingBox() {
 
 //--------------------------------------------------------------
 void ofxEditor::textBufferUpdated() {
+	OFXEDITOR_PROFILE_BEGIN(TEXT_UPDATE);
 	
 	if(m_colorScheme) {
+		OFXEDITOR_PROFILE_SCOPE(TEXT_PARSE);
 		parseTextBlocks();
 	}
 	else {
@@ -2054,6 +2553,117 @@ void ofxEditor::textBufferUpdated() {
 	if(!m_lineWrapping) {
 		m_desiredXPos = offsetToCurrentLineStart();
 	}
+	
+	OFXEDITOR_PROFILE_END(TEXT_UPDATE);
+	OFXEDITOR_PROFILE_COMMIT(TEXT_UPDATE, TEXT_PARSE);
+}
+
+//--------------------------------------------------------------
+void ofxEditor::textBufferInserted(unsigned int pos, unsigned int length) {
+	if(length == 0) {
+		return;
+	}
+	textBufferReplaced(pos, length, U"");
+}
+
+//--------------------------------------------------------------
+void ofxEditor::textBufferReplaced(unsigned int pos, unsigned int length, const std::u32string &removed) {
+	OFXEDITOR_PROFILE_BEGIN(TEXT_UPDATE);
+	
+	m_numLines += count(m_text.begin()+pos, m_text.begin()+pos+length, '\n');
+	m_numLines -= count(removed.begin(), removed.end(), '\n');
+	if(m_colorScheme) {
+		OFXEDITOR_PROFILE_SCOPE(TEXT_PARSE);
+		
+		// changed lines: from the line start at pos to the end of the line
+		// the change ends in, unless a whole line was inserted at a line start
+		unsigned int start = lineStart(pos);
+		unsigned int end = pos + length;
+		if(start != pos || length == 0 || !removed.empty() || m_text[end-1] != '\n') {
+			size_t newline = m_text.find('\n', end);
+			end = (newline == std::u32string::npos ? m_text.size() : newline+1);
+		}
+		
+		// find the old blocks for the changed lines walking back from the end,
+		// blocks for a line begin after the previous line's ENDLINE
+		unsigned int offset = m_text.size() - length + removed.length(); // old text size
+		unsigned int oldEnd = end - length + removed.length();
+		list<TextBlock>::iterator first = m_textBlocks.end(), last = m_textBlocks.end();
+		while(first != m_textBlocks.begin()) {
+			list<TextBlock>::iterator prev = std::prev(first);
+			if(prev->type == ENDLINE) {
+				if(offset == oldEnd) {
+					last = first;
+				}
+				if(offset == start) {
+					break;
+				}
+			}
+			offset -= prev->text.length();
+			first = prev;
+		}
+		
+		// replace them with the new lines
+		list<TextBlock> blocks;
+		parseTextBlocks(start, end, blocks);
+		m_textBlocks.erase(first, last);
+		m_textBlocks.splice(last, blocks);
+	}
+	
+	// adjust max screen width for line numbers
+	if(m_lineNumbers) {
+		m_lineNumWidth = ofToString(m_numLines+1).length()*s_zeroWidth + s_charWidth; // +1 for 10 & 1 extra for the space
+	}
+	
+	// scroll if we've added content at the far right
+	if(!m_lineWrapping) {
+		m_desiredXPos = offsetToCurrentLineStart();
+	}
+	
+	OFXEDITOR_PROFILE_END(TEXT_UPDATE);
+	OFXEDITOR_PROFILE_COMMIT(TEXT_UPDATE, TEXT_PARSE);
+}
+
+//--------------------------------------------------------------
+void ofxEditor::eraseLeadingLines(unsigned int pos) {
+	pos = MIN(pos, m_text.size());
+	if(pos == 0) {
+		return;
+	}
+	unsigned int lines = count(m_text.begin(), m_text.begin()+pos, '\n');
+	m_text.erase(0, pos);
+	
+	// drop the text blocks for the erased lines, the last one is the ENDLINE
+	if(m_colorScheme) {
+		unsigned int length = 0;
+		list<TextBlock>::iterator iter = m_textBlocks.begin();
+		while(iter != m_textBlocks.end() && length < pos) {
+			length += iter->text.length();
+			iter++;
+		}
+		m_textBlocks.erase(m_textBlocks.begin(), iter);
+	}
+	m_numLines = (m_numLines > lines ? m_numLines - lines : 0);
+	if(m_lineNumbers) {
+		m_lineNumWidth = ofToString(m_numLines+1).length()*s_zeroWidth + s_charWidth; // +1 for 10 & 1 extra for the space
+	}
+	
+	unsigned int *positions[] = {
+		&m_position, &m_selectAllStartPos, &m_highlightStart, &m_highlightEnd,
+		&m_topTextPosition, &m_bottomTextPosition, &m_flashStart, &m_flashEnd
+	};
+	for(auto p : positions) {
+		*p = (*p > pos ? *p - pos : 0);
+	}
+	
+	// undo actions within the erased text can't be applied anymore
+	for(auto &action : m_undoActions) {
+		if(action.pos < pos) {
+			clearUndo();
+			break;
+		}
+		action.pos -= pos;
+	}
 }
 
 //--------------------------------------------------------------
@@ -2112,10 +2722,10 @@ void ofxEditor::updateUndo(UndoActionType type, unsigned int pos, const u32strin
 	
 	UndoAction *action = &m_undoActions[m_undoPos];
 	
-	// add new entry if timeout reached, after a replace, or on new type ...
-	// .., except overwrites append insert text until timeout
+	// add new entry if timeout reached, for or after a replace, or on new
+	// type ..., except overwrites append insert text until timeout
 	if((ofGetElapsedTimeMillis() - action->timestamp > UNDO_TIMEOUT) ||
-		((action->type == ACTION_REPLACE) ||
+		((type == ACTION_REPLACE || action->type == ACTION_REPLACE) ||
 		 ((type != ACTION_INSERT && action->type != ACTION_OVERWRITE) &&
 		 (action->type != type)))) {
 		UndoAction a;
@@ -2152,14 +2762,43 @@ void ofxEditor::updateUndo(UndoActionType type, unsigned int pos, const u32strin
 #endif
 }
 
+//--------------------------------------------------------------
+void ofxEditor::keyLatencyBegin() {
+#ifdef OFXEDITOR_PROFILING
+	if(m_keyTime == 0) {
+		m_keyTime = (s_keyTime != 0 ? s_keyTime : ofGetElapsedTimeMicros());
+	}
+	s_keyTime = 0;
+#endif
+}
+
+//--------------------------------------------------------------
+void ofxEditor::keyLatencyEnd() {
+#ifdef OFXEDITOR_PROFILING
+	// claim a key marked but not passed on, ie. switching editors
+	if(s_keyTime != 0) {
+		keyLatencyBegin();
+	}
+	if(m_keyTime != 0) {
+		m_keyLatency.add(ofGetElapsedTimeMicros() - m_keyTime);
+		m_keyTime = 0;
+	}
+#endif
+}
+
 // PRIVATE
 
 //--------------------------------------------------------------
-// simple syntax parser
 void ofxEditor::parseTextBlocks() {
-	
 	clearTextBlocks();
-	m_numLines = 0;
+	m_numLines = parseTextBlocks(0, m_text.length(), m_textBlocks);
+}
+
+//--------------------------------------------------------------
+// simple syntax parser
+unsigned int ofxEditor::parseTextBlocks(unsigned int start, unsigned int end, std::list<TextBlock> &blocks) {
+	
+	unsigned int lines = 0;
 	
 	int string = false;
 	bool preprocessor = false;
@@ -2168,49 +2807,49 @@ void ofxEditor::parseTextBlocks() {
 	bool stringLiteral = false;
 	
 	TextBlock tb;
-	for(int i = 0; i < m_text.length(); ++i) {
+	for(int i = start; i < end; ++i) {
 		
 		switch(m_text[i]) {
 		
 			case ' ':
 				if(tb.type != UNKNOWN) {
-					m_textBlocks.push_back(tb);
+					blocks.push_back(tb);
 					tb.clear();
 				}
 				tb.type = SPACE;
 				tb.text = m_text[i];
-				m_textBlocks.push_back(tb);
+				blocks.push_back(tb);
 				tb.clear();
 				break;
 		
 			case '\n':
-				m_numLines++; // compute number of lines while parsing
+				lines++; // compute number of lines while parsing
 				if(tb.type != UNKNOWN) {
-					m_textBlocks.push_back(tb);
+					blocks.push_back(tb);
 					tb.clear();
 				}
 				if(preprocessor) {
-					m_textBlocks.push_back(TextBlock(PREPROCESSOR_END));
+					blocks.push_back(TextBlock(PREPROCESSOR_END));
 					preprocessor = false;
 				}
 				if(singleComment) {
-					m_textBlocks.push_back(TextBlock(COMMENT_END));
+					blocks.push_back(TextBlock(COMMENT_END));
 					singleComment = false;
 				}
 				tb.type = ENDLINE;
 				tb.text = m_text[i];
-				m_textBlocks.push_back(tb);
+				blocks.push_back(tb);
 				tb.clear();
 				break;
 				
 			case '\t':
 				if(tb.type != UNKNOWN) {
-					m_textBlocks.push_back(tb);
+					blocks.push_back(tb);
 					tb.clear();
 				}
 				tb.type = TAB;
 				tb.text = m_text[i];
-				m_textBlocks.push_back(tb);
+				blocks.push_back(tb);
 				tb.clear();
 				break;
 				
@@ -2231,9 +2870,9 @@ void ofxEditor::parseTextBlocks() {
 						tb.type = WORD;
 					}
 					tb.text += m_text[i];
-					m_textBlocks.push_back(tb);
+					blocks.push_back(tb);
 					tb.clear();
-					m_textBlocks.push_back(TextBlock(STRING_END));
+					blocks.push_back(TextBlock(STRING_END));
 					string = false;
 				}
 				else if(string) { // wrong char, keep going
@@ -2241,14 +2880,14 @@ void ofxEditor::parseTextBlocks() {
 				}
 				else { // opening string char
 					if(tb.type != UNKNOWN) {
-						m_textBlocks.push_back(tb);
+						blocks.push_back(tb);
 						tb.clear();
 					}
 					if(tb.type == UNKNOWN) {
 						tb.type = WORD;
 					}
 					tb.text += m_text[i];
-					m_textBlocks.push_back(TextBlock(STRING_BEGIN));
+					blocks.push_back(TextBlock(STRING_BEGIN));
 					string = m_text[i];
 				}
 				break;
@@ -2263,12 +2902,12 @@ void ofxEditor::parseTextBlocks() {
 					else if(tb.type == WORD) {
 						// detect words after punctuation aka (, [, etc
 						if(i > 0 && ispunct(m_text[i-1]) ) {
-							m_textBlocks.push_back(tb);
+							blocks.push_back(tb);
 							tb.clear();
 						}
 					}
 					else if(tb.type != NUMBER) {
-						m_textBlocks.push_back(tb);
+						blocks.push_back(tb);
 						tb.clear();
 					}
 				}
@@ -2302,7 +2941,7 @@ void ofxEditor::parseTextBlocks() {
 								break;
 							}
 						}
-						m_textBlocks.push_back(tb);
+						blocks.push_back(tb);
 						tb.clear();
 					case UNKNOWN:
 						tb.type = WORD;
@@ -2322,12 +2961,12 @@ void ofxEditor::parseTextBlocks() {
 							   m_settings->getWideCloseChars().find(m_text[i], 0) != u32string::npos) {
 								if(tb.type != UNKNOWN && tb.text.length() > 1) {
 									tb.text = tb.text.substr(0, tb.text.length()-1);
-									m_textBlocks.push_back(tb);
+									blocks.push_back(tb);
 									tb.clear();
 								}
 								tb.type = MATCHING_CHAR;
 								tb.text = m_text[i];
-								m_textBlocks.push_back(tb);
+								blocks.push_back(tb);
 								tb.clear();
 							}
 							break;
@@ -2344,10 +2983,10 @@ void ofxEditor::parseTextBlocks() {
 								}
 								else {
 									if(preprocessor) {
-										m_textBlocks.push_back(TextBlock(PREPROCESSOR_END));
+										blocks.push_back(TextBlock(PREPROCESSOR_END));
 										preprocessor = false;
 									}
-									m_textBlocks.push_back(TextBlock(LITERAL_BEGIN));
+									blocks.push_back(TextBlock(LITERAL_BEGIN));
 								}
 								stringLiteral = true;
 								continue;
@@ -2361,10 +3000,10 @@ void ofxEditor::parseTextBlocks() {
 								}
 								else {
 									if(preprocessor) {
-										m_textBlocks.push_back(TextBlock(PREPROCESSOR_END));
+										blocks.push_back(TextBlock(PREPROCESSOR_END));
 										preprocessor = false;
 									}
-									m_textBlocks.push_back(TextBlock(COMMENT_BEGIN));
+									blocks.push_back(TextBlock(COMMENT_BEGIN));
 								}
 								multiComment = true;
 								continue;
@@ -2375,10 +3014,10 @@ void ofxEditor::parseTextBlocks() {
 								if(i <= m_text.size()-m_syntax->getWideSingleLineComment().length() &&
 								   m_text.substr(i, m_syntax->getWideSingleLineComment().length()) == m_syntax->getWideSingleLineComment()) {
 									if(preprocessor) {
-										m_textBlocks.push_back(TextBlock(PREPROCESSOR_END));
+										blocks.push_back(TextBlock(PREPROCESSOR_END));
 										preprocessor = false;
 									}
-									m_textBlocks.push_back(TextBlock(COMMENT_BEGIN));
+									blocks.push_back(TextBlock(COMMENT_BEGIN));
 									singleComment = true;
 									continue;
 								}
@@ -2391,7 +3030,7 @@ void ofxEditor::parseTextBlocks() {
 								// check ahead for preprocessor begin
 								if(i <= m_text.size()-m_syntax->getWidePreprocessor().length() &&
 								   m_text.substr(i, m_syntax->getWidePreprocessor().length()) == m_syntax->getWidePreprocessor()) {
-									m_textBlocks.push_back(TextBlock(PREPROCESSOR_BEGIN));
+									blocks.push_back(TextBlock(PREPROCESSOR_BEGIN));
 									preprocessor = true;
 									continue;
 								}
@@ -2401,12 +3040,12 @@ void ofxEditor::parseTextBlocks() {
 								   m_settings->getWideCloseChars().find(m_text[i], 0) != u32string::npos) {
 									if(tb.type != UNKNOWN && tb.text.length() > 1) {
 										tb.text = tb.text.substr(0, tb.text.length()-1);
-										m_textBlocks.push_back(tb);
+										blocks.push_back(tb);
 										tb.clear();
 									}
 									tb.type = MATCHING_CHAR;
 									tb.text = m_text[i];
-									m_textBlocks.push_back(tb);
+									blocks.push_back(tb);
 									tb.clear();
 									break;
 								}
@@ -2415,12 +3054,12 @@ void ofxEditor::parseTextBlocks() {
 								if(m_syntax->getWideOperatorChars().find(m_text[i], 0) != u32string::npos) {
 									if(tb.type != UNKNOWN && tb.text.length() > 1) {
 										tb.text = tb.text.substr(0, tb.text.length()-1);
-										m_textBlocks.push_back(tb);
+										blocks.push_back(tb);
 										tb.clear();
 									}
 									tb.type = OPERATOR_CHAR;
 									tb.text = m_text[i];
-									m_textBlocks.push_back(tb);
+									blocks.push_back(tb);
 									tb.clear();
 									break;
 								}
@@ -2429,12 +3068,12 @@ void ofxEditor::parseTextBlocks() {
 								if(m_syntax->getWidePunctuationChars().find(m_text[i], 0) != u32string::npos) {
 									if(tb.type != UNKNOWN && tb.text.length() > 1) {
 										tb.text = tb.text.substr(0, tb.text.length()-1);
-										m_textBlocks.push_back(tb);
+										blocks.push_back(tb);
 										tb.clear();
 									}
 									tb.type = PUNCTUATION_CHAR;
 									tb.text = m_text[i];
-									m_textBlocks.push_back(tb);
+									blocks.push_back(tb);
 									tb.clear();
 									break;
 								}
@@ -2446,9 +3085,9 @@ void ofxEditor::parseTextBlocks() {
 								if(tb.text.length() >= m_syntax->getWideMultiLineCommentEnd().length() &&
 									   tb.text.substr(tb.text.length()-m_syntax->getWideMultiLineCommentEnd().length(),
 													  m_syntax->getWideMultiLineCommentEnd().length()) == m_syntax->getWideMultiLineCommentEnd()) {
-									m_textBlocks.push_back(tb); // push latest block
+									blocks.push_back(tb); // push latest block
 									tb.clear();
-									m_textBlocks.push_back(TextBlock(COMMENT_END)); // push comment end
+									blocks.push_back(TextBlock(COMMENT_END)); // push comment end
 									multiComment = false;
 									continue;
 								}
@@ -2459,9 +3098,9 @@ void ofxEditor::parseTextBlocks() {
 								if(tb.text.length() >= m_syntax->getWideStringLiteralEnd().length() &&
 									   tb.text.substr(tb.text.length()-m_syntax->getWideStringLiteralEnd().length(),
 													  m_syntax->getWideStringLiteralEnd().length()) == m_syntax->getWideStringLiteralEnd()) {
-									m_textBlocks.push_back(tb); // push latest block
+									blocks.push_back(tb); // push latest block
 									tb.clear();
-									m_textBlocks.push_back(TextBlock(LITERAL_END)); // push string literal end
+									blocks.push_back(TextBlock(LITERAL_END)); // push string literal end
 									stringLiteral = false;
 									continue;
 								}
@@ -2478,12 +3117,12 @@ void ofxEditor::parseTextBlocks() {
 	
 	// catch any unfinished blocks at the end
 	if(tb.type != UNKNOWN) {
-		m_textBlocks.push_back(tb);
+		blocks.push_back(tb);
 	}
 	
 	// close preprocessor started on last line
 	if(preprocessor) {
-		m_textBlocks.push_back(TextBlock(PREPROCESSOR_END));
+		blocks.push_back(TextBlock(PREPROCESSOR_END));
 	}
 	
 	// catch any unfinished comments, unfinished multiline comments are a
@@ -2491,8 +3130,10 @@ void ofxEditor::parseTextBlocks() {
 	if(singleComment) {
 		TextBlock commentBlock;
 		commentBlock.type = COMMENT_END;
-		m_textBlocks.push_back(commentBlock);
+		blocks.push_back(commentBlock);
 	}
+	
+	return lines;
 }
 
 //--------------------------------------------------------------
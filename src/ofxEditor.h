@@ -25,9 +25,11 @@
 #include "ofMain.h"
 #include "ofxEditorSettings.h"
 #include "ofxEditorColorScheme.h"
+#include "ofxEditorProfiler.h"
 
 // custom fontstash wrapper
 class ofxEditorFont;
+class ofxEditorRenderer;
 class ofxGLEditor;
 
 /// full screen text editor with optional syntax highlighting,
@@ -65,6 +67,87 @@ class ofxEditor {
 		/// is text being drawn with an offset shadow?
 		static bool getTextShadow();
 	
+		/// enable/disable drawing the text shadow in the same batch as the
+		/// text, default: true
+		///
+		/// false draws the shadow as a separate pass which doubles the font
+		/// vertices, mainly useful for comparing performance
+		static void setTextShadowSinglePass(bool singlePass=true);
+	
+		/// is the text shadow drawn in the same batch as the text?
+		static bool getTextShadowSinglePass();
+	
+		/// get the number of font vertices drawn since the last reset
+		static unsigned int getFontNumVertices();
+	
+		/// get the number of font draw calls since the last reset
+		static unsigned int getFontNumDrawCalls();
+	
+		/// reset the font vertex & draw call counters,
+		/// call this at the beginning of a frame to measure per-frame counts
+		static void resetFontDrawStats();
+	
+		/// enable/disable signed distance field glyphs which stay sharp when
+		/// scaled by auto focus without loading the font at larger sizes,
+		/// default: false
+		///
+		/// call this before loadFont()
+		static void setSignedDistanceField(bool sdf=true);
+	
+		/// are glyphs drawn using a signed distance field?
+		static bool getSignedDistanceField();
+	
+		/// set the maximum number of font atlas pages, default: 8
+		///
+		/// glyphs are cached in fixed size atlas textures, when all pages are
+		/// full the least recently used page is cleared & reused
+		///
+		/// call this before loadFont()
+		static void setFontMaxAtlasPages(int maxPages);
+	
+		/// get the number of allocated font atlas pages
+		static int getFontNumAtlasPages();
+	
+		/// get the approximate memory used by the editor font in bytes,
+		/// see ofxEditorFont::getMemoryUsage()
+		static size_t getFontMemoryUsage();
+	
+		/// add a fallback font file, relative to the data path, searched in
+		/// order for glyphs missing from the main font (CJK, emoji, symbols)
+		///
+		/// fallbacks are only opened when first needed,
+		/// call this before loadFont()
+		static void addFontFallback(const std::string &filename);
+	
+		/// add a range of unicode codepoints (inclusive) to rasterize when the
+		/// font is loaded, avoids hitches the first time glyphs are drawn
+		///
+		/// call this before loadFont()
+		static void addFontPrewarmRange(unsigned int first, unsigned int last);
+	
+		/// set the directory for the on-disk font atlas cache, relative to the
+		/// data path, "" disables (default)
+		///
+		/// the rasterized atlas is restored on load so a relaunch skips
+		/// rasterization entirely
+		///
+		/// call this before loadFont()
+		static void setFontCacheDirectory(const std::string &dir);
+	
+		/// save glyphs rasterized since loading to the font atlas cache,
+		/// call this on exit, returns false on error or if the cache is disabled
+		static bool saveFontCache();
+	
+		/// set the renderer used to draw all editors & the editor font,
+		/// default: ofxEditorGLRenderer
+		///
+		/// use an ofxEditorHeadlessRenderer to draw into memory without a GPU,
+		/// ie. for benchmarks & golden image tests
+		static void setRenderer(std::shared_ptr<ofxEditorRenderer> renderer);
+	
+		/// get the current renderer, creates the default GL renderer if needed
+		static std::shared_ptr<ofxEditorRenderer> getRenderer();
+	
 		/// set useSuper = true if you want to use the Super (Windows key, Mac CMD)
 		/// key as the modifier key, otherwise false uses CTRL key
 		/// default: true on Mac & false on all other platforms
@@ -105,6 +188,21 @@ class ofxEditor {
 		/// get the current max number of undo actions
 		static unsigned int getUndoDepth();
 	
+		/// draw the rolling per-phase draw & parse timing stats as a table
+		/// using the editor font, see ofxEditorProfiler for the stats API,
+		/// includes the keystroke latency for an editor if one is given
+		///
+		/// does nothing unless OFXEDITOR_PROFILING is defined
+		static void drawProfiler(float x, float y, ofxEditor *editor=NULL);
+	
+		/// mark a key event which will be handled before the next editor draw,
+		/// ie. by a wrapping class like ofxGLEditor, so the keystroke latency
+		/// includes the time spent before ofxEditor::keyPressed(),
+		/// ignores modifier keys
+		///
+		/// does nothing unless OFXEDITOR_PROFILING is defined
+		static void markKeyPressed(int key);
+	
 	/// \section Main
 		
 		/// draw the editor, pushes view and applies viewport
@@ -137,7 +235,11 @@ class ofxEditor {
 		/// returns true on success
 		virtual bool openFile(std::string filename);
 		
-		/// save the text to a file
+		/// save the text to a file, blocks until written
+		///
+		/// the file is replaced atomically through a synced temp file, see
+		/// ofxEditorFileSaver to save in the background instead
+		///
 		/// returns true on success
 		virtual bool saveFile(std::string filename);
 	
@@ -153,6 +255,12 @@ class ofxEditor {
 		/// set text buffer contents
 		virtual void setText(const std::string& text);
 	
+		/// replace the text buffer contents with a changed version, ie. after
+		/// the file was changed on disk, the cursor, selection & scroll stay
+		/// on the same lines by remapping them through a line diff,
+		/// the change is a single undo action so unsaved edits can be restored
+		virtual void reloadText(const std::u32string& text);
+	
 		/// insert text at the current buffer position
 		virtual void insertText(const std::u32string& text);
 	
@@ -235,6 +343,13 @@ class ofxEditor {
 		/// get auto focus value
 		bool getAutoFocus();
 	
+		/// enable/disable read only, key events can move the cursor, select, &
+		/// copy but not change the text, setting the text directly still works
+		void setReadOnly(bool readOnly=true);
+	
+		/// get read only value
+		bool getReadOnly();
+	
 	/// \section Current Position & Info
 	
 		/// animate the cursor so it's easy to find
@@ -292,6 +407,59 @@ class ofxEditor {
 		/// clear undo actions
 		void clearUndo();
 	
+		/// get the number of saved undo actions, including redo actions
+		unsigned int getNumUndoActions();
+	
+		/// pop the oldest undo actions until at most num are left, clears all
+		/// actions if any pending redo actions would be lost
+		void trimUndo(unsigned int num);
+	
+	/// \section Memory
+	
+		/// approximate heap memory usage in bytes per category
+		struct MemoryUsage {
+			size_t text;       //< text buffer
+			size_t tokens;     //< syntax parser text blocks, estimated
+			size_t undo;       //< undo history
+			size_t scrollback; //< repl text & line history
+			size_t atlas;      //< font glyph atlas, tables, & font data
+			size_t listing;    //< file dialog listing
+			
+			MemoryUsage() : text(0), tokens(0), undo(0), scrollback(0),
+				atlas(0), listing(0) {}
+			
+			/// get the sum of all categories
+			size_t total() const {
+				return text + tokens + undo + scrollback + atlas + listing;
+			}
+			
+			/// add another usage per category
+			MemoryUsage& operator+=(const MemoryUsage &usage);
+		};
+	
+		/// get the memory used by this editor, does not include the shared
+		/// font, see getFontMemoryUsage()
+		virtual MemoryUsage getMemoryUsage();
+	
+	/// \section Profiling
+	
+		/// get the rolling keystroke latency stats in microseconds: the time from
+		/// a key event until the end of the next draw() which shows its effect,
+		/// keys pressed between draws are measured from the first
+		///
+		/// always empty unless OFXEDITOR_PROFILING is defined
+		ofxEditorProfiler::Stats getKeyLatency();
+	
+		/// clear the keystroke latency samples
+		void clearKeyLatency();
+	
+		/// get the number of heap allocations made during the last draw(),
+		/// should be 0 for idle frames once the font atlas & batches are warm
+		///
+		/// counts allocations from all threads, always 0 unless
+		/// OFXEDITOR_COUNT_ALLOCATIONS is defined
+		unsigned int getNumFrameAllocations();
+	
 	/// \section Utils
 	
 		/// draw a wide char string using the current editor font
@@ -317,11 +485,14 @@ class ofxEditor {
 	/// \section Static Variables
 	
 		static std::shared_ptr<ofxEditorFont> s_font; //< global editor font
+		static std::shared_ptr<ofxEditorRenderer> s_renderer; //< global renderer
 		static int s_charWidth;          //< space char pixel width
 		static int s_zeroWidth;          //< zero char pixel width for line nums
 		static int s_charHeight;         //< char block pixel height
 		static int s_cursorWidth;        //< cursor width, 1/3 char width
 		static bool s_textShadow;        //< draw text with a 2px offset shadow?
+		static bool s_textShadowSinglePass; //< draw text shadow in the same batch?
+		static bool s_signedDistanceField; //< use signed distance field glyphs?
 	
 		static bool s_superAsModifier;   //< use the super key as modifier?
 	
@@ -384,6 +555,7 @@ class ofxEditor {
 		ofxEditorSyntax *m_syntax; //< optional lang syntax
 		bool m_lineWrapping; //< enable line wrapping in this editor?
 		bool m_lineNumbers;  //< enable line numbers?
+		bool m_readOnly;     //< ignore key events which change the text?
 		unsigned int m_lineNumWidth; //< line number block width in chars 
 	
 		float m_delta;        //< difference from last timestamp
@@ -489,8 +661,29 @@ class ofxEditor {
 		std::vector<UndoAction> m_undoActions; //< current undo actions
 		int m_undoPos; //< current undo position, -1 denotes no undos left
 	
+	/// \section Keystroke Latency
+	
+		/// start timing a key event if one isn't already pending, uses the
+		/// time from markKeyPressed() if set
+		void keyLatencyBegin();
+	
+		/// push the latency sample for the pending key event, if any
+		void keyLatencyEnd();
+	
+		static uint64_t s_keyTime; //< marked key event time in us, 0 if none
+		uint64_t m_keyTime; //< pending key event time in us, 0 if none
+		ofxEditorProfiler::Samples m_keyLatency; //< keystroke latency samples
+	
+	/// \section Frame Memory
+	
+		unsigned int m_frameAllocations; //< heap allocations during last draw()
+	
 	/// \section Helper Functions
 	
+		/// get the heap memory used by a string in bytes, 0 if the string
+		/// fits in the small string buffer
+		static size_t stringMemory(const std::u32string &s);
+	
 		/// get the width of a given character,
 		/// endlines are 1 space and tabs are depending on the tab width setting
 		float characterWidth(int c);
@@ -505,7 +698,7 @@ class ofxEditor {
 		void drawFlashCharBlock(int c, int x, int y);
 	
 		/// draw the cursor at pos
-		void drawCursor(int x, int y);
+		virtual void drawCursor(int x, int y);
 	
 		/// draw current line number starting at a given pos, padded by digit width of last line number
 		void drawLineNumber(int &x, int &y, int &currentLine);
@@ -513,6 +706,13 @@ class ofxEditor {
 		/// replace tabs in buffer with spaces
 		void processTabs();
 	
+		/// set the syntax for the extension of a saved file, reparses if changed
+		void updateFileSyntax(const std::string &filename);
+	
+		/// returns true if a key event changes the text, ie. ignored when
+		/// read only
+		static bool isEditKey(int key, bool modifierPressed);
+	
 		/// get offset in buffer to the current line
 		int offsetToCurrentLineStart();
 	
@@ -543,6 +743,17 @@ class ofxEditor {
 		/// get the number of lines at a buffer pos
 		unsigned int lineNumberForPos(unsigned int pos);
 	
+		/// get the start positions of the lines in a text, ends with
+		/// text.size()+1 so each line is [starts[i], starts[i+1]-1)
+		static void lineStarts(const std::u32string &text, std::vector<unsigned int> &starts);
+	
+		/// diff the lines of two texts & map each old line to the equal new
+		/// line, or the new line at the same place if changed or removed,
+		/// lines are given by lineStarts()
+		static void mapLines(const std::u32string &oldText, const std::vector<unsigned int> &oldLines,
+		                     const std::u32string &newText, const std::vector<unsigned int> &newLines,
+		                     std::vector<unsigned int> &lineMap);
+	
 		/// copy selected text to the system clipboard or copy buffer
 		/// note: clipboard only supported when using a GLFW Window
 		void copySelection();
@@ -571,6 +782,27 @@ class ofxEditor {
 		/// editor area
 		void textBufferUpdated();
 	
+		/// text was inserted into the buffer at pos, update the syntax text
+		/// blocks & line count for the changed lines only
+		///
+		/// the inserted lines are parsed on their own, so a multiline comment
+		/// or string left open above them isn't continued until the next full
+		/// textBufferUpdated()
+		void textBufferInserted(unsigned int pos, unsigned int length);
+	
+		/// text in the buffer at pos was replaced by length chars, update the
+		/// syntax text blocks & line count for the changed lines only,
+		/// see textBufferInserted()
+		void textBufferReplaced(unsigned int pos, unsigned int length, const std::u32string &removed);
+	
+		/// erase the text before pos, which must be the start of a line, &
+		/// shift the buffer positions to match
+		///
+		/// drops the leading syntax text blocks & updates the line count
+		/// instead of a full reparse, so the cost is proportional to the
+		/// erased text
+		void eraseLeadingLines(unsigned int pos);
+	
 		/// update visible char size based on pixel size, char size, & auto focus
 		void updateVisibleSize();
 	
@@ -582,6 +814,11 @@ class ofxEditor {
 	
 		/// parses text into text blocks
 		void parseTextBlocks();
+	
+		/// parses the text between start & end into text blocks, starts
+		/// without any string or comment state so start should be a line
+		/// start, returns the number of lines
+		unsigned int parseTextBlocks(unsigned int start, unsigned int end, std::list<TextBlock> &blocks);
 		
 		/// clears current text block list
 		void clearTextBlocks();
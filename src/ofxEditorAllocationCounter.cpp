@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#include "ofxEditorAllocationCounter.h"
+
+#ifdef OFXEDITOR_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<uint64_t> s_numAllocations(0);
+
+void* operator new(size_t size) {
+	s_numAllocations.fetch_add(1, std::memory_order_relaxed);
+	void *p = std::malloc(size ? size : 1);
+	if(!p) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+
+void operator delete(void *p) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+	std::free(p);
+}
+
+#endif
+
+//--------------------------------------------------------------
+uint64_t ofxEditorAllocationCounter::getNumAllocations() {
+#ifdef OFXEDITOR_COUNT_ALLOCATIONS
+	return s_numAllocations.load(std::memory_order_relaxed);
+#else
+	return 0;
+#endif
+}
+
+//--------------------------------------------------------------
+bool ofxEditorAllocationCounter::isCountingAllocations() {
+#ifdef OFXEDITOR_COUNT_ALLOCATIONS
+	return true;
+#else
+	return false;
+#endif
+}
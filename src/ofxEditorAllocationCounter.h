@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#pragma once
+
+#include <cstdint>
+
+// uncomment or define in your project's compiler flags to count all heap
+// allocations by replacing the global operator new & delete, useful to
+// check that idle frames don't allocate, otherwise getNumAllocations()
+// always returns 0
+//#define OFXEDITOR_COUNT_ALLOCATIONS
+
+/// counts heap allocations made by operator new in all threads
+class ofxEditorAllocationCounter {
+
+	public:
+
+		/// get the total number of heap allocations by operator new since
+		/// startup, always 0 unless OFXEDITOR_COUNT_ALLOCATIONS is defined
+		static uint64_t getNumAllocations();
+
+		/// returns true if the allocation counter was compiled in
+		static bool isCountingAllocations();
+};
@@ -0,0 +1,434 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#include "ofxEditorDirLister.h"
+
+#include "ofMain.h"
+#include "Unicode.h"
+#include "ofxEditorTracer.h"
+
+#include <algorithm>
+#include <sys/stat.h>
+
+#ifndef TARGET_WIN32
+	#include <dirent.h>
+#endif
+
+#ifdef __linux__
+	#include <sys/inotify.h>
+	#include <unistd.h>
+#endif
+
+// number of entries listed before they are handed over
+#define BATCH_SIZE 256
+
+// default max number of cached listings
+#define CACHE_SIZE 16
+
+#ifdef __linux__
+	// events which change a listing
+	#define WATCH_EVENTS (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | \
+	                      IN_DELETE_SELF | IN_MOVE_SELF)
+#endif
+
+//--------------------------------------------------------------
+static time_t modificationTime(const std::string &path) {
+	struct stat info;
+	return (stat(path.c_str(), &info) == 0 ? info.st_mtime : 0);
+}
+
+//--------------------------------------------------------------
+ofxEditorDirLister::ofxEditorDirLister() {
+	m_requested = false;
+	m_listing = false;
+	m_generation = 0;
+	m_done = false;
+	m_workerQuit = false;
+	m_cacheSize = CACHE_SIZE;
+	m_watcher = -1;
+	m_listingWatch = -1;
+	m_listingChanged = false;
+#ifdef __linux__
+	m_watcher = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if(m_watcher < 0) {
+		ofLogVerbose("ofxEditorDirLister") << "inotify not available, checking modification times";
+	}
+#endif
+}
+
+//--------------------------------------------------------------
+ofxEditorDirLister::~ofxEditorDirLister() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_generation++;
+		m_workerQuit = true;
+	}
+	m_workerCondition.notify_one();
+	if(m_worker.joinable()) {
+		m_worker.join();
+	}
+#ifdef __linux__
+	if(m_watcher >= 0) {
+		close(m_watcher); // removes all watches
+	}
+#endif
+}
+
+//--------------------------------------------------------------
+void ofxEditorDirLister::list(const std::string &path) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_path = path;
+		m_generation++;
+		m_batch.clear();
+		m_done = false;
+		
+		// done right away if cached
+		CacheEntry *cached = findCached(path);
+		if(cached) {
+			m_batch = cached->entries;
+			m_done = true;
+			m_requested = false;
+			m_listing = false;
+			return;
+		}
+		m_requested = true;
+		if(!m_worker.joinable()) {
+			m_worker = std::thread(&ofxEditorDirLister::work, this);
+		}
+	}
+	m_workerCondition.notify_one();
+}
+
+//--------------------------------------------------------------
+void ofxEditorDirLister::cancel() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_generation++;
+	m_requested = false;
+	m_listing = false;
+	m_batch.clear();
+	m_done = false;
+}
+
+//--------------------------------------------------------------
+ofxEditorDirLister::Result ofxEditorDirLister::pop(std::vector<Entry> &entries) {
+	entries.clear();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(m_batch.empty() && !m_done) {
+		return NONE;
+	}
+	entries.swap(m_batch);
+	if(m_done) {
+		m_done = false;
+		return DONE;
+	}
+	return BATCH;
+}
+
+//--------------------------------------------------------------
+bool ofxEditorDirLister::isListing() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_requested || m_listing || m_done || !m_batch.empty();
+}
+
+//--------------------------------------------------------------
+std::string ofxEditorDirLister::getPath() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_path;
+}
+
+//--------------------------------------------------------------
+void ofxEditorDirLister::setCacheSize(unsigned int size) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_cacheSize = size;
+	while(m_cache.size() > m_cacheSize) {
+		removeCached(--m_cache.end());
+	}
+}
+
+//--------------------------------------------------------------
+unsigned int ofxEditorDirLister::getCacheSize() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_cacheSize;
+}
+
+//--------------------------------------------------------------
+bool ofxEditorDirLister::clearCache() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(m_cache.empty()) {
+		return false;
+	}
+	auto iter = m_cache.begin();
+	while(iter != m_cache.end()) {
+		iter = removeCached(iter);
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+size_t ofxEditorDirLister::getMemoryUsage() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	size_t bytes = 0;
+	for(auto &cached : m_cache) {
+		bytes += sizeof(CacheEntry) + 2*sizeof(void*) + cached.path.capacity();
+		bytes += cached.entries.capacity() * sizeof(Entry);
+		for(auto &entry : cached.entries) {
+			bytes += entry.name.capacity() * sizeof(char32_t);
+		}
+	}
+	return bytes;
+}
+
+// PRIVATE
+
+//--------------------------------------------------------------
+bool ofxEditorDirLister::listPath(const std::string &path, unsigned int generation,
+                                  std::vector<Entry> &entries) {
+	OFXEDITOR_TRACE_SCOPE("ofxEditorDirLister::listPath", "file");
+	std::vector<Entry> batch;
+	batch.reserve(BATCH_SIZE);
+	
+	// add an entry & hand over full batches, returns false if stale
+	auto add = [&](const std::string &name, bool directory) {
+		batch.push_back({string_to_wstring(name), directory});
+		entries.push_back(batch.back());
+		if(batch.size() >= BATCH_SIZE) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return publish(batch, false, generation);
+		}
+		return m_generation.load(std::memory_order_relaxed) == generation;
+	};
+	
+#ifdef TARGET_WIN32
+	ofDirectory dir(path);
+	dir.listDir();
+	for(size_t i = 0; i < dir.size(); ++i) {
+		if(!add(dir.getName(i), dir.getFile(i).isDirectory())) {
+			return false;
+		}
+	}
+#else
+	DIR *dir = opendir(path.c_str());
+	if(!dir) {
+		ofLogWarning("ofxEditorDirLister") << "couldn't list " << path;
+		return true;
+	}
+	struct dirent *ent;
+	while((ent = readdir(dir)) != NULL) {
+		if(ent->d_name[0] == '.') { // hidden, . & ..
+			continue;
+		}
+		
+		// the entry type saves a stat call, except for links & some file systems
+		bool directory = (ent->d_type == DT_DIR);
+		if(ent->d_type == DT_UNKNOWN || ent->d_type == DT_LNK) {
+			struct stat info;
+			std::string entPath = ofFilePath::join(path, ent->d_name);
+			directory = (stat(entPath.c_str(), &info) == 0 && S_ISDIR(info.st_mode));
+		}
+		if(!add(ent->d_name, directory)) {
+			closedir(dir);
+			return false;
+		}
+	}
+	closedir(dir);
+#endif
+
+	// dirs first, then by name
+	std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+		if(a.directory != b.directory) {
+			return a.directory;
+		}
+		return a.name < b.name;
+	});
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ofxEditorDirLister::publish(std::vector<Entry> &entries, bool done, unsigned int generation) {
+	if(m_generation.load() != generation) {
+		return false;
+	}
+	if(done) { // replaces any entries which haven't been popped
+		m_batch.swap(entries);
+		m_done = true;
+		m_listing = false;
+	}
+	else {
+		m_batch.insert(m_batch.end(), entries.begin(), entries.end());
+	}
+	entries.clear();
+	return true;
+}
+
+//--------------------------------------------------------------
+void ofxEditorDirLister::work() {
+	while(true) {
+		std::string path;
+		unsigned int generation;
+		int watched = -1;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_workerCondition.wait(lock, [this] {return m_requested || m_workerQuit;});
+			if(m_workerQuit) {
+				return;
+			}
+			path = m_path;
+			generation = m_generation.load();
+			m_requested = false;
+			m_listing = true;
+			
+			// watch before listing so changes while listing aren't missed
+			if(m_cacheSize > 0) {
+				watched = watch(path);
+			}
+			m_listingWatch = watched;
+			m_listingChanged = false;
+		}
+		time_t listed = time(NULL);
+		time_t modified = modificationTime(path);
+		std::vector<Entry> entries;
+		bool complete = listPath(path, generation, entries);
+		
+		std::lock_guard<std::mutex> lock(m_mutex);
+		readWatchEvents();
+		if(complete && m_generation.load() == generation) {
+			if(m_cacheSize > 0 && !m_listingChanged) {
+				addCached(path, entries, modified, listed, watched);
+			}
+			publish(entries, true, generation);
+		}
+		m_listingWatch = -1;
+		unwatch(watched);
+	}
+}
+
+//--------------------------------------------------------------
+ofxEditorDirLister::CacheEntry* ofxEditorDirLister::findCached(const std::string &path) {
+	readWatchEvents();
+	for(auto iter = m_cache.begin(); iter != m_cache.end(); ++iter) {
+		if(iter->path != path) {
+			continue;
+		}
+		
+		// without a watch, the modification time must be the same & older than
+		// the listing as it may only have a resolution of a second
+		if(iter->watch < 0) {
+			time_t modified = modificationTime(path);
+			if(modified == 0 || modified != iter->modified || modified >= iter->listed) {
+				removeCached(iter);
+				return NULL;
+			}
+		}
+		m_cache.splice(m_cache.begin(), m_cache, iter);
+		return &m_cache.front();
+	}
+	return NULL;
+}
+
+//--------------------------------------------------------------
+void ofxEditorDirLister::addCached(const std::string &path, const std::vector<Entry> &entries,
+                                   time_t modified, time_t listed, int watch) {
+	for(auto iter = m_cache.begin(); iter != m_cache.end(); ++iter) {
+		if(iter->path == path) {
+			removeCached(iter);
+			break;
+		}
+	}
+	m_cache.push_front({path, entries, modified, listed, watch});
+	while(m_cache.size() > m_cacheSize) {
+		removeCached(--m_cache.end());
+	}
+}
+
+//--------------------------------------------------------------
+std::list<ofxEditorDirLister::CacheEntry>::iterator ofxEditorDirLister::removeCached(std::list<CacheEntry>::iterator iter) {
+	int watch = iter->watch;
+	iter = m_cache.erase(iter);
+	unwatch(watch);
+	return iter;
+}
+
+//--------------------------------------------------------------
+int ofxEditorDirLister::watch(const std::string &path) {
+#ifdef __linux__
+	if(m_watcher >= 0) {
+		return inotify_add_watch(m_watcher, path.c_str(), WATCH_EVENTS);
+	}
+#endif
+	return -1;
+}
+
+//--------------------------------------------------------------
+void ofxEditorDirLister::unwatch(int watch) {
+#ifdef __linux__
+	if(watch < 0 || watch == m_listingWatch) {
+		return;
+	}
+	for(auto &cached : m_cache) { // the same directory may be cached by another path
+		if(cached.watch == watch) {
+			return;
+		}
+	}
+	inotify_rm_watch(m_watcher, watch);
+#endif
+}
+
+//--------------------------------------------------------------
+void ofxEditorDirLister::readWatchEvents() {
+#ifdef __linux__
+	if(m_watcher < 0) {
+		return;
+	}
+	alignas(struct inotify_event) char buffer[4096];
+	ssize_t length;
+	while((length = read(m_watcher, buffer, sizeof(buffer))) > 0) {
+		for(char *pos = buffer; pos < buffer + length;) {
+			const struct inotify_event *event = (const struct inotify_event *)pos;
+			pos += sizeof(struct inotify_event) + event->len;
+			
+			// lost events, anything may have changed
+			if(event->mask & IN_Q_OVERFLOW) {
+				m_listingChanged = true;
+				auto iter = m_cache.begin();
+				while(iter != m_cache.end()) {
+					iter = removeCached(iter);
+				}
+				continue;
+			}
+			if(event->wd == m_listingWatch) {
+				m_listingChanged = true;
+			}
+			auto iter = m_cache.begin();
+			while(iter != m_cache.end()) {
+				if(iter->watch == event->wd) {
+					iter->watch = -1; // removed by the kernel if ignored
+					if(!(event->mask & IN_IGNORED)) {
+						iter->watch = event->wd;
+					}
+					iter = removeCached(iter);
+				}
+				else {
+					++iter;
+				}
+			}
+		}
+	}
+#endif
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// lists directories on a worker thread & hands the entries over in batches
+///
+/// hidden entries are skipped, starting a new listing cancels the current one
+/// & any of its entries which haven't been popped are dropped
+///
+/// complete listings are cached per path, least recently used first out, &
+/// listing a cached path is done right away, cached listings are invalidated
+/// by inotify events on Linux or by checking the directory modification
+/// time otherwise
+class ofxEditorDirLister {
+
+	public:
+
+		/// directory entry
+		struct Entry {
+			std::u32string name;
+			bool directory;
+		};
+
+		/// pop result
+		enum Result {
+			NONE = 0, //< nothing new
+			BATCH,    //< new entries in listing order
+			DONE      //< the complete listing, dirs first & sorted by name
+		};
+
+		ofxEditorDirLister();
+		virtual ~ofxEditorDirLister(); //< cancels & waits for the worker
+
+		/// start listing a directory, cancels the current listing
+		void list(const std::string &path);
+
+		/// cancel the current listing
+		void cancel();
+
+		/// get the entries listed since the last call, main thread only
+		///
+		/// returns BATCH with the new entries while listing & DONE with the
+		/// complete listing once finished, entries is replaced either way
+		Result pop(std::vector<Entry> &entries);
+
+		/// returns true if listing or the result hasn't been popped yet
+		bool isListing();
+
+		/// get the path being listed or last listed
+		std::string getPath();
+
+		/// set/get the max number of cached listings, 0 to disable,
+		/// default 16
+		void setCacheSize(unsigned int size);
+		unsigned int getCacheSize();
+
+		/// remove all cached listings, returns false if there were none
+		bool clearCache();
+
+		/// get the approximate heap memory used by cached listings in bytes
+		size_t getMemoryUsage();
+
+	private:
+
+		/// list a path into entries, worker thread, hands over batches while
+		/// listing & returns false if stopped early as the listing is stale
+		bool listPath(const std::string &path, unsigned int generation,
+		              std::vector<Entry> &entries);
+
+		/// hand over listed entries, returns false if the listing is stale,
+		/// call with the mutex locked
+		bool publish(std::vector<Entry> &entries, bool done, unsigned int generation);
+
+		/// worker thread loop
+		void work();
+
+		/// cached listing
+		struct CacheEntry {
+			std::string path;
+			std::vector<Entry> entries; //< complete listing
+			time_t modified; //< directory modification time when listed
+			time_t listed;   //< listing start time
+			int watch;       //< inotify watch descriptor, -1 if none
+		};
+
+		/// find a valid cached listing & make it the most recent,
+		/// removes a stale one, call with the mutex locked
+		CacheEntry* findCached(const std::string &path);
+
+		/// add a listing to the cache, call with the mutex locked
+		void addCached(const std::string &path, const std::vector<Entry> &entries,
+		               time_t modified, time_t listed, int watch);
+
+		/// remove a cached listing & its watch, call with the mutex locked
+		std::list<CacheEntry>::iterator removeCached(std::list<CacheEntry>::iterator iter);
+
+		/// add an inotify watch for a path, returns -1 if not available,
+		/// call with the mutex locked
+		int watch(const std::string &path);
+
+		/// remove an inotify watch unless a cached listing uses it,
+		/// call with the mutex locked
+		void unwatch(int watch);
+
+		/// remove the cached listings changed since the last call,
+		/// call with the mutex locked
+		void readWatchEvents();
+
+		std::mutex m_mutex;
+		std::string m_path; //< current path
+		bool m_requested; //< has a new path been requested?
+		bool m_listing; //< is the current path being listed?
+		std::atomic<unsigned int> m_generation; //< current listing, stale if changed
+		std::vector<Entry> m_batch; //< entries waiting to be popped
+		bool m_done; //< is the batch the complete listing?
+
+		std::list<CacheEntry> m_cache; //< cached listings, most recent first
+		unsigned int m_cacheSize; //< max number of cached listings
+		int m_watcher; //< inotify instance, -1 if not available
+		int m_listingWatch; //< watch for the path being listed, -1 if none
+		bool m_listingChanged; //< has the path being listed changed?
+
+		std::thread m_worker; //< started on the first listing
+		std::condition_variable m_workerCondition;
+		bool m_workerQuit; //< tell the worker to exit
+};
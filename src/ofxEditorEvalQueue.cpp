@@ -0,0 +1,289 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#include "ofxEditorEvalQueue.h"
+
+#include "ofxEditorTracer.h"
+
+// max number of cancelled or timed out request ids kept to drop late results,
+// the oldest is forgotten first
+#define MAX_ORPHANS 256
+
+// request being run by this thread
+static thread_local const ofxEditorEvalQueue::Request *t_request = nullptr;
+static thread_local const std::atomic<bool> *t_cancelled = nullptr;
+
+//--------------------------------------------------------------
+static float secondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+}
+
+//--------------------------------------------------------------
+ofxEditorEvalQueue::ofxEditorEvalQueue() {
+	m_nextId = 1;
+	m_timeout = 0;
+	m_workerBusy = false;
+	m_workerQuit = false;
+}
+
+//--------------------------------------------------------------
+ofxEditorEvalQueue::~ofxEditorEvalQueue() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_queued.clear();
+		if(m_running) {
+			m_running->cancelled.store(true);
+		}
+		m_workerQuit = true;
+	}
+	m_workerCondition.notify_one();
+	if(m_worker.joinable()) {
+		m_worker.join();
+	}
+}
+
+//--------------------------------------------------------------
+unsigned int ofxEditorEvalQueue::push(int editor, const std::string &text,
+                                      Executor executor, Handler handler, bool returnOnExit) {
+	std::shared_ptr<State> state = std::make_shared<State>();
+	state->request.editor = editor;
+	state->request.text = text;
+	state->executor = executor;
+	state->handler = handler;
+	state->returnOnExit = returnOnExit;
+	state->cancelled.store(false);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	state->request.id = m_nextId++;
+	m_queued.push_back(state);
+	return state->request.id;
+}
+
+//--------------------------------------------------------------
+bool ofxEditorEvalQueue::complete(const std::string &text) {
+	if(!t_request) { // not in a handler, don't guess which request this is for
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(m_mutex);
+	completeId(t_request->id, text);
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ofxEditorEvalQueue::complete(unsigned int id, const std::string &text) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return completeId(id, text);
+}
+
+//--------------------------------------------------------------
+bool ofxEditorEvalQueue::cancel(unsigned int id) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for(auto iter = m_queued.begin(); iter != m_queued.end(); ++iter) {
+		if((*iter)->request.id == id) {
+			m_results.push_back({id, (*iter)->request.editor, CANCELLED, "", 0});
+			m_queued.erase(iter);
+			return true;
+		}
+	}
+	if(m_running && m_running->request.id == id) {
+		m_running->cancelled.store(true);
+		finish(CANCELLED, "");
+		return true;
+	}
+	return false;
+}
+
+//--------------------------------------------------------------
+void ofxEditorEvalQueue::cancelAll() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(m_running) {
+		m_running->cancelled.store(true);
+		finish(CANCELLED, "");
+	}
+	for(auto &state : m_queued) {
+		m_results.push_back({state->request.id, state->request.editor, CANCELLED, "", 0});
+	}
+	m_queued.clear();
+}
+
+//--------------------------------------------------------------
+void ofxEditorEvalQueue::update() {
+	std::shared_ptr<State> deferred;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if(m_running && m_timeout > 0 && secondsSince(m_runningStart) > m_timeout) {
+			m_running->cancelled.store(true);
+			finish(TIMED_OUT, "");
+		}
+
+		// start the next request once the worker is free, a timed out eval
+		// may still be using the interpreter
+		if(m_running || m_workerBusy || m_queued.empty()) {
+			return;
+		}
+		m_running = m_queued.front();
+		m_queued.pop_front();
+		m_runningStart = std::chrono::steady_clock::now();
+		if(m_running->executor == WORKER) {
+			if(!m_worker.joinable()) {
+				m_worker = std::thread(&ofxEditorEvalQueue::work, this);
+			}
+			m_workerState = m_running;
+			m_workerBusy = true;
+			m_workerCondition.notify_one();
+		}
+		else {
+			deferred = m_running;
+		}
+	}
+	if(deferred) {
+		run(deferred);
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxEditorEvalQueue::pop(Result &result) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(m_results.empty()) {
+		return false;
+	}
+	result = std::move(m_results.front());
+	m_results.pop_front();
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ofxEditorEvalQueue::isBusy() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_running || !m_queued.empty();
+}
+
+//--------------------------------------------------------------
+unsigned int ofxEditorEvalQueue::getNumQueued() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_queued.size();
+}
+
+//--------------------------------------------------------------
+unsigned int ofxEditorEvalQueue::getRunningId() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_running ? m_running->request.id : 0;
+}
+
+//--------------------------------------------------------------
+float ofxEditorEvalQueue::getRunningTime() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_running ? secondsSince(m_runningStart) : 0;
+}
+
+//--------------------------------------------------------------
+void ofxEditorEvalQueue::setTimeout(float seconds) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_timeout = (seconds < 0 ? 0 : seconds);
+}
+
+//--------------------------------------------------------------
+float ofxEditorEvalQueue::getTimeout() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_timeout;
+}
+
+//--------------------------------------------------------------
+const ofxEditorEvalQueue::Request* ofxEditorEvalQueue::getCurrentRequest() {
+	return t_request;
+}
+
+//--------------------------------------------------------------
+unsigned int ofxEditorEvalQueue::getCurrentId() {
+	return t_request ? t_request->id : 0;
+}
+
+//--------------------------------------------------------------
+bool ofxEditorEvalQueue::isCancelled() {
+	return t_cancelled && t_cancelled->load(std::memory_order_relaxed);
+}
+
+// PRIVATE
+
+//--------------------------------------------------------------
+void ofxEditorEvalQueue::run(std::shared_ptr<State> state) {
+	{
+		OFXEDITOR_TRACE_SCOPE_ARG("eval", "eval", "id", state->request.id);
+		t_request = &state->request;
+		t_cancelled = &state->cancelled;
+		state->handler(state->request);
+		t_request = nullptr;
+		t_cancelled = nullptr;
+	}
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(state->returnOnExit) {
+		if(m_running == state) {
+			finish(DONE, "");
+		}
+		else {
+			m_orphans.erase(state->request.id);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofxEditorEvalQueue::finish(Status status, const std::string &text) {
+	m_results.push_back({m_running->request.id, m_running->request.editor,
+		status, text, secondsSince(m_runningStart)});
+	if(status != DONE) { // may still return later
+		m_orphans.insert(m_running->request.id);
+		if(m_orphans.size() > MAX_ORPHANS) {
+			m_orphans.erase(m_orphans.begin());
+		}
+	}
+	m_running.reset();
+}
+
+//--------------------------------------------------------------
+bool ofxEditorEvalQueue::completeId(unsigned int id, const std::string &text) {
+	if(id == 0) {
+		return false;
+	}
+	if(m_running && m_running->request.id == id) {
+		finish(DONE, text);
+		return true;
+	}
+	if(m_orphans.erase(id) > 0) { // late result, drop it
+		return true;
+	}
+	return false;
+}
+
+//--------------------------------------------------------------
+void ofxEditorEvalQueue::work() {
+	while(true) {
+		std::shared_ptr<State> state;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_workerCondition.wait(lock, [this] {return m_workerState || m_workerQuit;});
+			if(m_workerQuit) {
+				return;
+			}
+			state = m_workerState;
+			m_workerState.reset();
+		}
+		run(state);
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_workerBusy = false;
+	}
+}
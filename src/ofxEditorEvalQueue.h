@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+/// ordered queue of repl & script eval requests
+///
+/// requests run one at a time in order, either deferred on the main thread
+/// by update() or on a single worker thread, & finish when the eval returns
+/// a result with complete(), is cancelled, or times out
+///
+/// a cancelled or timed out request can't be interrupted, so the next
+/// request waits until the worker is free & any late result is dropped,
+/// long running evals should poll isCancelled() if possible
+///
+/// results are matched to requests by id only, a result returned after the
+/// handler exits needs the id from getCurrentId() captured in the handler
+class ofxEditorEvalQueue {
+
+	public:
+
+		/// where eval events are run
+		enum Executor {
+			SYNC = 0, //< right away within the key event, blocks drawing
+			DEFERRED, //< on the main thread by update(), after the next frame
+			WORKER    //< on a worker thread, never blocks the main thread
+		};
+
+		/// request status
+		enum Status {
+			DONE = 0,  //< returned a result
+			CANCELLED, //< cancelled by cancel()
+			TIMED_OUT  //< ran longer than the timeout
+		};
+
+		/// eval request
+		struct Request {
+			unsigned int id;   //< unique id, starting at 1
+			int editor;        //< 0 for the repl, editor index for a script
+			std::string text;  //< text to eval, copied when queued
+		};
+
+		/// finished request
+		struct Result {
+			unsigned int id;
+			int editor;
+			Status status;
+			std::string text; //< returned text, if any
+			float seconds;    //< time since the request started running
+		};
+
+		/// runs the eval for a request, ie. calls the listener
+		typedef std::function<void(const Request &request)> Handler;
+
+		ofxEditorEvalQueue();
+		virtual ~ofxEditorEvalQueue(); //< cancels all & waits for the worker
+
+		/// queue an eval request, returns the request id
+		///
+		/// set returnOnExit to finish the request when the handler returns
+		/// instead of waiting for complete(), ie. for script events
+		unsigned int push(int editor, const std::string &text,
+		                  Executor executor, Handler handler, bool returnOnExit=false);
+
+		/// return a result for the request being run by the calling thread,
+		/// thread safe
+		///
+		/// returns false if the calling thread isn't running a request so the
+		/// result should be handled synchronously
+		bool complete(const std::string &text);
+
+		/// return a result for a request by id, ie. from a later deferred
+		/// return, thread safe
+		///
+		/// returns false if the id is 0 or not running & not a cancelled or
+		/// timed out request, so the result should be handled synchronously
+		bool complete(unsigned int id, const std::string &text);
+
+		/// cancel a queued or running request, returns false if not found
+		bool cancel(unsigned int id);
+
+		/// cancel all queued & running requests
+		void cancelAll();
+
+		/// start the next request & check the timeout, main thread only,
+		/// deferred requests are run from here
+		void update();
+
+		/// pop the oldest finished request, main thread only,
+		/// returns false if there are none
+		bool pop(Result &result);
+
+		/// returns true if a request is queued or running
+		bool isBusy();
+
+		/// get the number of requests waiting to run
+		unsigned int getNumQueued();
+
+		/// get the running request id, 0 if none
+		unsigned int getRunningId();
+
+		/// get the running time of the current request in seconds
+		float getRunningTime();
+
+		/// set/get the max running time of a request in seconds,
+		/// 0 for no timeout, default 0
+		void setTimeout(float seconds);
+		float getTimeout();
+
+		/// get the request being run by the calling thread, NULL if none,
+		/// ie. to read the queued script text from a worker
+		static const Request* getCurrentRequest();
+
+		/// get the id of the request being run by the calling thread, 0 if none,
+		/// keep it to complete() the request after the handler returns
+		static unsigned int getCurrentId();
+
+		/// returns true if the request being run by the calling thread was
+		/// cancelled or timed out
+		static bool isCancelled();
+
+	private:
+
+		/// shared request state, kept alive by the executor while running
+		struct State {
+			Request request;
+			Executor executor;
+			Handler handler;
+			bool returnOnExit;
+			std::atomic<bool> cancelled;
+		};
+
+		/// run a request's handler on the calling thread
+		void run(std::shared_ptr<State> state);
+
+		/// finish the running request, call with the mutex locked
+		void finish(Status status, const std::string &text);
+
+		/// complete a request by id, call with the mutex locked
+		bool completeId(unsigned int id, const std::string &text);
+
+		/// worker thread loop
+		void work();
+
+		std::mutex m_mutex;
+		std::deque<std::shared_ptr<State>> m_queued; //< waiting to run
+		std::shared_ptr<State> m_running; //< running request, if any
+		std::chrono::steady_clock::time_point m_runningStart; //< running start time
+		std::set<unsigned int> m_orphans; //< cancelled requests which may still return
+		std::deque<Result> m_results; //< finished requests
+		unsigned int m_nextId; //< next request id
+		float m_timeout; //< max running time in seconds, 0 for none
+
+		std::thread m_worker; //< started on the first worker request
+		std::condition_variable m_workerCondition;
+		std::shared_ptr<State> m_workerState; //< handed over to the worker
+		bool m_workerBusy; //< is the worker running a handler?
+		bool m_workerQuit; //< tell the worker to exit
+};
@@ -0,0 +1,752 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#include "ofxEditorFileIndex.h"
+
+#include "ofMain.h"
+#include "Unicode.h"
+#include "ofxEditorTracer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <sys/stat.h>
+
+#ifndef TARGET_WIN32
+	#include <dirent.h>
+#endif
+
+#ifdef __linux__
+	#include <sys/inotify.h>
+	#include <unistd.h>
+#endif
+
+// how often the worker checks for file system events in ms
+#define WATCH_INTERVAL 100
+
+// how often the search is repeated while scanning in ms
+#define SEARCH_INTERVAL 250
+
+#ifdef __linux__
+	// events which change the index
+	#define WATCH_EVENTS (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | \
+	                      IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR)
+#endif
+
+// utils
+static inline char lowercase(char c);
+static uint64_t charMask(const std::string &s);
+static uint64_t millis();
+static inline void matchBackward(const char *query, int &q, const char *text, int size,
+                                 int offset, int bonus, int &last, int &score);
+
+//--------------------------------------------------------------
+ofxEditorFileIndex::ofxEditorFileIndex() {
+	m_generation = 0;
+	m_requested = false;
+	m_scanning = false;
+	m_version = 0;
+	m_size = 0;
+	m_watcher = -1;
+	m_watchLimit = false;
+	m_maxResults = 0;
+	m_searchId = 0;
+	m_searchRequested = false;
+	m_resultsReady = false;
+	m_prevVersion = 0;
+	m_prevTime = 0;
+	m_workerQuit = false;
+#ifdef __linux__
+	m_watcher = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+}
+
+//--------------------------------------------------------------
+ofxEditorFileIndex::~ofxEditorFileIndex() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_generation++;
+		m_searchId++;
+		m_workerQuit = true;
+	}
+	m_workerCondition.notify_one();
+	if(m_worker.joinable()) {
+		m_worker.join();
+	}
+#ifdef __linux__
+	if(m_watcher >= 0) {
+		close(m_watcher); // removes all watches
+	}
+#endif
+}
+
+//--------------------------------------------------------------
+bool ofxEditorFileIndex::setRoot(const std::string &path) {
+	std::string root = ofFilePath::addTrailingSlash(ofFilePath::getAbsolutePath(path));
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if(root == m_root) {
+			return false;
+		}
+		m_root = root;
+	}
+	refresh();
+	return true;
+}
+
+//--------------------------------------------------------------
+std::string ofxEditorFileIndex::getRoot() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_root;
+}
+
+//--------------------------------------------------------------
+void ofxEditorFileIndex::refresh() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if(m_root == "") {
+			return;
+		}
+		m_generation++;
+		m_requested = true;
+		if(!m_worker.joinable()) {
+			m_worker = std::thread(&ofxEditorFileIndex::work, this);
+		}
+	}
+	m_workerCondition.notify_one();
+}
+
+//--------------------------------------------------------------
+bool ofxEditorFileIndex::isIndexing() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_requested || m_scanning;
+}
+
+//--------------------------------------------------------------
+bool ofxEditorFileIndex::isWatching() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_watcher >= 0 && !m_watchLimit;
+}
+
+//--------------------------------------------------------------
+size_t ofxEditorFileIndex::size() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_size;
+}
+
+//--------------------------------------------------------------
+unsigned int ofxEditorFileIndex::getVersion() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_version;
+}
+
+//--------------------------------------------------------------
+void ofxEditorFileIndex::search(const std::u32string &query, size_t maxResults) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_query = query;
+		m_maxResults = maxResults;
+		m_searchId++;
+		m_searchRequested = (query != U"");
+		if(!m_searchRequested) { // keeps the current results while typing
+			m_results.clear();
+			m_resultsReady = true;
+			return;
+		}
+		if(!m_worker.joinable()) {
+			m_worker = std::thread(&ofxEditorFileIndex::work, this);
+		}
+	}
+	m_workerCondition.notify_one();
+}
+
+//--------------------------------------------------------------
+bool ofxEditorFileIndex::getResults(std::vector<Match> &results) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(!m_resultsReady) {
+		return false;
+	}
+	results.swap(m_results);
+	m_results.clear();
+	m_resultsReady = false;
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ofxEditorFileIndex::isSearching() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_searchRequested;
+}
+
+//--------------------------------------------------------------
+size_t ofxEditorFileIndex::getMemoryUsage() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	size_t bytes = m_dirs.capacity() * sizeof(Dir);
+	for(const Dir &dir : m_dirs) {
+		bytes += dir.path.capacity() + dir.names.capacity() + dir.files.capacity() * sizeof(File);
+	}
+	bytes += m_freeDirs.capacity() * sizeof(uint32_t);
+	bytes += m_dirIndices.bucket_count() * sizeof(void*);
+	for(auto &index : m_dirIndices) {
+		bytes += sizeof(index) + sizeof(void*) + index.first.capacity();
+	}
+	bytes += m_watches.bucket_count() * sizeof(void*);
+	bytes += m_watches.size() * (sizeof(std::pair<int, uint32_t>) + sizeof(void*));
+	bytes += m_prevMatches.capacity() * sizeof(Location);
+	for(const Match &match : m_results) {
+		bytes += sizeof(Match) + match.path.capacity() * sizeof(char32_t);
+	}
+	return bytes;
+}
+
+// PRIVATE
+
+//--------------------------------------------------------------
+bool ofxEditorFileIndex::scan(const std::string &root, const std::string &path, unsigned int generation) {
+	OFXEDITOR_TRACE_SCOPE("ofxEditorFileIndex::scan", "file");
+	std::vector<std::string> paths = {path};
+	std::string names;
+	std::vector<File> files;
+	auto add = [&](const std::string &name) {
+		files.push_back({(uint32_t)names.size(), (uint32_t)name.size(), charMask(name)});
+		names += name;
+	};
+	while(!paths.empty()) {
+		std::string dirPath = paths.back();
+		std::string absPath = root + dirPath;
+		paths.pop_back();
+		if(m_generation.load(std::memory_order_relaxed) != generation) {
+			return false;
+		}
+
+		// watch before listing so files created while listing aren't missed
+		int watch = -1;
+	#ifdef __linux__
+		if(m_watcher >= 0) {
+			watch = inotify_add_watch(m_watcher, absPath.c_str(), WATCH_EVENTS);
+			if(watch < 0 && errno == ENOSPC) {
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if(!m_watchLimit) {
+					ofLogWarning("ofxEditorFileIndex") << "inotify watch limit reached, "
+						<< "some dirs aren't updated until refreshed";
+					m_watchLimit = true;
+				}
+			}
+		}
+	#endif
+
+		names.clear();
+		files.clear();
+	#ifdef TARGET_WIN32
+		ofDirectory dir(absPath);
+		dir.listDir();
+		for(size_t i = 0; i < dir.size(); ++i) {
+			if(dir.getFile(i).isDirectory()) {
+				paths.push_back(dirPath + dir.getName(i) + "/");
+			}
+			else {
+				add(dir.getName(i));
+			}
+		}
+	#else
+		DIR *dir = opendir(absPath.c_str());
+		if(!dir) {
+			continue;
+		}
+		struct dirent *ent;
+		while((ent = readdir(dir)) != NULL) {
+			if(ent->d_name[0] == '.') { // hidden, . & ..
+				continue;
+			}
+
+			// linked dirs aren't followed to avoid loops
+			bool directory = (ent->d_type == DT_DIR);
+			if(ent->d_type == DT_UNKNOWN || ent->d_type == DT_LNK) {
+				struct stat info;
+				std::string entPath = absPath + ent->d_name;
+				if(stat(entPath.c_str(), &info) != 0) {
+					continue;
+				}
+				if(S_ISDIR(info.st_mode)) {
+					if(ent->d_type == DT_LNK) {
+						continue;
+					}
+					directory = true;
+				}
+			}
+			if(directory) {
+				paths.push_back(dirPath + ent->d_name + "/");
+			}
+			else {
+				add(ent->d_name);
+			}
+		}
+		closedir(dir);
+	#endif
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if(m_generation.load() != generation) {
+			#ifdef __linux__
+				if(watch >= 0) {
+					inotify_rm_watch(m_watcher, watch);
+				}
+			#endif
+				return false;
+			}
+			addDir(dirPath, watch, names, files);
+		}
+		updateSearch(SEARCH_INTERVAL);
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+uint32_t ofxEditorFileIndex::addDir(const std::string &path, int watch, std::string &names,
+                                    std::vector<File> &files) {
+	uint32_t index;
+	auto iter = m_dirIndices.find(path);
+	if(iter != m_dirIndices.end()) { // already added from an event, replace
+		index = iter->second;
+		m_size -= m_dirs[index].files.size();
+	}
+	else if(!m_freeDirs.empty()) {
+		index = m_freeDirs.back();
+		m_freeDirs.pop_back();
+		m_dirIndices[path] = index;
+	}
+	else {
+		index = m_dirs.size();
+		m_dirs.push_back(Dir());
+		m_dirIndices[path] = index;
+	}
+	Dir &dir = m_dirs[index];
+	dir.path = path;
+	dir.mask = charMask(path);
+	dir.watch = watch;
+	dir.used = true;
+	dir.names.swap(names);
+	dir.names.shrink_to_fit();
+	dir.unusedSize = 0;
+	dir.files.swap(files);
+	dir.files.shrink_to_fit();
+	if(watch >= 0) {
+		m_watches[watch] = index;
+	}
+	m_size += dir.files.size();
+	m_version++;
+	return index;
+}
+
+//--------------------------------------------------------------
+void ofxEditorFileIndex::removeDir(const std::string &path) {
+	for(uint32_t i = 0; i < m_dirs.size(); ++i) {
+		Dir &dir = m_dirs[i];
+		if(!dir.used || dir.path.compare(0, path.size(), path) != 0) {
+			continue;
+		}
+	#ifdef __linux__
+		if(dir.watch >= 0) {
+			inotify_rm_watch(m_watcher, dir.watch);
+			m_watches.erase(dir.watch);
+		}
+	#endif
+		m_size -= dir.files.size();
+		m_dirIndices.erase(dir.path);
+		dir = Dir();
+		dir.used = false;
+		m_freeDirs.push_back(i);
+	}
+	m_version++;
+}
+
+//--------------------------------------------------------------
+void ofxEditorFileIndex::addFile(uint32_t dir, const std::string &name) {
+	Dir &d = m_dirs[dir];
+	for(const File &file : d.files) {
+		if(d.names.compare(file.name, file.size, name) == 0) {
+			return;
+		}
+	}
+	d.files.push_back({(uint32_t)d.names.size(), (uint32_t)name.size(), charMask(name)});
+	d.names += name;
+	m_size++;
+	m_version++;
+}
+
+//--------------------------------------------------------------
+void ofxEditorFileIndex::removeFile(uint32_t dir, const std::string &name) {
+	Dir &d = m_dirs[dir];
+	for(size_t i = 0; i < d.files.size(); ++i) {
+		if(d.names.compare(d.files[i].name, d.files[i].size, name) != 0) {
+			continue;
+		}
+		d.unusedSize += d.files[i].size;
+		d.files[i] = d.files.back();
+		d.files.pop_back();
+		m_size--;
+		m_version++;
+
+		// compact once most of the names are unused
+		if(d.unusedSize > d.names.size() / 2) {
+			std::string names;
+			names.reserve(d.names.size() - d.unusedSize);
+			for(File &file : d.files) {
+				uint32_t offset = names.size();
+				names.append(d.names, file.name, file.size);
+				file.name = offset;
+			}
+			d.names.swap(names);
+			d.unusedSize = 0;
+		}
+		return;
+	}
+}
+
+//--------------------------------------------------------------
+void ofxEditorFileIndex::clear() {
+	m_dirs.clear();
+	m_dirs.shrink_to_fit();
+	m_freeDirs.clear();
+	m_dirIndices.clear();
+	m_watches.clear();
+	m_size = 0;
+	m_version++;
+	m_prevQuery = "";
+	m_prevMatches.clear();
+	m_prevMatches.shrink_to_fit();
+	m_watchLimit = false;
+#ifdef __linux__
+	if(m_watcher >= 0) { // faster than removing each watch
+		close(m_watcher);
+		m_watcher = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	}
+#endif
+}
+
+//--------------------------------------------------------------
+bool ofxEditorFileIndex::readWatchEvents(const std::string &root, unsigned int generation) {
+#ifdef __linux__
+	if(m_watcher < 0) {
+		return true;
+	}
+	alignas(struct inotify_event) char buffer[4096];
+	std::vector<std::string> created; // new dirs to scan
+	ssize_t length;
+	while((length = read(m_watcher, buffer, sizeof(buffer))) > 0) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if(m_generation.load() != generation) {
+			return true;
+		}
+		for(char *pos = buffer; pos < buffer + length;) {
+			const struct inotify_event *event = (const struct inotify_event *)pos;
+			pos += sizeof(struct inotify_event) + event->len;
+			if(event->mask & IN_Q_OVERFLOW) { // lost events
+				return false;
+			}
+			auto iter = m_watches.find(event->wd);
+			if(iter == m_watches.end()) {
+				continue;
+			}
+			uint32_t index = iter->second;
+			if(event->mask & IN_IGNORED) { // removed by the kernel
+				m_dirs[index].watch = -1;
+				m_watches.erase(iter);
+				continue;
+			}
+			if(event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+				if(m_dirs[index].path == "") { // root is gone
+					return false;
+				}
+				continue; // subdirs are removed by the parent event
+			}
+			if(event->len == 0 || event->name[0] == '.') {
+				continue;
+			}
+			std::string name = event->name;
+			if(event->mask & IN_ISDIR) {
+				std::string path = m_dirs[index].path + name + "/";
+				if(event->mask & (IN_CREATE | IN_MOVED_TO)) {
+					created.push_back(path);
+				}
+				else {
+					removeDir(path);
+				}
+			}
+			else if(event->mask & (IN_CREATE | IN_MOVED_TO)) {
+				addFile(index, name);
+			}
+			else {
+				removeFile(index, name);
+			}
+		}
+	}
+	for(auto &path : created) {
+		if(!scan(root, path, generation)) {
+			break;
+		}
+	}
+#endif
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ofxEditorFileIndex::match(const std::string &query, const Dir &dir,
+                               const File &file, int &score) {
+
+	// match backwards so the query is matched in the file name if possible
+	int q = query.size() - 1;
+	int last = -1; // previous match position
+	score = 0;
+	matchBackward(query.data(), q, dir.names.data() + file.name, file.size,
+		dir.path.size(), 4, last, score);
+	if(q >= 0) {
+		matchBackward(query.data(), q, dir.path.data(), dir.path.size(), 0, 0, last, score);
+		if(q >= 0) {
+			return false;
+		}
+	}
+	score -= (dir.path.size() + file.size) / 8; // prefer shorter paths
+	return true;
+}
+
+//--------------------------------------------------------------
+void ofxEditorFileIndex::runSearch() {
+	OFXEDITOR_TRACE_SCOPE("ofxEditorFileIndex::runSearch", "file");
+	std::u32string query;
+	size_t maxResults;
+	unsigned int id;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		query = m_query;
+		maxResults = m_maxResults;
+		id = m_searchId.load();
+	}
+	std::string lowerQuery = wstring_to_string(query);
+	for(char &c : lowerQuery) {
+		c = lowercase(c);
+	}
+	uint64_t queryMask = charMask(lowerQuery);
+	std::vector<Location> matches;
+
+	// keep the best matches in a min heap, by score then shortest path
+	struct Scored {
+		int score;
+		size_t length;
+		Location location;
+	};
+	std::vector<Scored> best;
+	best.reserve(maxResults + 1);
+	auto worse = [](const Scored &a, const Scored &b) {
+		return a.score != b.score ? a.score > b.score : a.length < b.length;
+	};
+	auto add = [&](const Dir &dir, const File &file, Location location) {
+		int score;
+		if(((dir.mask | file.mask) & queryMask) != queryMask ||
+		   !match(lowerQuery, dir, file, score)) {
+			return;
+		}
+		matches.push_back(location);
+		Scored scored = {score, dir.path.size() + file.size, location};
+		if(best.size() < maxResults) {
+			best.push_back(scored);
+			std::push_heap(best.begin(), best.end(), worse);
+		}
+		else if(maxResults > 0 && worse(scored, best.front())) {
+			std::pop_heap(best.begin(), best.end(), worse);
+			best.back() = scored;
+			std::push_heap(best.begin(), best.end(), worse);
+		}
+	};
+
+	// the index is only changed by this thread, so it's read without locking,
+	// stops early if there's a newer search
+	if(m_prevVersion == m_version && m_prevQuery != "" &&
+	   lowerQuery.compare(0, m_prevQuery.size(), m_prevQuery) == 0) {
+		for(size_t i = 0; i < m_prevMatches.size(); ++i) { // narrow while typing
+			if(i % 4096 == 0 && m_searchId.load(std::memory_order_relaxed) != id) {
+				return;
+			}
+			const Location &location = m_prevMatches[i];
+			const Dir &dir = m_dirs[location.dir];
+			add(dir, dir.files[location.file], location);
+		}
+	}
+	else {
+		for(uint32_t d = 0; d < m_dirs.size(); ++d) {
+			if(m_searchId.load(std::memory_order_relaxed) != id) {
+				return;
+			}
+			const Dir &dir = m_dirs[d];
+			for(uint32_t f = 0; f < dir.files.size(); ++f) {
+				add(dir, dir.files[f], {d, f});
+			}
+		}
+	}
+	m_prevQuery = lowerQuery;
+	m_prevVersion = m_version;
+	m_prevTime = millis();
+
+	// best first
+	std::sort_heap(best.begin(), best.end(), worse);
+	std::vector<Match> results;
+	results.reserve(best.size());
+	for(const Scored &scored : best) {
+		const Dir &dir = m_dirs[scored.location.dir];
+		const File &file = dir.files[scored.location.file];
+		results.push_back({string_to_wstring(dir.path + dir.names.substr(file.name, file.size)),
+			scored.score});
+	}
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_prevMatches.swap(matches); // counted in the memory usage
+	if(m_searchId.load() == id) {
+		m_results.swap(results);
+		m_resultsReady = true;
+		m_searchRequested = false;
+	}
+}
+
+//--------------------------------------------------------------
+void ofxEditorFileIndex::updateSearch(unsigned int interval) {
+	bool requested;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if(m_query == U"") {
+			return;
+		}
+		requested = m_searchRequested;
+	}
+	if(requested || (m_version != m_prevVersion && millis() - m_prevTime >= interval)) {
+		runSearch();
+	}
+}
+
+//--------------------------------------------------------------
+void ofxEditorFileIndex::work() {
+	while(true) {
+		std::string root;
+		unsigned int generation;
+		bool requested;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			auto ready = [this] {return m_requested || m_searchRequested || m_workerQuit;};
+			if(m_watcher >= 0 && !m_dirs.empty()) {
+				m_workerCondition.wait_for(lock, std::chrono::milliseconds(WATCH_INTERVAL), ready);
+			}
+			else {
+				m_workerCondition.wait(lock, ready);
+			}
+			if(m_workerQuit) {
+				return;
+			}
+			root = m_root;
+			generation = m_generation.load();
+			requested = m_requested;
+			if(requested) {
+				m_requested = false;
+				m_scanning = true;
+				clear();
+			}
+		}
+		if(requested) {
+			scan(root, "", generation);
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if(m_generation.load() == generation) {
+				m_scanning = false;
+				ofLogVerbose("ofxEditorFileIndex") << "indexed " << m_size << " files";
+			}
+		}
+		else if(!readWatchEvents(root, generation)) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if(m_generation.load() == generation) { // rescan
+				m_generation++;
+				m_requested = true;
+			}
+		}
+		updateSearch(0);
+	}
+}
+
+// UTIL
+
+//--------------------------------------------------------------
+uint64_t millis() {
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//--------------------------------------------------------------
+char lowercase(char c) {
+	return ((unsigned char)(c - 'A') < 26 ? c + ('a' - 'A') : c);
+}
+
+//--------------------------------------------------------------
+// match query characters up to q backwards in a text at offset, q & last are
+// updated & each match adds to score
+void matchBackward(const char *query, int &q, const char *text, int size,
+                   int offset, int bonus, int &last, int &score) {
+	for(int i = size - 1; i >= 0; --i) {
+		char c = text[i];
+		if(lowercase(c) != query[q]) {
+			continue;
+		}
+		int pos = offset + i, s = 16 + bonus;
+
+		// word start bonus
+		char prev = (i == 0 ? '/' : text[i - 1]);
+		if(prev == '/' || prev == '_' || prev == '-' || prev == '.' || prev == ' ' ||
+		   ((unsigned char)(prev - 'a') < 26 && (unsigned char)(c - 'A') < 26)) {
+			s += 8;
+		}
+
+		// consecutive bonus or gap penalty
+		if(last == pos + 1) {
+			s += 8;
+		}
+		else if(last >= 0) {
+			s -= std::min(last - pos - 1, 8);
+		}
+		score += s;
+		last = pos;
+		if(--q < 0) {
+			return;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+uint64_t charMask(const std::string &s) {
+	uint64_t mask = 0;
+	for(char ch : s) {
+		unsigned char c = lowercase(ch);
+		if(c >= 'a' && c <= 'z') {
+			mask |= 1ULL << (c - 'a');
+		}
+		else if(c >= '0' && c <= '9') {
+			mask |= 1ULL << (26 + c - '0');
+		}
+		else if(c < 0x80) { // other ASCII share bits
+			mask |= 1ULL << (36 + c % 27);
+		}
+		else { // UTF-8 multibyte
+			mask |= 1ULL << 63;
+		}
+	}
+	return mask;
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/// index of every file under a root path for fuzzy searching
+///
+/// the tree is scanned on a worker thread & can be searched while scanning,
+/// on Linux the index is then kept up to date from inotify events, otherwise
+/// call refresh() to rescan
+///
+/// searches also run on the worker so typing never blocks drawing, the
+/// results are picked up with getResults() once ranked
+///
+/// hidden files & dirs are skipped & linked dirs aren't followed
+class ofxEditorFileIndex {
+
+	public:
+
+		/// search match
+		struct Match {
+			std::u32string path; //< path relative to the root
+			int score; //< higher is better
+		};
+
+		ofxEditorFileIndex();
+		virtual ~ofxEditorFileIndex(); //< stops & waits for the worker
+
+		/// set the root path & start indexing, ignored if the same,
+		/// returns true if changed
+		bool setRoot(const std::string &path);
+		std::string getRoot();
+
+		/// rescan the root path
+		void refresh();
+
+		/// returns true while scanning
+		bool isIndexing();
+
+		/// returns true if the index is kept up to date from file system events
+		bool isWatching();
+
+		/// get the number of indexed files
+		size_t size();
+
+		/// get the index version, changes whenever files are added or removed
+		unsigned int getVersion();
+
+		/// start a fuzzy search for files whose path contains the query
+		/// characters in order, case insensitive for ASCII, ranks the best
+		/// maxResults matches
+		///
+		/// replaces an unfinished search & is repeated whenever the index
+		/// changes, a query which extends the previous one only searches the
+		/// previous matches, "" stops searching
+		void search(const std::u32string &query, size_t maxResults=100);
+
+		/// get the results of the latest search, best first, returns true &
+		/// replaces results if there are new results since the last call
+		bool getResults(std::vector<Match> &results);
+
+		/// returns true if the latest search hasn't finished
+		bool isSearching();
+
+		/// get the approximate heap memory used in bytes
+		size_t getMemoryUsage();
+
+	private:
+
+		/// indexed file
+		struct File {
+			uint32_t name; //< UTF-8 file name offset in the dir names
+			uint32_t size; //< file name size in bytes
+			uint64_t mask; //< characters in the name, see charMask()
+		};
+
+		/// indexed directory, the file names are stored together so
+		/// searching doesn't chase a pointer per file
+		struct Dir {
+			std::string path;  //< UTF-8 path relative to the root with a
+			                   //< trailing /, "" for the root
+			uint64_t mask;     //< characters in the path
+			int watch;         //< inotify watch descriptor, -1 if none
+			bool used;         //< false if removed & free for reuse
+			std::string names; //< file names
+			size_t unusedSize; //< size of removed names not compacted yet
+			std::vector<File> files;
+		};
+
+		/// file location, dir & file index
+		struct Location {
+			uint32_t dir;
+			uint32_t file;
+		};
+
+		/// scan a dir relative to the root & its subdirs into the index,
+		/// worker thread, returns false if stopped early as the root has changed
+		bool scan(const std::string &root, const std::string &path, unsigned int generation);
+
+		/// add a dir & its file names to the index, returns the dir index,
+		/// call with the mutex locked
+		uint32_t addDir(const std::string &path, int watch, std::string &names,
+		                std::vector<File> &files);
+
+		/// remove a dir & its subdirs, call with the mutex locked
+		void removeDir(const std::string &path);
+
+		/// add a file to a dir, call with the mutex locked
+		void addFile(uint32_t dir, const std::string &name);
+
+		/// remove a file from a dir, call with the mutex locked
+		void removeFile(uint32_t dir, const std::string &name);
+
+		/// remove everything & all watches, call with the mutex locked
+		void clear();
+
+		/// apply inotify events, worker thread, returns false if the
+		/// index needs a rescan
+		bool readWatchEvents(const std::string &root, unsigned int generation);
+
+		/// score a match of the lowercase query in a dir path + file name,
+		/// returns false if not a match
+		static bool match(const std::string &query, const Dir &dir,
+		                  const File &file, int &score);
+
+		/// run the requested search & hand over the results, worker thread
+		void runSearch();
+
+		/// run the current search if requested or repeat it if the index has
+		/// changed at least interval ms ago, worker thread
+		void updateSearch(unsigned int interval);
+
+		/// worker thread loop
+		void work();
+
+		std::mutex m_mutex;
+		std::string m_root; //< absolute root path with a trailing /
+		std::atomic<unsigned int> m_generation; //< current scan, stale if changed
+		bool m_requested; //< has a scan been requested?
+		bool m_scanning; //< is the worker scanning?
+		unsigned int m_version; //< index version
+		size_t m_size; //< number of indexed files
+
+		// index, only changed by the worker with the mutex locked
+		std::vector<Dir> m_dirs; //< indexed dirs, removed dirs are reused
+		std::vector<uint32_t> m_freeDirs; //< removed dir indices
+		std::unordered_map<std::string, uint32_t> m_dirIndices; //< dir index by path
+		std::unordered_map<int, uint32_t> m_watches; //< dir index by watch
+
+		int m_watcher; //< inotify instance, -1 if not available
+		bool m_watchLimit; //< has the inotify watch limit been reached?
+
+		std::u32string m_query; //< current search query
+		size_t m_maxResults; //< current search max results
+		std::atomic<unsigned int> m_searchId; //< current search, stale if changed
+		bool m_searchRequested; //< has the current search been requested?
+		std::vector<Match> m_results; //< results waiting to be picked up
+		bool m_resultsReady; //< are there new results?
+
+		// worker thread search state
+		std::string m_prevQuery; //< previous lowercase query
+		unsigned int m_prevVersion; //< index version of the previous search
+		std::vector<Location> m_prevMatches; //< all matches of the previous search
+		uint64_t m_prevTime; //< previous search time in ms
+
+		std::thread m_worker; //< started on the first scan
+		std::condition_variable m_workerCondition;
+		bool m_workerQuit; //< tell the worker to exit
+};
@@ -0,0 +1,262 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#include "ofxEditorFileSaver.h"
+
+#include "ofMain.h"
+#include "Unicode.h"
+#include "ofxEditorTracer.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+
+#ifdef TARGET_WIN32
+	#include <io.h>
+	#include <process.h>
+#else
+	#include <climits>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+// utils
+static std::string tempPath(const std::string &path);
+
+//--------------------------------------------------------------
+ofxEditorFileSaver::ofxEditorFileSaver() {
+	m_writingSize = 0;
+	m_nextId = 1;
+	m_workerQuit = false;
+}
+
+//--------------------------------------------------------------
+ofxEditorFileSaver::~ofxEditorFileSaver() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_workerQuit = true;
+	}
+	m_workerCondition.notify_one();
+	if(m_worker.joinable()) {
+		m_worker.join();
+	}
+}
+
+//--------------------------------------------------------------
+unsigned int ofxEditorFileSaver::save(const std::string &path, std::u32string text) {
+	unsigned int id;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		id = m_nextId++;
+		m_queue.push_back({id, path, std::u32string()});
+		m_queue.back().text.swap(text);
+		m_pending[path]++;
+		if(!m_worker.joinable()) {
+			m_worker = std::thread(&ofxEditorFileSaver::work, this);
+		}
+	}
+	m_workerCondition.notify_one();
+	return id;
+}
+
+//--------------------------------------------------------------
+bool ofxEditorFileSaver::pop(std::vector<Result> &results) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(m_results.empty()) {
+		return false;
+	}
+	results.clear();
+	results.swap(m_results);
+	for(auto &result : results) {
+		auto iter = m_pending.find(result.path);
+		if(iter != m_pending.end() && --iter->second == 0) {
+			m_pending.erase(iter);
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ofxEditorFileSaver::isSaving(const std::string &path) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_pending.find(path) != m_pending.end();
+}
+
+//--------------------------------------------------------------
+bool ofxEditorFileSaver::isSaving() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return !m_pending.empty();
+}
+
+//--------------------------------------------------------------
+size_t ofxEditorFileSaver::getMemoryUsage() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	size_t bytes = m_writingSize;
+	for(auto &request : m_queue) {
+		bytes += request.path.capacity() + request.text.capacity() * sizeof(char32_t);
+	}
+	return bytes;
+}
+
+//--------------------------------------------------------------
+bool ofxEditorFileSaver::write(const std::string &path, const std::string &data, std::string &error) {
+	OFXEDITOR_TRACE_SCOPE("ofxEditorFileSaver::write", "file");
+#ifdef TARGET_WIN32
+	std::string temp = tempPath(path);
+	FILE *file = fopen(temp.c_str(), "wb");
+	if(!file) {
+		error = strerror(errno);
+		return false;
+	}
+	bool ok = (fwrite(data.data(), 1, data.size(), file) == data.size() &&
+	           fflush(file) == 0 && _commit(_fileno(file)) == 0);
+	if(!ok) {
+		error = strerror(errno);
+	}
+	fclose(file);
+	if(ok && !MoveFileExA(temp.c_str(), path.c_str(),
+	                      MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+		error = "couldn't replace file, error " + ofToString(GetLastError());
+		ok = false;
+	}
+	if(!ok) {
+		remove(temp.c_str());
+	}
+	return ok;
+#else
+	// replace the file a link points to, not the link
+	std::string target = path;
+	struct stat info;
+	char resolved[PATH_MAX];
+	if(lstat(path.c_str(), &info) == 0 && S_ISLNK(info.st_mode) &&
+	   realpath(path.c_str(), resolved)) {
+		target = resolved;
+	}
+	bool exists = (stat(target.c_str(), &info) == 0);
+
+	std::string temp = tempPath(target);
+	int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+	if(fd < 0) {
+		error = strerror(errno);
+		return false;
+	}
+	if(exists) { // keep permissions
+		fchmod(fd, info.st_mode & 07777);
+	}
+	bool ok = true;
+	const char *pos = data.data();
+	size_t left = data.size();
+	while(left > 0) {
+		ssize_t written = ::write(fd, pos, left);
+		if(written < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			ok = false;
+			break;
+		}
+		pos += written;
+		left -= written;
+	}
+#ifdef __APPLE__
+	// fsync doesn't flush the drive cache on macOS
+	ok = ok && (fcntl(fd, F_FULLFSYNC) != -1 || fsync(fd) == 0);
+#else
+	ok = ok && fsync(fd) == 0;
+#endif
+	if(!ok) {
+		error = strerror(errno);
+	}
+	if(close(fd) != 0 && ok) {
+		error = strerror(errno);
+		ok = false;
+	}
+	if(ok && rename(temp.c_str(), target.c_str()) != 0) {
+		error = strerror(errno);
+		ok = false;
+	}
+	if(!ok) {
+		unlink(temp.c_str());
+		return false;
+	}
+
+	// sync the rename
+	size_t slash = target.find_last_of('/');
+	std::string dir = (slash == std::string::npos ? "." : target.substr(0, slash + 1));
+	int dirFd = open(dir.c_str(), O_RDONLY | O_CLOEXEC);
+	if(dirFd >= 0) {
+		fsync(dirFd);
+		close(dirFd);
+	}
+	return true;
+#endif
+}
+
+// PRIVATE
+
+//--------------------------------------------------------------
+void ofxEditorFileSaver::work() {
+	while(true) {
+		Request request;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_writingSize = 0;
+			m_workerCondition.wait(lock, [this] {return !m_queue.empty() || m_workerQuit;});
+			if(m_queue.empty()) { // quit once everything is written
+				return;
+			}
+			request.id = m_queue.front().id;
+			request.path.swap(m_queue.front().path);
+			request.text.swap(m_queue.front().text);
+			m_queue.pop_front();
+			m_writingSize = request.path.capacity() + request.text.capacity() * sizeof(char32_t);
+		}
+		Result result = {request.id, request.path, ""};
+		{
+			std::string data = wstring_to_string(request.text);
+			std::u32string().swap(request.text);
+			if(!write(request.path, data, result.error)) {
+				ofLogError("ofxEditorFileSaver") << "couldn't save \""
+					<< ofFilePath::getFileName(request.path) << "\": " << result.error;
+			}
+		}
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_results.push_back(result);
+	}
+}
+
+// UTIL
+
+//--------------------------------------------------------------
+// hidden & unique temp file next to path so the rename stays on the same
+// file system
+std::string tempPath(const std::string &path) {
+	static std::atomic<unsigned int> counter(0);
+	size_t slash = path.find_last_of("/\\");
+	std::string dir = (slash == std::string::npos ? "" : path.substr(0, slash + 1));
+	std::string name = path.substr(slash == std::string::npos ? 0 : slash + 1);
+#ifdef TARGET_WIN32
+	int pid = _getpid();
+#else
+	int pid = getpid();
+#endif
+	return dir + "." + name + "." + ofToString(pid) + "-" + ofToString(counter++) + ".tmp";
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/// saves text files on a worker thread
+///
+/// the text is encoded as UTF-8 on the worker & written to a temp file next
+/// to the file, which is synced to disk & renamed over the file, so a crash
+/// or full disk mid-save leaves either the old or the new file but never a
+/// truncated one
+///
+/// saves are written in the order they are queued
+class ofxEditorFileSaver {
+
+	public:
+
+		/// finished save
+		struct Result {
+			unsigned int id;   //< save id returned by save()
+			std::string path;  //< path as queued
+			std::string error; //< "" on success
+		};
+
+		ofxEditorFileSaver();
+		virtual ~ofxEditorFileSaver(); //< waits for queued saves to finish
+
+		/// queue saving text to a file, returns the save id
+		unsigned int save(const std::string &path, std::u32string text);
+
+		/// get the saves finished since the last call, main thread only,
+		/// returns true & replaces results if there are any
+		bool pop(std::vector<Result> &results);
+
+		/// returns true if a save to a path is queued or running or its result
+		/// hasn't been popped yet
+		bool isSaving(const std::string &path);
+
+		/// returns true if any save is queued or running or its result hasn't
+		/// been popped yet
+		bool isSaving();
+
+		/// get the approximate heap memory used by queued text in bytes
+		size_t getMemoryUsage();
+
+		/// write data to a file atomically through a synced temp file,
+		/// returns false & sets error on failure, safe to call from any thread
+		static bool write(const std::string &path, const std::string &data, std::string &error);
+
+	private:
+
+		/// queued save
+		struct Request {
+			unsigned int id;
+			std::string path;
+			std::u32string text;
+		};
+
+		/// worker thread loop
+		void work();
+
+		std::mutex m_mutex;
+		std::deque<Request> m_queue; //< saves waiting to be written
+		size_t m_writingSize; //< text size of the save being written in bytes
+		std::vector<Result> m_results; //< results waiting to be popped
+		std::unordered_map<std::string, unsigned int> m_pending; //< unpopped saves by path
+		unsigned int m_nextId; //< next save id
+
+		std::thread m_worker; //< started on the first save
+		std::condition_variable m_workerCondition;
+		bool m_workerQuit; //< tell the worker to exit once the queue is empty
+};
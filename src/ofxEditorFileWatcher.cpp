@@ -0,0 +1,373 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#include "ofxEditorFileWatcher.h"
+
+#include "ofMain.h"
+#include "Unicode.h"
+#include "ofxEditorTracer.h"
+
+#include <chrono>
+#include <fstream>
+#include <sys/stat.h>
+
+#ifdef __linux__
+	#include <sys/inotify.h>
+	#include <unistd.h>
+#endif
+
+// how often the worker checks for file system events in ms
+#define WATCH_INTERVAL 100
+
+// how often files are checked without file system events in ms
+#define POLL_INTERVAL 500
+
+#ifdef __linux__
+	// events which may change a file in a watched dir, includes a file being
+	// replaced by a rename but not partial writes, creation is skipped as a
+	// new file may still be empty & is reported once it's closed
+	#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_ONLYDIR)
+#endif
+
+// utils
+static std::string parentDir(const std::string &path);
+static uint64_t millis();
+
+//--------------------------------------------------------------
+ofxEditorFileWatcher::ofxEditorFileWatcher() {
+	m_watcher = -1;
+	m_workerQuit = false;
+#ifdef __linux__
+	m_watcher = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if(m_watcher < 0) {
+		ofLogVerbose("ofxEditorFileWatcher") << "inotify not available, checking modification times";
+	}
+#endif
+}
+
+//--------------------------------------------------------------
+ofxEditorFileWatcher::~ofxEditorFileWatcher() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_workerQuit = true;
+	}
+	m_workerCondition.notify_one();
+	if(m_worker.joinable()) {
+		m_worker.join();
+	}
+#ifdef __linux__
+	if(m_watcher >= 0) {
+		close(m_watcher); // removes all watches
+	}
+#endif
+}
+
+//--------------------------------------------------------------
+void ofxEditorFileWatcher::watch(const std::string &path) {
+	if(path == "") {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto iter = m_files.find(path);
+		if(iter != m_files.end()) {
+			iter->second.refs++;
+			return;
+		}
+		File &file = m_files[path];
+		file.refs = 1;
+		file.generation = 0;
+		file.stamp = stamp(path);
+		file.check = false;
+		watchDir(path);
+		if(!m_worker.joinable()) {
+			m_worker = std::thread(&ofxEditorFileWatcher::work, this);
+		}
+	}
+	m_workerCondition.notify_one();
+}
+
+//--------------------------------------------------------------
+void ofxEditorFileWatcher::unwatch(const std::string &path) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto iter = m_files.find(path);
+	if(iter == m_files.end() || --iter->second.refs > 0) {
+		return;
+	}
+	m_files.erase(iter);
+	unwatchDir(path);
+	for(auto change = m_changes.begin(); change != m_changes.end(); ++change) {
+		if(change->path == path) {
+			m_changes.erase(change);
+			break;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofxEditorFileWatcher::clear() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+#ifdef __linux__
+	for(auto &dir : m_dirs) {
+		if(dir.second.watch >= 0) {
+			inotify_rm_watch(m_watcher, dir.second.watch);
+		}
+	}
+#endif
+	m_files.clear();
+	m_dirs.clear();
+	m_watches.clear();
+	m_changes.clear();
+}
+
+//--------------------------------------------------------------
+void ofxEditorFileWatcher::update(const std::string &path) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto iter = m_files.find(path);
+	if(iter == m_files.end()) {
+		return;
+	}
+	iter->second.generation++;
+	iter->second.stamp = stamp(path);
+	for(auto change = m_changes.begin(); change != m_changes.end(); ++change) {
+		if(change->path == path) {
+			m_changes.erase(change);
+			break;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxEditorFileWatcher::pop(std::vector<Change> &changes) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(m_changes.empty()) {
+		return false;
+	}
+	changes.clear();
+	changes.swap(m_changes);
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ofxEditorFileWatcher::isWatching() {
+	return m_watcher >= 0;
+}
+
+// PRIVATE
+
+//--------------------------------------------------------------
+void ofxEditorFileWatcher::watchDir(const std::string &path) {
+	std::string dirPath = parentDir(path);
+	auto iter = m_dirs.find(dirPath);
+	if(iter != m_dirs.end()) {
+		iter->second.refs++;
+		return;
+	}
+	Dir &dir = m_dirs[dirPath];
+	dir.watch = -1;
+	dir.refs = 1;
+#ifdef __linux__
+	if(m_watcher >= 0) {
+		dir.watch = inotify_add_watch(m_watcher, dirPath.c_str(), WATCH_EVENTS);
+		if(dir.watch >= 0) {
+			m_watches[dir.watch] = dirPath;
+		}
+		else {
+			ofLogVerbose("ofxEditorFileWatcher") << "couldn't watch " << dirPath
+				<< ", checking modification times";
+		}
+	}
+#endif
+}
+
+//--------------------------------------------------------------
+void ofxEditorFileWatcher::unwatchDir(const std::string &path) {
+	auto iter = m_dirs.find(parentDir(path));
+	if(iter == m_dirs.end() || --iter->second.refs > 0) {
+		return;
+	}
+#ifdef __linux__
+	if(iter->second.watch >= 0) {
+		inotify_rm_watch(m_watcher, iter->second.watch);
+		m_watches.erase(iter->second.watch);
+	}
+#endif
+	m_dirs.erase(iter);
+}
+
+//--------------------------------------------------------------
+void ofxEditorFileWatcher::readWatchEvents() {
+#ifdef __linux__
+	if(m_watcher < 0) {
+		return;
+	}
+	alignas(struct inotify_event) char buffer[4096];
+	ssize_t length;
+	while((length = read(m_watcher, buffer, sizeof(buffer))) > 0) {
+		for(char *pos = buffer; pos < buffer + length;) {
+			const struct inotify_event *event = (const struct inotify_event *)pos;
+			pos += sizeof(struct inotify_event) + event->len;
+
+			// lost events, any file may have changed
+			if(event->mask & IN_Q_OVERFLOW) {
+				for(auto &file : m_files) {
+					file.second.check = true;
+				}
+				continue;
+			}
+			auto watch = m_watches.find(event->wd);
+			if(watch == m_watches.end()) {
+				continue;
+			}
+
+			// dir removed, its files are checked by modification time from now on
+			if(event->mask & IN_IGNORED) {
+				auto dir = m_dirs.find(watch->second);
+				if(dir != m_dirs.end()) {
+					dir->second.watch = -1;
+				}
+				m_watches.erase(watch);
+				continue;
+			}
+			if(event->len == 0) {
+				continue;
+			}
+			for(auto &file : m_files) {
+				size_t slash = file.first.find_last_of("/\\");
+				if(file.first.compare(slash+1, std::string::npos, event->name) == 0 &&
+				   parentDir(file.first) == watch->second) {
+					file.second.check = true;
+				}
+			}
+		}
+	}
+#endif
+}
+
+//--------------------------------------------------------------
+void ofxEditorFileWatcher::work() {
+	uint64_t lastPoll = 0;
+	while(true) {
+
+		// files to check, read without the mutex locked
+		struct Check {
+			std::string path;
+			unsigned int generation;
+			Stamp stamp;
+		};
+		std::vector<Check> checks;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if(m_files.empty()) {
+				m_workerCondition.wait(lock, [this] {return !m_files.empty() || m_workerQuit;});
+			}
+			else {
+				m_workerCondition.wait_for(lock, std::chrono::milliseconds(WATCH_INTERVAL),
+				                           [this] {return m_workerQuit;});
+			}
+			if(m_workerQuit) {
+				return;
+			}
+			readWatchEvents();
+			bool poll = (millis() - lastPoll >= POLL_INTERVAL);
+			if(poll) {
+				lastPoll = millis();
+			}
+			for(auto &file : m_files) {
+				if(!file.second.check && poll) {
+					auto dir = m_dirs.find(parentDir(file.first));
+					file.second.check = (dir == m_dirs.end() || dir->second.watch < 0);
+				}
+				if(file.second.check) {
+					checks.push_back({file.first, file.second.generation, file.second.stamp});
+					file.second.check = false;
+				}
+			}
+		}
+		for(auto &check : checks) {
+
+			// a change while reading is seen on the next check as the stamp
+			// is taken first
+			Stamp current = stamp(check.path);
+			if(current == check.stamp || current.size < 0) {
+				continue;
+			}
+			OFXEDITOR_TRACE_SCOPE("ofxEditorFileWatcher::read", "file");
+			std::ifstream stream(check.path, std::ios::binary);
+			if(!stream.is_open()) {
+				continue;
+			}
+			std::string contents((std::istreambuf_iterator<char>(stream)),
+			                     std::istreambuf_iterator<char>());
+			Change change = {check.path, string_to_wstring(contents)};
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto file = m_files.find(check.path);
+			if(file == m_files.end() || file->second.generation != check.generation) {
+				continue; // unwatched or written by the app meanwhile
+			}
+			file->second.stamp = current;
+			bool replaced = false;
+			for(auto &queued : m_changes) {
+				if(queued.path == check.path) {
+					queued.text.swap(change.text);
+					replaced = true;
+					break;
+				}
+			}
+			if(!replaced) {
+				m_changes.push_back(std::move(change));
+			}
+			ofLogVerbose("ofxEditorFileWatcher") << "changed " << check.path;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+ofxEditorFileWatcher::Stamp ofxEditorFileWatcher::stamp(const std::string &path) {
+	struct stat info;
+	if(stat(path.c_str(), &info) != 0) {
+		return {0, -1};
+	}
+#if defined(__linux__)
+	long long modified = info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+	long long modified = info.st_mtimespec.tv_sec * 1000000000LL + info.st_mtimespec.tv_nsec;
+#else
+	long long modified = info.st_mtime;
+#endif
+	return {modified, (long long)info.st_size};
+}
+
+// UTIL
+
+//--------------------------------------------------------------
+std::string parentDir(const std::string &path) {
+	size_t slash = path.find_last_of("/\\");
+	if(slash == std::string::npos) {
+		return ".";
+	}
+	return (slash == 0 ? "/" : path.substr(0, slash));
+}
+
+//--------------------------------------------------------------
+uint64_t millis() {
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/// watches files for changes & reads the changed contents on a worker thread
+///
+/// on Linux the parent dirs are watched with inotify so changes are seen
+/// right away, including files replaced by a rename as many editors save,
+/// otherwise the modification time & size are checked twice a second
+///
+/// a file which is removed is reported once it's created again
+class ofxEditorFileWatcher {
+
+	public:
+
+		/// changed file
+		struct Change {
+			std::string path;   //< path as watched
+			std::u32string text; //< new contents
+		};
+
+		ofxEditorFileWatcher();
+		virtual ~ofxEditorFileWatcher(); //< stops & waits for the worker
+
+		/// start watching a file, changes from now on are reported,
+		/// a file can be watched more than once & needs as many unwatch() calls
+		void watch(const std::string &path);
+
+		/// stop watching a file
+		void unwatch(const std::string &path);
+
+		/// stop watching all files
+		void clear();
+
+		/// the file was just read or written by the app, don't report it & drop
+		/// unpopped changes, main thread only
+		void update(const std::string &path);
+
+		/// get the changes since the last call, main thread only,
+		/// returns true & replaces changes if there are any
+		bool pop(std::vector<Change> &changes);
+
+		/// returns true if changes are seen from file system events
+		bool isWatching();
+
+	private:
+
+		/// file modification time in ns or s & size, size is -1 if missing
+		struct Stamp {
+			long long modified;
+			long long size;
+			bool operator==(const Stamp &from) const {
+				return modified == from.modified && size == from.size;
+			}
+		};
+
+		/// get the current stamp of a file
+		static Stamp stamp(const std::string &path);
+
+		/// watched file
+		struct File {
+			unsigned int refs; //< number of watch() calls
+			unsigned int generation; //< changes on update(), reads before are stale
+			Stamp stamp; //< stamp when last read or updated
+			bool check; //< has an event been seen for the file?
+		};
+
+		/// watched parent dir
+		struct Dir {
+			int watch;         //< inotify watch descriptor, -1 if none
+			unsigned int refs; //< number of watched files in the dir
+		};
+
+		/// add an inotify watch for the parent dir of a path,
+		/// call with the mutex locked
+		void watchDir(const std::string &path);
+
+		/// remove the parent dir watch once no file in it is watched,
+		/// call with the mutex locked
+		void unwatchDir(const std::string &path);
+
+		/// mark files with events for checking, call with the mutex locked
+		void readWatchEvents();
+
+		/// worker thread loop
+		void work();
+
+		std::mutex m_mutex;
+		std::unordered_map<std::string, File> m_files; //< watched files by path
+		std::unordered_map<std::string, Dir> m_dirs; //< watched dirs by path
+		std::unordered_map<int, std::string> m_watches; //< dir path by watch
+		std::vector<Change> m_changes; //< changes waiting to be popped
+		int m_watcher; //< inotify instance, -1 if not available
+
+		std::thread m_worker; //< started on the first watch
+		std::condition_variable m_workerCondition;
+		bool m_workerQuit; //< tell the worker to exit
+};
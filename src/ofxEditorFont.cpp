@@ -20,22 +20,91 @@
 #include "ofxEditorFont.h"
 
 #include "ofMain.h"
+#include "ofxEditorFileSaver.h"
+#include "ofxEditorGLRenderer.h"
 #include "Unicode.h"
 
 #define FONTSTASH_IMPLEMENTATION
 #include "fontstash.h"
-#define GLFONTSTASH_IMPLEMENTATION
-#include "glfontstash.h"
 
-#define ATLAS_MAX_SIZE 2048
+// default max number of atlas pages
+#define MAX_PAGES 8
+
+// largest atlas page texture dimension
+#define PAGE_MAX_SIZE 4096
+
+// shadow offset in pixels
+#define SHADOW_OFFSET 1
+
+// SDF glyph padding in pixels, distance range encoded around each edge
+#define SDF_PADDING 4
+
+// SDF value at the glyph edge & value change per pixel of distance
+#define SDF_ONEDGE 128
+#define SDF_DIST_SCALE (128.0f/SDF_PADDING)
+
+// atlas cache file identifier & format version,
+// bump the version when the cached data layout changes
+#define CACHE_MAGIC "OFXEDFNT"
+#define CACHE_VERSION 3
+
+// highest unicode codepoint
+#define CODEPOINT_MAX 0x10FFFF
+
+/// atlas cache file header, followed by the opened fallback fonts in font id
+/// order: name length, name, & file data hash, then each page: node count,
+/// atlas skyline nodes, glyph count, glyphs, & glyph lookup table per font,
+/// & atlas texture data
+struct ofxEditorFontCacheHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t nodeSize;  //< sizeof(FONSatlasNode)
+	uint32_t glyphSize; //< sizeof(FONSglyph)
+	uint32_t lutSize;   //< FONS_HASH_LUT_SIZE
+	uint64_t key;
+	int32_t pageSize;
+	int32_t npages;
+	int32_t nfonts;
+};
+
+/// 64 bit FNV-1a hash
+static uint64_t fnv1a(const void *data, size_t size, uint64_t hash=14695981039346656037ULL);
+
+/// pack a color as r | g << 8 | b << 16 | a << 24, same as glfonsRGBA
+static unsigned int rgba(unsigned char r, unsigned char g, unsigned char b, unsigned char a);
+
+/// are the cached atlas skyline nodes inside a page?
+static bool validCachedNodes(const std::vector<FONSatlasNode> &nodes, int pageSize);
+
+/// are the cached glyph rects inside a page & the lut & next chain indices
+/// in [-1, nglyphs)?
+static bool validCachedGlyphs(const std::vector<FONSglyph> &glyphs,
+                              const int lut[FONS_HASH_LUT_SIZE], int pageSize);
 
 //--------------------------------------------------------------
 ofxEditorFont::ofxEditorFont() {
-	context = NULL;
+	currentPage = 0;
+	pageSize = 0;
+	maxPages = MAX_PAGES;
+	clock = 0;
+	numEvictions = 0;
+	batchDepth = 0;
 	font = 0;
 	size = 0;
+	isize = 0;
+	scale = 0;
 	lineHeight = 0;
-	textShadowColor = glfonsRGBA(0, 0, 0, 255); // black
+	color = rgba(255, 255, 255, 255); // white
+	textShadowColor = rgba(0, 0, 0, 255); // black
+	singlePassShadow = true;
+	numVertices = 0;
+	numDrawCalls = 0;
+	sdfRequested = false;
+	sdf = false;
+	renderer = ofPtr<ofxEditorRenderer>(new ofxEditorGLRenderer());
+	cacheKey = 0;
+	cacheRestored = false;
+	cacheDirty = false;
 }
 
 //--------------------------------------------------------------
@@ -48,44 +117,143 @@ bool ofxEditorFont::load(std::string filename, int fontsize, int textureDimensio
 	
 	clear();
 	
-	textureDimension = ofNextPow2(textureDimension);
-	context = glfonsCreate(textureDimension, textureDimension, FONS_ZERO_TOPLEFT);
+	pageSize = ofClamp(ofNextPow2(textureDimension), 64, PAGE_MAX_SIZE);
 	
+	// first page loads & owns the font data
+	FONScontext *context = createContext();
+	if(!context) {
+		ofLogError("ofxEditorFont") << "couldn't create font context";
+		return false;
+	}
 	font = fonsAddFont(context, "normal", ofToDataPath(filename).c_str());
 	if(font == FONS_INVALID) {
 		ofLogError("ofxEditorFont") << "couldn't load font: " << filename;
-		if(context) {
-			glfonsDelete(context);
-		}
-		context = NULL;
+		fonsDeleteInternal(context);
 		return false;
 	}
+	pages.push_back(Page());
+	pages.back().context = context;
+	pages.back().lastUsed = 0;
+	currentPage = 0;
+	
 	size = fontsize;
+	isize = (short)(size*10.0f);
+	scale = fons__tt_getPixelHeightScale(&context->fonts[font]->font, size);
 	fonsSetFont(context, font);
 	fonsSetSize(context, size);
-	fonsSetColor(context, glfonsRGBA(255, 255, 255, 255)); // white
 	fonsVertMetrics(context, NULL, NULL, &lineHeight);
-	fonsSetErrorCallback(context, ofxEditorFont::stashError, context);
+	
+	if(sdfRequested) {
+		sdf = renderer->supportsSignedDistanceField();
+		if(!sdf) {
+			ofLogWarning("ofxEditorFont") << "signed distance field unavailable, using bitmap glyphs";
+		}
+	}
+	
+	// restore cached glyphs, key includes everything which changes rasterization
+	cachePath = "";
+	cacheRestored = false;
+	cacheDirty = false;
+	if(!cacheDir.empty()) {
+		FONSfont *f = context->fonts[font];
+		unsigned char glyphType = sdf ? SDF_PADDING : 0;
+		cacheKey = fnv1a(f->data, f->dataSize);
+		cacheKey = fnv1a(&isize, sizeof(isize), cacheKey);
+		cacheKey = fnv1a(&glyphType, sizeof(glyphType), cacheKey);
+		char name[64];
+		snprintf(name, sizeof(name), "ofxEditorFont_%016llx.cache", (unsigned long long)cacheKey);
+		cachePath = ofFilePath::addTrailingSlash(ofToDataPath(cacheDir)) + name;
+		cacheRestored = loadCache();
+	}
+	
+	// rasterize & upload now instead of during the first draws
+	if(!prewarmRanges.empty()) {
+		prewarm();
+	}
+	for(auto &page : pages) {
+		uploadAtlas(page);
+	}
+	if(!cachePath.empty()) {
+		saveCache();
+	}
 	
 	return true;
 }
 
 //--------------------------------------------------------------
 bool ofxEditorFont::isLoaded() {
-	return context != NULL;
+	return !pages.empty();
 }
 
 //--------------------------------------------------------------
 void ofxEditorFont::clear() {
-	if(context) {
-		glfonsDelete(context);
+	// the first page owns the font data, so delete it last
+	for(int i = (int)pages.size()-1; i >= 0; --i) {
+		fonsDeleteInternal(pages[i].context);
+	}
+	pages.clear();
+	glyphPages.clear();
+	metrics.clear();
+	for(auto &fallback : fallbacks) {
+		fallback.font = FONS_INVALID;
+		fallback.failed = false;
 	}
-	context = NULL;
+	currentPage = 0;
+	clock = 0;
+	numEvictions = 0;
+	batchDepth = 0;
 	font = 0;
 	size = 0;
+	isize = 0;
+	scale = 0;
 	lineHeight = 0;
+	colorStack.clear();
+	sdf = false;
+	cachePath = "";
+	cacheRestored = false;
+	cacheDirty = false;
 }
 
+// RENDERER
+
+//--------------------------------------------------------------
+void ofxEditorFont::setRenderer(std::shared_ptr<ofxEditorRenderer> renderer) {
+	if(!renderer || renderer == this->renderer) {
+		return;
+	}
+	if(batchDepth > 0) {
+		flush();
+	}
+	
+	// recreate the atlas textures with the new renderer & upload everything
+	for(auto &page : pages) {
+		Atlas *atlas = (Atlas*)page.context->params.userPtr;
+		if(atlas->handle) {
+			atlas->renderer->deleteAtlas(atlas->handle);
+		}
+		atlas->renderer = renderer.get();
+		atlas->handle = renderer->createAtlas(atlas->width, atlas->height);
+		page.context->dirtyRect[0] = 0;
+		page.context->dirtyRect[1] = 0;
+		page.context->dirtyRect[2] = atlas->width;
+		page.context->dirtyRect[3] = atlas->height;
+		uploadAtlas(page);
+	}
+	this->renderer = renderer;
+	
+	if(sdf && !renderer->supportsSignedDistanceField()) {
+		ofLogWarning("ofxEditorFont") << "renderer doesn't support signed distance field glyphs, "
+		                              << "reload the font to use bitmap glyphs";
+	}
+}
+
+//--------------------------------------------------------------
+std::shared_ptr<ofxEditorRenderer> ofxEditorFont::getRenderer() {
+	return renderer;
+}
+
+// FONT INFO
+
 //--------------------------------------------------------------
 int ofxEditorFont::getFontSize() {
 	return size;
@@ -98,24 +266,66 @@ float ofxEditorFont::getLineHeight() {
 
 //--------------------------------------------------------------
 float ofxEditorFont::characterWidth(int c) {
-	return fonsTextBounds(context, 0, 0, wchar_to_string(c).c_str(), NULL, NULL);
+	if(pages.empty()) {
+		return 0;
+	}
+	return (int)(getMetrics(c).xadv / 10.0f + 0.5f);
 }
 
 //--------------------------------------------------------------
 float ofxEditorFont::stringWidth(const std::string& s) {
-	return fonsTextBounds(context, 0, 0, s.c_str(), NULL, NULL);
+	if(pages.empty()) {
+		return 0;
+	}
+	return measure(s.c_str());
 }
 
 //--------------------------------------------------------------
 float ofxEditorFont::stringWidth(const std::u32string& s) {
-	return stringWidth(wstring_to_string(s));
+	return stringWidth(s.data(), s.size());
+}
+
+//--------------------------------------------------------------
+float ofxEditorFont::stringWidth(const char32_t *s, size_t len) {
+	if(pages.empty()) {
+		return 0;
+	}
+	return measure(s, len);
 }
 
 //--------------------------------------------------------------
 float ofxEditorFont::stringHeight(const std::string& s) {
-	float bounds[4] = {0, 0, 0, 0};
-	fonsTextBounds(context, 0, 0, s.c_str(), NULL, bounds);
-	return bounds[3] - bounds[1]; // maxy - miny
+	if(pages.empty()) {
+		return 0;
+	}
+	
+	// same as fonsTextBounds with top left origin
+	float x = 0, y = 0, miny = 0, maxy = 0;
+	int prevGlyphIndex = -1, prevFont = font;
+	unsigned int utf8state = 0, codepoint = 0;
+	FONSquad q;
+	for(const char *c = s.c_str(); *c; ++c) {
+		if(fons__decutf8(&utf8state, &codepoint, *(const unsigned char*)c)) {
+			continue;
+		}
+		GlyphLocation location;
+		FONSglyph *glyph = getGlyph(codepoint, location);
+		if(glyph) {
+			FONScontext *context = pages[location.page].context;
+			if(location.font != prevFont) {
+				prevGlyphIndex = -1; // no kerning between fonts
+			}
+			fons__getQuad(context, context->fonts[location.font], prevGlyphIndex, glyph, scale, 0, &x, &y, &q);
+			miny = MIN(miny, q.y0);
+			maxy = MAX(maxy, q.y1);
+			prevFont = location.font;
+		}
+		prevGlyphIndex = glyph ? glyph->index : -1;
+	}
+	if(sdf) {
+		return maxy - miny - (SDF_PADDING-1)*2; // same bounds as bitmap glyphs
+	}
+	return maxy - miny;
 }
 
 //--------------------------------------------------------------
@@ -125,72 +335,949 @@ float ofxEditorFont::stringHeight(const std::u32string& s) {
 
 //--------------------------------------------------------------
 float ofxEditorFont::drawCharacter(int c, float x, float y, bool shadowed) {
-	string s = wchar_to_string(c);
-	if(shadowed) {
-		fonsPushState(context);
-		fonsSetColor(context, textShadowColor);
-		fonsDrawText(context, x+1, y+1, s.c_str(), NULL);
-		fonsPopState(context);
+	if(pages.empty()) {
+		return x;
+	}
+	int prevGlyphIndex = -1, prevFont = font;
+	addGlyph(c, x, y, prevGlyphIndex, prevFont, shadowed);
+	if(batchDepth == 0) {
+		flush();
 	}
-	return fonsDrawText(context, x, y, s.c_str(), NULL);
+	return x;
 }
 
 //--------------------------------------------------------------
 float ofxEditorFont::drawString(const std::string& s, float x, float y, bool shadowed) {
-	if(shadowed) {
-		fonsPushState(context);
-		fonsSetColor(context, textShadowColor);
-		fonsDrawText(context, x+1, y+1, s.c_str(), NULL);
-		fonsPopState(context);
+	if(pages.empty()) {
+		return x;
+	}
+	x = addText(s.c_str(), x, y, shadowed);
+	if(batchDepth == 0) {
+		flush();
 	}
-	return fonsDrawText(context, x, y, s.c_str(), NULL);
+	return x;
 }
 
 //--------------------------------------------------------------
 float ofxEditorFont::drawString(const std::u32string& s, float x, float y, bool shadowed) {
-	return drawString(wstring_to_string(s), x, y, shadowed);
+	if(pages.empty()) {
+		return x;
+	}
+	x = addText(s.data(), s.size(), x, y, shadowed);
+	if(batchDepth == 0) {
+		flush();
+	}
+	return x;
+}
+
+//--------------------------------------------------------------
+void ofxEditorFont::beginBatch() {
+	batchDepth++;
+}
+
+//--------------------------------------------------------------
+void ofxEditorFont::endBatch() {
+	if(batchDepth == 0) {
+		return;
+	}
+	batchDepth--;
+	if(batchDepth == 0) {
+		flush();
+	}
 }
 
 //--------------------------------------------------------------
 void ofxEditorFont::setColor(ofColor &c, float alpha) {
-	unsigned int textColor = glfonsRGBA(c.r, c.g, c.b, c.a*alpha);
-	fonsSetColor(context, textColor);
+	color = rgba(c.r, c.g, c.b, c.a*alpha);
 }
 
 //--------------------------------------------------------------
 void ofxEditorFont::setShadowColor(ofColor &c, float alpha) {
-	textShadowColor = glfonsRGBA(c.r, c.g, c.b, c.a*alpha);
+	textShadowColor = rgba(c.r, c.g, c.b, c.a*alpha);
 }
 
 //--------------------------------------------------------------
 void ofxEditorFont::pushState() {
-	fonsPushState(context);
+	colorStack.push_back(color);
 }
 
 //--------------------------------------------------------------
 void ofxEditorFont::popState() {
-	fonsPopState(context);
+	if(colorStack.empty()) {
+		ofLogError("ofxEditorFont") << "state underflow";
+		return;
+	}
+	color = colorStack.back();
+	colorStack.pop_back();
+}
+
+// SHADOW & DRAW STATS
+
+//--------------------------------------------------------------
+void ofxEditorFont::setSinglePassShadow(bool singlePass) {
+	singlePassShadow = singlePass;
+}
+
+//--------------------------------------------------------------
+bool ofxEditorFont::getSinglePassShadow() {
+	return singlePassShadow;
+}
+
+//--------------------------------------------------------------
+unsigned int ofxEditorFont::getNumVertices() {
+	return numVertices;
+}
+
+//--------------------------------------------------------------
+unsigned int ofxEditorFont::getNumDrawCalls() {
+	return numDrawCalls;
+}
+
+//--------------------------------------------------------------
+void ofxEditorFont::resetDrawStats() {
+	numVertices = 0;
+	numDrawCalls = 0;
+}
+
+// ATLAS PAGES
+
+//--------------------------------------------------------------
+void ofxEditorFont::setMaxPages(int maxPages) {
+	this->maxPages = MAX(maxPages, 1);
+}
+
+//--------------------------------------------------------------
+int ofxEditorFont::getMaxPages() {
+	return maxPages;
+}
+
+//--------------------------------------------------------------
+int ofxEditorFont::getNumPages() {
+	return pages.size();
+}
+
+//--------------------------------------------------------------
+unsigned int ofxEditorFont::getNumEvictions() {
+	return numEvictions;
+}
+
+//--------------------------------------------------------------
+size_t ofxEditorFont::getMemoryUsage() {
+	size_t bytes = 0;
+	for(auto &page : pages) {
+		FONScontext *context = page.context;
+		bytes += sizeof(FONScontext) + context->nscratch;
+		bytes += context->params.width * context->params.height; // atlas texData
+		bytes += context->atlas->cnodes * sizeof(FONSatlasNode);
+		bytes += context->cfonts * sizeof(FONSfont*);
+		for(int i = 0; i < context->nfonts; ++i) {
+			FONSfont *f = context->fonts[i];
+			bytes += sizeof(FONSfont) + f->cglyphs * sizeof(FONSglyph);
+			if(f->freeData) { // data is owned by the first page & shared
+				bytes += f->dataSize;
+			}
+		}
+		bytes += page.codepoints.capacity() * sizeof(unsigned int);
+		for(auto *batch : {&page.shadow, &page.text}) {
+			bytes += (batch->verts.capacity() + batch->tcoords.capacity()) * sizeof(float);
+			bytes += batch->colors.capacity() * sizeof(unsigned int);
+		}
+	}
+	
+	// hash map nodes (key, value, & next pointer) plus bucket array
+	bytes += glyphPages.size() * (sizeof(std::pair<unsigned int, GlyphLocation>) + sizeof(void*));
+	bytes += glyphPages.bucket_count() * sizeof(void*);
+	bytes += metrics.size() * (sizeof(std::pair<unsigned int, Metrics>) + sizeof(void*));
+	bytes += metrics.bucket_count() * sizeof(void*);
+	return bytes;
+}
+
+// FALLBACK FONTS
+
+//--------------------------------------------------------------
+void ofxEditorFont::addFallbackFont(const std::string &filename) {
+	Fallback fallback;
+	fallback.filename = filename;
+	fallback.font = FONS_INVALID;
+	fallback.failed = false;
+	fallbacks.push_back(fallback);
+}
+
+//--------------------------------------------------------------
+void ofxEditorFont::clearFallbackFonts() {
+	if(!pages.empty()) {
+		ofLogWarning("ofxEditorFont") << "fallback fonts cleared, takes effect on the next load";
+	}
+	fallbacks.clear();
+}
+
+//--------------------------------------------------------------
+int ofxEditorFont::getNumLoadedFallbackFonts() {
+	int count = 0;
+	for(auto &fallback : fallbacks) {
+		if(fallback.font != FONS_INVALID) {
+			count++;
+		}
+	}
+	return count;
+}
+
+// SIGNED DISTANCE FIELD
+
+//--------------------------------------------------------------
+void ofxEditorFont::setSignedDistanceField(bool sdf) {
+	sdfRequested = sdf;
+}
+
+//--------------------------------------------------------------
+bool ofxEditorFont::getSignedDistanceField() {
+	return sdf;
+}
+
+// PRE-WARMING & ATLAS CACHE
+
+//--------------------------------------------------------------
+void ofxEditorFont::addPrewarmRange(unsigned int first, unsigned int last) {
+	if(first > last) {
+		std::swap(first, last);
+	}
+	prewarmRanges.push_back(std::make_pair(first, MIN(last, (unsigned int)CODEPOINT_MAX)));
+}
+
+//--------------------------------------------------------------
+void ofxEditorFont::clearPrewarmRanges() {
+	prewarmRanges.clear();
+}
+
+//--------------------------------------------------------------
+void ofxEditorFont::setCacheDirectory(const std::string &dir) {
+	cacheDir = dir;
+}
+
+//--------------------------------------------------------------
+std::string ofxEditorFont::getCacheDirectory() {
+	return cacheDir;
+}
+
+//--------------------------------------------------------------
+bool ofxEditorFont::saveCache() {
+	if(pages.empty() || cachePath.empty()) {
+		return false;
+	}
+	if(!cacheDirty) {
+		return true; // nothing new
+	}
+	
+	// build in memory & replace atomically so an interrupted save can't leave
+	// a partial cache behind
+	std::string data;
+	auto write = [&data](const void *bytes, size_t size) {
+		data.append((const char*)bytes, size);
+	};
+	FONScontext *first = pages[0].context;
+	ofxEditorFontCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+	header.version = CACHE_VERSION;
+	header.nodeSize = sizeof(FONSatlasNode);
+	header.glyphSize = sizeof(FONSglyph);
+	header.lutSize = FONS_HASH_LUT_SIZE;
+	header.key = cacheKey;
+	header.pageSize = pageSize;
+	header.npages = pages.size();
+	header.nfonts = first->nfonts;
+	write(&header, sizeof(header));
+	for(int i = 1; i < first->nfonts; ++i) {
+		FONSfont *f = first->fonts[i];
+		std::string filename = fallbackFilename(i);
+		uint32_t length = filename.size();
+		uint64_t hash = fnv1a(f->data, f->dataSize);
+		write(&length, sizeof(length));
+		write(filename.c_str(), length);
+		write(&hash, sizeof(hash));
+	}
+	int numGlyphs = 0;
+	for(auto &page : pages) {
+		FONScontext *context = page.context;
+		int32_t nnodes = context->atlas->nnodes;
+		write(&nnodes, sizeof(nnodes));
+		write(context->atlas->nodes, sizeof(FONSatlasNode) * nnodes);
+		for(int i = 0; i < context->nfonts; ++i) {
+			FONSfont *f = context->fonts[i];
+			int32_t nglyphs = f->nglyphs;
+			write(&nglyphs, sizeof(nglyphs));
+			write(f->glyphs, sizeof(FONSglyph) * nglyphs);
+			write(f->lut, sizeof(f->lut));
+			numGlyphs += nglyphs;
+		}
+		write(context->texData, pageSize * pageSize);
+	}
+	ofDirectory::createDirectory(ofFilePath::getEnclosingDirectory(cachePath, false), false, true);
+	std::string error;
+	if(!ofxEditorFileSaver::write(cachePath, data, error)) {
+		ofLogError("ofxEditorFont") << "couldn't write atlas cache: " << cachePath << ": " << error;
+		return false;
+	}
+	cacheDirty = false;
+	ofLogVerbose("ofxEditorFont") << "saved " << numGlyphs << " glyphs in "
+		<< pages.size() << " pages to atlas cache";
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ofxEditorFont::getCacheRestored() {
+	return cacheRestored;
 }
 
 // PRIVATE
 
+//--------------------------------------------------------------
+void ofxEditorFont::Batch::addQuad(const FONSquad &q, float offset, unsigned int color) {
+	// same triangle order as fonsDrawText
+	const float v[12] = {
+		q.x0, q.y0,  q.x1, q.y1,  q.x1, q.y0,
+		q.x0, q.y0,  q.x0, q.y1,  q.x1, q.y1
+	};
+	const float t[12] = {
+		q.s0, q.t0,  q.s1, q.t1,  q.s1, q.t0,
+		q.s0, q.t0,  q.s0, q.t1,  q.s1, q.t1
+	};
+	for(int i = 0; i < 12; ++i) {
+		verts.push_back(v[i] + offset);
+	}
+	tcoords.insert(tcoords.end(), t, t+12);
+	colors.insert(colors.end(), 6, color);
+}
+
+//--------------------------------------------------------------
+void ofxEditorFont::Batch::append(const Batch &batch) {
+	verts.insert(verts.end(), batch.verts.begin(), batch.verts.end());
+	tcoords.insert(tcoords.end(), batch.tcoords.begin(), batch.tcoords.end());
+	colors.insert(colors.end(), batch.colors.begin(), batch.colors.end());
+}
+
+//--------------------------------------------------------------
+void ofxEditorFont::Batch::clear() {
+	verts.clear();
+	tcoords.clear();
+	colors.clear();
+}
+
+//--------------------------------------------------------------
+FONScontext* ofxEditorFont::createContext() {
+	
+	// atlas textures are managed by the renderer, there is no draw callback
+	// as the quads are batched per page & drawn by the font
+	Atlas *atlas = new Atlas;
+	atlas->renderer = renderer.get();
+	atlas->handle = 0;
+	FONSparams params;
+	memset(&params, 0, sizeof(params));
+	params.width = pageSize;
+	params.height = pageSize;
+	params.flags = (unsigned char)FONS_ZERO_TOPLEFT;
+	params.renderCreate = ofxEditorFont::atlasCreate;
+	params.renderResize = ofxEditorFont::atlasResize;
+	params.renderUpdate = ofxEditorFont::atlasUpdate;
+	params.renderDraw = NULL;
+	params.renderDelete = ofxEditorFont::atlasDelete; // deletes atlas
+	params.userPtr = atlas;
+	FONScontext *context = fonsCreateInternal(&params);
+	if(!context) {
+		return NULL;
+	}
+	fonsSetErrorCallback(context, ofxEditorFont::stashError, context);
+	return context;
+}
+
+//--------------------------------------------------------------
+bool ofxEditorFont::addPage() {
+	FONScontext *context = createContext();
+	if(!context) {
+		ofLogError("ofxEditorFont") << "couldn't create atlas page";
+		return false;
+	}
+	
+	// share font data, including opened fallbacks, with the first page so
+	// font ids are the same in every page
+	FONScontext *first = pages[0].context;
+	for(int i = 0; i < first->nfonts; ++i) {
+		FONSfont *f = first->fonts[i];
+		if(fonsAddFontMem(context, f->name, f->data, f->dataSize, 0) != i) {
+			ofLogError("ofxEditorFont") << "couldn't add font to atlas page";
+			fonsDeleteInternal(context);
+			return false;
+		}
+	}
+	pages.push_back(Page());
+	pages.back().context = context;
+	pages.back().lastUsed = clock;
+	return true;
+}
+
+//--------------------------------------------------------------
+int ofxEditorFont::evictPage() {
+	int lru = 0;
+	for(int i = 1; i < (int)pages.size(); ++i) {
+		if(pages[i].lastUsed < pages[lru].lastUsed) {
+			lru = i;
+		}
+	}
+	Page &page = pages[lru];
+	
+	// pending quads reference the current page texture
+	flushPage(page, true, true);
+	
+	for(auto codepoint : page.codepoints) {
+		glyphPages.erase(codepoint);
+	}
+	page.codepoints.clear();
+	fonsResetAtlas(page.context, pageSize, pageSize);
+	numEvictions++;
+	ofLogVerbose("ofxEditorFont") << "evicted atlas page " << lru;
+	return lru;
+}
+
+//--------------------------------------------------------------
+FONSglyph* ofxEditorFont::getGlyph(unsigned int codepoint, GlyphLocation &location, bool evict) {
+	
+	// cached
+	std::unordered_map<unsigned int, GlyphLocation>::iterator iter = glyphPages.find(codepoint);
+	if(iter != glyphPages.end()) {
+		location = iter->second;
+		FONScontext *context = pages[location.page].context;
+		pages[location.page].lastUsed = clock;
+		return fons__getGlyph(context, context->fonts[location.font], codepoint, isize, 0);
+	}
+	
+	// add to the current page, then to a new or evicted page if it's full
+	int glyphFont = getMetrics(codepoint).font;
+	FONSglyph *glyph = rasterizeGlyph(currentPage, glyphFont, codepoint);
+	if(!glyph) {
+		if((int)pages.size() < maxPages && addPage()) {
+			currentPage = pages.size()-1;
+		}
+		else if(evict) {
+			currentPage = evictPage();
+		}
+		else {
+			return NULL;
+		}
+		glyph = rasterizeGlyph(currentPage, glyphFont, codepoint);
+		if(!glyph) {
+			ofLogError("ofxEditorFont") << "couldn't add glyph " << codepoint << " to atlas page";
+			return NULL;
+		}
+	}
+	location.page = currentPage;
+	location.font = glyphFont;
+	pages[currentPage].lastUsed = clock;
+	pages[currentPage].codepoints.push_back(codepoint);
+	glyphPages[codepoint] = location;
+	cacheDirty = true;
+	return glyph;
+}
+
+//--------------------------------------------------------------
+FONSglyph* ofxEditorFont::rasterizeGlyph(int page, int font, unsigned int codepoint) {
+	FONScontext *context = pages[page].context;
+	if(sdf) {
+		return rasterizeSignedDistanceGlyph(context, font, codepoint);
+	}
+	return fons__getGlyph(context, context->fonts[font], codepoint, isize, 0);
+}
+
+//--------------------------------------------------------------
+bool ofxEditorFont::loadFallback(Fallback &fallback) {
+	FONScontext *context = pages[0].context;
+	std::string name = ofFilePath::getFileName(fallback.filename);
+	int id = fonsAddFont(context, name.c_str(), ofToDataPath(fallback.filename).c_str());
+	if(id == FONS_INVALID) {
+		ofLogError("ofxEditorFont") << "couldn't load fallback font: " << fallback.filename;
+		fallback.failed = true;
+		return false;
+	}
+	FONSfont *f = context->fonts[id];
+	for(int i = 1; i < (int)pages.size(); ++i) {
+		if(fonsAddFontMem(pages[i].context, f->name, f->data, f->dataSize, 0) != id) {
+			ofLogError("ofxEditorFont") << "couldn't add fallback font to atlas page";
+		}
+	}
+	fallback.font = id;
+	ofLogVerbose("ofxEditorFont") << "loaded fallback font: " << fallback.filename;
+	return true;
+}
+
+//--------------------------------------------------------------
+std::string ofxEditorFont::fallbackFilename(int font) {
+	for(auto &fallback : fallbacks) {
+		if(fallback.font == font) {
+			return fallback.filename;
+		}
+	}
+	return "";
+}
+
+//--------------------------------------------------------------
+const ofxEditorFont::Metrics& ofxEditorFont::getMetrics(unsigned int codepoint) {
+	std::unordered_map<unsigned int, Metrics>::iterator iter = metrics.find(codepoint);
+	if(iter != metrics.end()) {
+		return iter->second;
+	}
+	
+	// look in the main font, then open & search fallbacks in order
+	FONScontext *context = pages[0].context;
+	int renderFont = font;
+	int g = fons__tt_getGlyphIndex(&context->fonts[font]->font, codepoint);
+	for(int i = 0; g == 0 && i < (int)fallbacks.size(); ++i) {
+		Fallback &fallback = fallbacks[i];
+		if(fallback.failed || (fallback.font == FONS_INVALID && !loadFallback(fallback))) {
+			continue;
+		}
+		int fallbackIndex = fons__tt_getGlyphIndex(&context->fonts[fallback.font]->font, codepoint);
+		if(fallbackIndex != 0) {
+			g = fallbackIndex;
+			renderFont = fallback.font;
+		}
+	}
+	
+	// same advance as fons__getGlyph
+	FONSfont *f = context->fonts[renderFont];
+	int advance, lsb;
+	stbtt_GetGlyphHMetrics(&f->font.font, g, &advance, &lsb);
+	Metrics &m = metrics[codepoint];
+	m.font = renderFont;
+	m.index = g;
+	m.xadv = (short)(fons__tt_getPixelHeightScale(&f->font, size) * advance * 10.0f);
+	return m;
+}
+
+//--------------------------------------------------------------
+float ofxEditorFont::measure(const char *s) {
+	
+	float x = 0;
+	int prevGlyphIndex = -1, prevFont = font;
+	unsigned int utf8state = 0, codepoint = 0;
+	for(; *s; ++s) {
+		if(fons__decutf8(&utf8state, &codepoint, *(const unsigned char*)s)) {
+			continue;
+		}
+		measureCodepoint(codepoint, x, prevGlyphIndex, prevFont);
+	}
+	return x;
+}
+
+//--------------------------------------------------------------
+float ofxEditorFont::measure(const char32_t *s, size_t len) {
+	float x = 0;
+	int prevGlyphIndex = -1, prevFont = font;
+	for(size_t i = 0; i < len; ++i) {
+		measureCodepoint(s[i], x, prevGlyphIndex, prevFont);
+	}
+	return x;
+}
+
+//--------------------------------------------------------------
+void ofxEditorFont::measureCodepoint(unsigned int codepoint, float &x, int &prevGlyphIndex, int &prevFont) {
+
+	// same advance as fonsTextBounds using fons__getQuad rounding,
+	// kerning only applies between glyphs from the same font
+	const Metrics &m = getMetrics(codepoint);
+	if(prevGlyphIndex != -1 && m.font == prevFont) {
+		FONScontext *context = pages[0].context;
+		float adv = fons__tt_getGlyphKernAdvance(&context->fonts[m.font]->font, prevGlyphIndex, m.index) * scale;
+		x += (int)(adv + 0.5f);
+	}
+	x += (int)(m.xadv / 10.0f + 0.5f);
+	prevGlyphIndex = m.index;
+	prevFont = m.font;
+}
+
+//--------------------------------------------------------------
+void ofxEditorFont::addGlyph(unsigned int codepoint, float &x, float &y, int &prevGlyphIndex, int &prevFont, bool shadowed) {
+	GlyphLocation location;
+	FONSglyph *glyph = getGlyph(codepoint, location);
+	if(glyph) {
+		Page &p = pages[location.page];
+		if(location.font != prevFont) {
+			prevGlyphIndex = -1; // no kerning between fonts
+		}
+		FONSquad q;
+		fons__getQuad(p.context, p.context->fonts[location.font], prevGlyphIndex, glyph, scale, 0, &x, &y, &q);
+		prevFont = location.font;
+		if(shadowed) {
+			p.shadow.addQuad(q, SHADOW_OFFSET, textShadowColor);
+		}
+		p.text.addQuad(q, 0, color);
+	}
+	prevGlyphIndex = glyph ? glyph->index : -1;
+}
+
+//--------------------------------------------------------------
+float ofxEditorFont::addText(const char *s, float x, float y, bool shadowed) {
+	int prevGlyphIndex = -1, prevFont = font;
+	unsigned int utf8state = 0, codepoint = 0;
+	for(; *s; ++s) {
+		if(fons__decutf8(&utf8state, &codepoint, *(const unsigned char*)s)) {
+			continue;
+		}
+		addGlyph(codepoint, x, y, prevGlyphIndex, prevFont, shadowed);
+	}
+	return x;
+}
+
+//--------------------------------------------------------------
+float ofxEditorFont::addText(const char32_t *s, size_t len, float x, float y, bool shadowed) {
+	int prevGlyphIndex = -1, prevFont = font;
+	for(size_t i = 0; i < len; ++i) {
+		addGlyph(s[i], x, y, prevGlyphIndex, prevFont, shadowed);
+	}
+	return x;
+}
+
+//--------------------------------------------------------------
+void ofxEditorFont::flush() {
+	if(singlePassShadow) {
+		for(auto &page : pages) {
+			flushPage(page, true, true);
+		}
+	}
+	else {
+		// all shadows first, then all text
+		for(auto &page : pages) {
+			flushPage(page, true, false);
+		}
+		for(auto &page : pages) {
+			flushPage(page, false, true);
+		}
+	}
+	clock++;
+}
+
+//--------------------------------------------------------------
+void ofxEditorFont::flushPage(Page &page, bool shadow, bool text) {
+	shadow = shadow && page.shadow.size() > 0;
+	text = text && page.text.size() > 0;
+	if(!shadow && !text) {
+		return;
+	}
+	uploadAtlas(page);
+	int atlas = ((Atlas*)page.context->params.userPtr)->handle;
+	if(shadow && text && singlePassShadow) {
+		// shadow quads first, then the text quads on top in one call
+		page.shadow.append(page.text);
+		drawBatch(atlas, page.shadow.verts.data(), page.shadow.tcoords.data(),
+		          page.shadow.colors.data(), page.shadow.size());
+		page.shadow.clear();
+		page.text.clear();
+		return;
+	}
+	if(shadow) {
+		drawBatch(atlas, page.shadow.verts.data(), page.shadow.tcoords.data(),
+		          page.shadow.colors.data(), page.shadow.size());
+		page.shadow.clear();
+	}
+	if(text) {
+		drawBatch(atlas, page.text.verts.data(), page.text.tcoords.data(),
+		          page.text.colors.data(), page.text.size());
+		page.text.clear();
+	}
+}
+
+//--------------------------------------------------------------
+void ofxEditorFont::prewarm() {
+	int count = glyphPages.size();
+	for(auto &range : prewarmRanges) {
+		for(unsigned int c = range.first; c <= range.second; ++c) {
+		
+			// skip codepoints the font doesn't have instead of caching empty glyphs
+			if(getMetrics(c).index == 0) {
+				continue;
+			}
+		
+			// don't evict glyphs which were just pre-warmed
+			GlyphLocation location;
+			if(!getGlyph(c, location, false)) {
+				ofLogWarning("ofxEditorFont") << "atlas pages full, stopped pre-warming at codepoint " << c;
+				return;
+			}
+		}
+	}
+	ofLogVerbose("ofxEditorFont") << "pre-warmed " << glyphPages.size() - count << " glyphs";
+}
+
+//--------------------------------------------------------------
+void ofxEditorFont::uploadAtlas(Page &page) {
+	int dirty[4];
+	FONScontext *context = page.context;
+	if(fonsValidateTexture(context, dirty) && context->params.renderUpdate) {
+		context->params.renderUpdate(context->params.userPtr, dirty, context->texData);
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxEditorFont::loadCache() {
+	if(!ofFile::doesFileExist(cachePath, false)) {
+		return false;
+	}
+	ofFile file(cachePath, ofFile::ReadOnly, true);
+	ofxEditorFontCacheHeader header;
+	file.read((char*)&header, sizeof(header));
+	if(!file.good() || memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+	   header.version != CACHE_VERSION || header.key != cacheKey ||
+	   header.nodeSize != sizeof(FONSatlasNode) || header.glyphSize != sizeof(FONSglyph) ||
+	   header.lutSize != FONS_HASH_LUT_SIZE || header.pageSize != pageSize ||
+	   header.npages <= 0 || header.npages > maxPages ||
+	   header.nfonts <= 0 || header.nfonts > (int)fallbacks.size()+1) {
+		ofLogWarning("ofxEditorFont") << "ignoring atlas cache for different settings: " << cachePath;
+		return false;
+	}
+	
+	// cached glyphs from fallbacks need the same fallbacks opened in the same order
+	for(int i = 1; i < header.nfonts; ++i) {
+		uint32_t length = 0;
+		uint64_t hash = 0;
+		file.read((char*)&length, sizeof(length));
+		if(!file.good() || length > 4096) {
+			ofLogWarning("ofxEditorFont") << "ignoring invalid atlas cache: " << cachePath;
+			return false;
+		}
+		std::string filename(length, '\0');
+		file.read(&filename[0], length);
+		file.read((char*)&hash, sizeof(hash));
+		Fallback *fallback = NULL;
+		for(auto &f : fallbacks) {
+			if(f.filename == filename) {
+				fallback = &f;
+				break;
+			}
+		}
+		if(!file.good() || !fallback ||
+		   (fallback->font == FONS_INVALID && !loadFallback(*fallback)) || fallback->font != i) {
+			ofLogWarning("ofxEditorFont") << "ignoring atlas cache for different fallback fonts: " << cachePath;
+			return false;
+		}
+		FONSfont *f = pages[0].context->fonts[i];
+		if(fnv1a(f->data, f->dataSize) != hash) {
+			ofLogWarning("ofxEditorFont") << "ignoring atlas cache for changed fallback font: " << filename;
+			return false;
+		}
+	}
+	
+	// read everything before touching the pages in case the file is truncated
+	struct CachedFont {
+		std::vector<FONSglyph> glyphs;
+		int lut[FONS_HASH_LUT_SIZE];
+	};
+	struct CachedPage {
+		std::vector<FONSatlasNode> nodes;
+		std::vector<CachedFont> fonts;
+		std::vector<unsigned char> texData;
+	};
+	std::vector<CachedPage> cached(header.npages);
+	for(auto &page : cached) {
+		int32_t nnodes = 0;
+		file.read((char*)&nnodes, sizeof(nnodes));
+		if(!file.good() || nnodes <= 0 || nnodes > pageSize) {
+			ofLogWarning("ofxEditorFont") << "ignoring invalid atlas cache: " << cachePath;
+			return false;
+		}
+		page.nodes.resize(nnodes);
+		file.read((char*)page.nodes.data(), sizeof(FONSatlasNode) * page.nodes.size());
+		if(!file.good() || !validCachedNodes(page.nodes, pageSize)) {
+			ofLogWarning("ofxEditorFont") << "ignoring invalid atlas cache: " << cachePath;
+			return false;
+		}
+		page.fonts.resize(header.nfonts);
+		for(auto &f : page.fonts) {
+			int32_t nglyphs = -1;
+			file.read((char*)&nglyphs, sizeof(nglyphs));
+			if(!file.good() || nglyphs < 0 || nglyphs > pageSize * pageSize) {
+				ofLogWarning("ofxEditorFont") << "ignoring invalid atlas cache: " << cachePath;
+				return false;
+			}
+			f.glyphs.resize(nglyphs);
+			file.read((char*)f.glyphs.data(), sizeof(FONSglyph) * f.glyphs.size());
+			file.read((char*)f.lut, sizeof(f.lut));
+			if(!file.good() || !validCachedGlyphs(f.glyphs, f.lut, pageSize)) {
+				ofLogWarning("ofxEditorFont") << "ignoring invalid atlas cache: " << cachePath;
+				return false;
+			}
+		}
+		page.texData.resize(pageSize * pageSize);
+		file.read((char*)page.texData.data(), page.texData.size());
+	}
+	if(!file.good()) {
+		ofLogWarning("ofxEditorFont") << "ignoring truncated atlas cache: " << cachePath;
+		return false;
+	}
+	
+	// replace atlas & glyph tables of each page
+	int numGlyphs = 0;
+	for(int i = 0; i < (int)cached.size(); ++i) {
+		if(i >= (int)pages.size() && !addPage()) {
+			return false;
+		}
+		CachedPage &c = cached[i];
+		FONScontext *context = pages[i].context;
+		FONSatlas *atlas = context->atlas;
+		if(atlas->cnodes < (int)c.nodes.size()) {
+			atlas->nodes = (FONSatlasNode*)realloc(atlas->nodes, sizeof(FONSatlasNode) * c.nodes.size());
+			atlas->cnodes = c.nodes.size();
+		}
+		memcpy(atlas->nodes, c.nodes.data(), sizeof(FONSatlasNode) * c.nodes.size());
+		atlas->nnodes = c.nodes.size();
+		pages[i].codepoints.clear();
+		for(int j = 0; j < (int)c.fonts.size(); ++j) {
+			CachedFont &cf = c.fonts[j];
+			FONSfont *f = context->fonts[j];
+			if(f->cglyphs < (int)cf.glyphs.size()) {
+				f->glyphs = (FONSglyph*)realloc(f->glyphs, sizeof(FONSglyph) * cf.glyphs.size());
+				f->cglyphs = cf.glyphs.size();
+			}
+			if(!cf.glyphs.empty()) {
+				memcpy(f->glyphs, cf.glyphs.data(), sizeof(FONSglyph) * cf.glyphs.size());
+			}
+			f->nglyphs = cf.glyphs.size();
+			memcpy(f->lut, cf.lut, sizeof(cf.lut));
+			
+			// rebuild codepoint -> location lookup
+			for(auto &glyph : cf.glyphs) {
+				GlyphLocation location = {i, j};
+				pages[i].codepoints.push_back(glyph.codepoint);
+				glyphPages[glyph.codepoint] = location;
+			}
+			numGlyphs += f->nglyphs;
+		}
+		memcpy(context->texData, c.texData.data(), c.texData.size());
+		context->dirtyRect[0] = 0;
+		context->dirtyRect[1] = 0;
+		context->dirtyRect[2] = pageSize;
+		context->dirtyRect[3] = pageSize;
+	}
+	currentPage = pages.size()-1;
+	
+	ofLogVerbose("ofxEditorFont") << "restored " << numGlyphs << " glyphs in "
+		<< pages.size() << " pages from atlas cache";
+	return true;
+}
+
+//--------------------------------------------------------------
+FONSglyph* ofxEditorFont::rasterizeSignedDistanceGlyph(FONScontext *context, int font, unsigned int codepoint) {
+	FONSfont *f = context->fonts[font];
+	int g = fons__tt_getGlyphIndex(&f->font, codepoint);
+	stbtt_fontinfo *info = &f->font.font;
+	float glyphScale = fons__tt_getPixelHeightScale(&f->font, isize/10.0f);
+	int advance, lsb;
+	stbtt_GetGlyphHMetrics(info, g, &advance, &lsb);
+	
+	// the SDF bitmap & glyph outline are allocated from the fontstash scratch
+	// buffer, leave very large glyphs to the regular bitmap rasterizer
+	int x0, y0, x1, y1;
+	stbtt_GetGlyphBitmapBox(info, g, glyphScale, glyphScale, &x0, &y0, &x1, &y1);
+	if((x1-x0+SDF_PADDING*2) * (y1-y0+SDF_PADDING*2) > FONS_SCRATCH_BUF_SIZE/2) {
+		return fons__getGlyph(context, f, codepoint, isize, 0);
+	}
+	
+	// empty glyphs (ie. space) return NULL & are stored as 0 size
+	context->nscratch = 0;
+	int w = 0, h = 0, xoff = 0, yoff = 0;
+	unsigned char *data = stbtt_GetGlyphSDF(info, glyphScale, g,
+		SDF_PADDING, SDF_ONEDGE, SDF_DIST_SCALE, &w, &h, &xoff, &yoff);
+	if(!data) {
+		w = h = 0;
+	}
+	
+	// 1 pixel empty border, matches the inset in fons__getQuad
+	int gw = w+2, gh = h+2, gx, gy;
+	if(fons__atlasAddRect(context->atlas, gw, gh, &gx, &gy) == 0) {
+		return NULL; // page full
+	}
+	FONSglyph *glyph = fons__allocGlyph(f);
+	if(!glyph) {
+		return NULL;
+	}
+	glyph->codepoint = codepoint;
+	glyph->size = isize;
+	glyph->blur = 0;
+	glyph->index = g;
+	glyph->x0 = (short)gx;
+	glyph->y0 = (short)gy;
+	glyph->x1 = (short)(gx+gw);
+	glyph->y1 = (short)(gy+gh);
+	glyph->xadv = (short)(glyphScale * advance * 10.0f);
+	glyph->xoff = (short)(xoff-1);
+	glyph->yoff = (short)(yoff-1);
+	
+	// insert into hash lookup so fontstash finds it
+	unsigned int hash = fons__hashint(codepoint) & (FONS_HASH_LUT_SIZE-1);
+	glyph->next = f->lut[hash];
+	f->lut[hash] = f->nglyphs-1;
+	
+	// copy into atlas with empty border
+	int stride = context->params.width;
+	unsigned char *dst = &context->texData[gx + gy * stride];
+	for(int y = 0; y < gh; ++y) {
+		memset(dst + y * stride, 0, gw);
+	}
+	for(int y = 0; y < h; ++y) {
+		memcpy(dst + (y+1) * stride + 1, data + y * w, w);
+	}
+	
+	context->dirtyRect[0] = fons__mini(context->dirtyRect[0], glyph->x0);
+	context->dirtyRect[1] = fons__mini(context->dirtyRect[1], glyph->y0);
+	context->dirtyRect[2] = fons__maxi(context->dirtyRect[2], glyph->x1);
+	context->dirtyRect[3] = fons__maxi(context->dirtyRect[3], glyph->y1);
+	
+	return glyph;
+}
+
+//--------------------------------------------------------------
+void ofxEditorFont::drawBatch(int atlas, const float* verts, const float* tcoords, const unsigned int* colors, int nverts) {
+	renderer->drawGlyphs(atlas, verts, tcoords, colors, nverts, sdf);
+	numVertices += nverts;
+	numDrawCalls++;
+}
+
+//--------------------------------------------------------------
+int ofxEditorFont::atlasCreate(void* uptr, int width, int height) {
+	Atlas *atlas = (Atlas*)uptr;
+	if(atlas->handle) {
+		atlas->renderer->deleteAtlas(atlas->handle);
+	}
+	atlas->handle = atlas->renderer->createAtlas(width, height);
+	atlas->width = width;
+	atlas->height = height;
+	return atlas->handle != 0;
+}
+
+//--------------------------------------------------------------
+int ofxEditorFont::atlasResize(void* uptr, int width, int height) {
+	return atlasCreate(uptr, width, height);
+}
+
+//--------------------------------------------------------------
+void ofxEditorFont::atlasUpdate(void* uptr, int* rect, const unsigned char* data) {
+	Atlas *atlas = (Atlas*)uptr;
+	atlas->renderer->updateAtlas(atlas->handle, rect, data, atlas->width);
+}
+
+//--------------------------------------------------------------
+void ofxEditorFont::atlasDelete(void* uptr) {
+	Atlas *atlas = (Atlas*)uptr;
+	if(atlas->handle) {
+		atlas->renderer->deleteAtlas(atlas->handle);
+	}
+	delete atlas;
+}
+
 //--------------------------------------------------------------
 void ofxEditorFont::stashError(void* uptr, int error, int val) {
 	(void)uptr;
-	FONScontext* context = (FONScontext*)uptr;
 	switch(error) {
-		case FONS_ATLAS_FULL: {
-			ofLogWarning("ofxEditorFont") << "font atlas texture full, expanding";
-			int width, height;
-			fonsGetAtlasSize(context, &width, &height);
-			if(width <= ATLAS_MAX_SIZE && height <= ATLAS_MAX_SIZE) {
-				fonsExpandAtlas(context, width*2, height*2);
-			}
-			else {
-				ofLogError("ofxEditorFont") << "couldn't expand atlas more than " << ATLAS_MAX_SIZE;
-			}
+		case FONS_ATLAS_FULL:
+			// handled by adding or evicting atlas pages
 			break;
-		}
 		case FONS_SCRATCH_FULL:
 			ofLogError("ofxEditorFont") << "scratch full, tried to allocate " << val << " has " << FONS_SCRATCH_BUF_SIZE;
 			break;
@@ -202,3 +1289,50 @@ void ofxEditorFont::stashError(void* uptr, int error, int val) {
 			break;
 	}
 }
+
+// STATIC UTILS
+
+//--------------------------------------------------------------
+uint64_t fnv1a(const void *data, size_t size, uint64_t hash) {
+	const unsigned char *bytes = (const unsigned char*)data;
+	for(size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+//--------------------------------------------------------------
+unsigned int rgba(unsigned char r, unsigned char g, unsigned char b, unsigned char a) {
+	return (r) | (g << 8) | (b << 16) | (a << 24);
+}
+
+//--------------------------------------------------------------
+bool validCachedNodes(const std::vector<FONSatlasNode> &nodes, int pageSize) {
+	for(auto &node : nodes) {
+		if(node.x < 0 || node.y < 0 || node.width < 0 ||
+		   node.x + node.width > pageSize || node.y > pageSize) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+bool validCachedGlyphs(const std::vector<FONSglyph> &glyphs,
+                       const int lut[FONS_HASH_LUT_SIZE], int pageSize) {
+	int nglyphs = glyphs.size();
+	for(int i = 0; i < FONS_HASH_LUT_SIZE; ++i) {
+		if(lut[i] < -1 || lut[i] >= nglyphs) {
+			return false;
+		}
+	}
+	for(auto &glyph : glyphs) {
+		if(glyph.next < -1 || glyph.next >= nglyphs ||
+		   glyph.x0 < 0 || glyph.y0 < 0 || glyph.x0 > glyph.x1 || glyph.y0 > glyph.y1 ||
+		   glyph.x1 > pageSize || glyph.y1 > pageSize) {
+			return false;
+		}
+	}
+	return true;
+}
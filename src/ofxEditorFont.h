@@ -21,14 +21,23 @@
 
 #include "ofConstants.h"
 #include "ofColor.h"
+#include "ofxEditorRenderer.h"
 #include "fontstash.h"
 
+#include <memory>
+#include <unordered_map>
+
 /// fontstash library wrapper for efficient text rendering since ofTrueTypeFont
 /// is too slow for lots of chars, this may change in the future as the new
 /// ofFont & unicode support are integrated into OpenFrameworks
 ///
 /// supports UTF8 but is dependent on what glyphs the loaded font supports,
-/// unknown glyphs are simply rendered as spaces
+/// glyphs missing from the font are looked up in an optional list of fallback
+/// fonts, unknown glyphs are simply rendered as spaces
+///
+/// glyphs are cached in a number of fixed size atlas pages (textures), when
+/// all pages are full the least recently used page is cleared & reused so
+/// memory stays bounded and new glyphs can always be rasterized
 ///
 /// note: don't use this directly, requires alpha blending to avoid per-char
 ///       style & color pushes & pops
@@ -41,16 +50,41 @@ class ofxEditorFont {
 	
 	/// \section Main
 	
-		/// create a fonstash context and load a given font
+		/// create the atlas pages and load a given font,
+		/// textureDimension is the size of each atlas page texture
 		/// returns false if the font could not be loaded
 		bool load(std::string filename, int fontsize, int textureDimension = 512);
 	
-		/// returns true if the fonstash context exists (aka font is loaded)
+		/// returns true if the font is loaded
 		bool isLoaded();
 	
-		/// clear the font & fonstash context
+		/// clear the font & atlas pages
 		void clear();
 	
+	/// \section Renderer
+	
+		/// set the renderer used to create the atlas textures & draw glyphs,
+		/// atlases are moved to the new renderer if the font is loaded
+		/// default: ofxEditorGLRenderer
+		void setRenderer(std::shared_ptr<ofxEditorRenderer> renderer);
+		std::shared_ptr<ofxEditorRenderer> getRenderer();
+	
+	/// \section Fallback Fonts
+	
+		/// add a fallback font to look up glyphs missing from the main font,
+		/// fallbacks are searched in the order they were added
+		///
+		/// fallback fonts are only opened when a codepoint is first missing
+		/// from the main font and the font which resolves each codepoint is
+		/// cached, takes effect on the next load
+		void addFallbackFont(const std::string &filename);
+	
+		/// clear the fallback font list
+		void clearFallbackFonts();
+	
+		/// get the number of fallback fonts which have been opened
+		int getNumLoadedFallbackFonts();
+	
 	/// \section Font Info
 	
 		/// get the currently loaded font size
@@ -66,8 +100,12 @@ class ofxEditorFont {
 		float stringWidth(const std::string& s);
 		float stringWidth(const std::u32string& s);
 	
+		/// get bounding box width for a range of wide chars without copying,
+		/// ie. part of a line
+		float stringWidth(const char32_t *s, size_t len);
+	
 		/// get bounding box height for a given string (single line only)
-        float stringHeight(const std::string& s);
+		float stringHeight(const std::string& s);
 		float stringHeight(const std::u32string& s);
 	
 	/// \section Drawing
@@ -87,6 +125,15 @@ class ofxEditorFont {
 		/// returns new x position
 		float drawString(const std::u32string& s, float x, float y, bool shadowed=false);
 	
+		/// begin batching, glyph quads are collected per atlas page and drawn
+		/// with one draw call per page on endBatch() instead of per string
+		///
+		/// text is drawn on top of anything drawn in between, calls can be nested
+		void beginBatch();
+	
+		/// draw the collected glyph quads & end batching
+		void endBatch();
+	
 	/// \section Color & State
 	
 		/// set current state color, default: white
@@ -101,14 +148,283 @@ class ofxEditorFont {
 		// pop current font state (color)
 		void popState();
 	
+	/// \section Shadow & Draw Stats
+	
+		/// enable/disable drawing the offset shadow in the same batch as the
+		/// text by reusing the text vertices with a translation, default: true
+		///
+		/// false draws the shadow as a separate pass which requires an extra
+		/// draw call per atlas page
+		void setSinglePassShadow(bool singlePass=true);
+	
+		/// is the offset shadow drawn in the same batch as the text?
+		bool getSinglePassShadow();
+	
+		/// get the number of vertices drawn since the last reset
+		unsigned int getNumVertices();
+	
+		/// get the number of draw calls since the last reset
+		unsigned int getNumDrawCalls();
+	
+		/// reset the vertex & draw call counters,
+		/// call this at the beginning of a frame to measure per-frame counts
+		void resetDrawStats();
+	
+	/// \section Atlas Pages
+	
+		/// set the maximum number of atlas pages, takes effect on the next load
+		/// default: 8
+		///
+		/// memory use is bounded by maxPages * textureDimension^2 bytes
+		void setMaxPages(int maxPages);
+	
+		/// get the maximum number of atlas pages
+		int getMaxPages();
+	
+		/// get the number of allocated atlas pages
+		int getNumPages();
+	
+		/// get the number of times a page was cleared to make room for new
+		/// glyphs since loading, a steadily increasing count means maxPages
+		/// or textureDimension is too small for the text being drawn
+		unsigned int getNumEvictions();
+	
+		/// get the approximate heap memory used in bytes: the CPU copies of
+		/// the atlas pages, glyph tables, batches, & loaded font data,
+		/// the atlas textures use about the same amount of GPU memory
+		size_t getMemoryUsage();
+	
+	/// \section Signed Distance Field
+	
+		/// enable/disable rasterizing glyphs as a signed distance field (SDF)
+		/// instead of a coverage bitmap, takes effect on the next load
+		/// default: false
+		///
+		/// SDF glyphs are drawn with a small smoothstep shader which keeps edges
+		/// sharp when the text is scaled up or down, so a single atlas serves all
+		/// zoom levels instead of loading the font at several sizes
+		///
+		/// note: falls back to bitmap glyphs if the renderer doesn't support
+		///       SDF glyphs, ie. the GL renderer requires GLSL 1.20
+		void setSignedDistanceField(bool sdf=true);
+	
+		/// are glyphs rasterized as a signed distance field?
+		/// returns false if SDF mode was requested but is not available
+		bool getSignedDistanceField();
+	
+	/// \section Pre-warming & Atlas Cache
+	
+		/// add a range of unicode codepoints (inclusive) to rasterize into the
+		/// atlas when the font is loaded, avoids rasterizing & uploading glyphs
+		/// the first time they are drawn, takes effect on the next load
+		///
+		/// codepoints not found in the font are skipped, pre-warming stops
+		/// with a warning when all atlas pages are full
+		void addPrewarmRange(unsigned int first, unsigned int last);
+	
+		/// clear the pre-warm codepoint ranges
+		void clearPrewarmRanges();
+	
+		/// set the directory for the on-disk atlas cache, relative to the
+		/// data path, takes effect on the next load, "" disables (default)
+		///
+		/// the rasterized atlas pages & glyph tables are restored from a cache
+		/// file keyed by a hash of the font file data, font size, & glyph type so
+		/// a relaunch skips rasterization entirely, the cache is written after
+		/// pre-warming and by saveCache()
+		void setCacheDirectory(const std::string &dir);
+	
+		/// get the on-disk atlas cache directory, "" if disabled
+		std::string getCacheDirectory();
+	
+		/// save the current atlas pages & glyph tables to the cache if glyphs
+		/// have been added since it was restored or last saved, call this on
+		/// exit to keep glyphs rasterized while running
+		/// returns false on error or if the cache is disabled
+		bool saveCache();
+	
+		/// was the atlas restored from the cache on the last load?
+		bool getCacheRestored();
+	
 	private:
 	
-		struct FONScontext *context; //< fontstash context
+		/// glyph quad vertices, reused between draws to avoid allocations
+		struct Batch {
+			std::vector<float> verts;
+			std::vector<float> tcoords;
+			std::vector<unsigned int> colors;
+			
+			/// add a glyph quad as 2 triangles with an offset & color
+			void addQuad(const struct FONSquad &q, float offset, unsigned int color);
+			
+			/// append another batch
+			void append(const Batch &batch);
+			
+			/// number of vertices
+			int size() const {return (int)colors.size();}
+			
+			/// clear vertices, keeps allocated memory
+			void clear();
+		};
+	
+		/// atlas texture handle, the fontstash renderer user pointer
+		struct Atlas {
+			ofxEditorRenderer *renderer; //< renderer which owns the texture
+			int handle; //< renderer atlas handle, 0 if none
+			int width;  //< texture width, also the atlas data row length
+			int height; //< texture height
+		};
+	
+		/// fixed size atlas page with its own texture & glyph cache
+		struct Page {
+			struct FONScontext *context; //< fontstash context for this page
+			unsigned int lastUsed; //< clock value when a glyph was last used
+			std::vector<unsigned int> codepoints; //< codepoints cached in this page
+			Batch shadow; //< pending shadow quads
+			Batch text;   //< pending text quads
+		};
+	
+		/// location of a rasterized glyph
+		struct GlyphLocation {
+			int page; //< atlas page index
+			int font; //< fontstash font id
+		};
+	
+		std::vector<Page> pages; //< atlas pages, first page owns the font data
+		std::unordered_map<unsigned int, GlyphLocation> glyphPages; //< codepoint -> location
+		int currentPage;   //< page new glyphs are added to
+		int pageSize;      //< atlas page texture dimension
+		int maxPages;      //< max number of atlas pages
+		unsigned int clock; //< LRU clock, incremented per flush
+		unsigned int numEvictions; //< pages cleared since load
+		int batchDepth;    //< beginBatch nesting depth
+	
+		/// cached glyph metrics for layout without rasterizing
+		struct Metrics {
+			int font;    //< font id which resolves the codepoint
+			int index;   //< glyph index
+			short xadv;  //< advance * 10, same as FONSglyph
+		};
+		std::unordered_map<unsigned int, Metrics> metrics; //< codepoint -> metrics
+	
+		/// fallback font, opened on first use
+		struct Fallback {
+			std::string filename; //< font file path
+			int font;    //< fontstash font id, FONS_INVALID if not opened
+			bool failed; //< couldn't be opened?
+		};
+		std::vector<Fallback> fallbacks; //< fallback fonts in lookup order
+	
 		int font;         //< loaded font id
 		int size;         //< requested font size
+		short isize;      //< font size * 10 as used by fontstash
+		float scale;      //< font pixel height scale
 		float lineHeight; //< computed line height
 		
+		unsigned int color; //< current text color
+		std::vector<unsigned int> colorStack; //< pushed text colors
 		unsigned int textShadowColor; //< cached text shadow color
+		bool singlePassShadow; //< draw shadow in the same batch as the text?
+	
+		unsigned int numVertices;  //< vertices drawn since last reset
+		unsigned int numDrawCalls; //< draw calls since last reset
+	
+		bool sdfRequested; //< rasterize SDF glyphs on next load?
+		bool sdf;          //< are glyphs currently rasterized as SDF?
+	
+		std::shared_ptr<ofxEditorRenderer> renderer; //< atlas & glyph renderer
+	
+		/// codepoint ranges to rasterize on load
+		std::vector<std::pair<unsigned int, unsigned int>> prewarmRanges;
+	
+		std::string cacheDir;  //< atlas cache directory, "" when disabled
+		std::string cachePath; //< cache file path for the loaded font
+		uint64_t cacheKey;     //< font data, size, & glyph type hash
+		bool cacheRestored;    //< was the atlas restored from the cache?
+		bool cacheDirty;       //< glyphs added since last restored or saved?
+	
+		/// create a fontstash context for a page, returns NULL on failure
+		struct FONScontext* createContext();
+	
+		/// add a new atlas page sharing the font data of the first page,
+		/// returns false on failure
+		bool addPage();
+	
+		/// clear the least recently used page for reuse, pending quads using
+		/// the page are drawn first, returns the page index
+		int evictPage();
+	
+		/// get the glyph for a codepoint, rasterizing it into the current page
+		/// if needed, adds a page or evicts the least recently used page when
+		/// the current page is full unless evict=false
+		/// sets the page index & font id, returns NULL if the glyph could not
+		/// be added
+		struct FONSglyph* getGlyph(unsigned int codepoint, GlyphLocation &location, bool evict=true);
+	
+		/// rasterize a glyph from a font into a page,
+		/// returns NULL if the page is full
+		struct FONSglyph* rasterizeGlyph(int page, int font, unsigned int codepoint);
+	
+		/// open a fallback font & add it to all pages, returns false on failure
+		bool loadFallback(Fallback &fallback);
+	
+		/// get the filename of an opened fallback font by font id
+		std::string fallbackFilename(int font);
+	
+		/// get cached layout metrics for a codepoint, searches & opens fallback
+		/// fonts if the codepoint is missing from the main font
+		const Metrics& getMetrics(unsigned int codepoint);
+	
+		/// compute the advance of a UTF8 string without rasterizing glyphs
+		float measure(const char *s);
+	
+		/// compute the advance of a wide char range without rasterizing glyphs
+		float measure(const char32_t *s, size_t len);
+	
+		/// add the advance of a codepoint, including kerning, to x,
+		/// updates prevGlyphIndex & prevFont for kerning
+		void measureCodepoint(unsigned int codepoint, float &x, int &prevGlyphIndex, int &prevFont);
+	
+		/// add quads for a glyph to the page batches,
+		/// updates x, prevGlyphIndex, & prevFont for kerning
+		void addGlyph(unsigned int codepoint, float &x, float &y, int &prevGlyphIndex, int &prevFont, bool shadowed);
+	
+		/// add quads for a UTF8 string to the page batches, returns new x position
+		float addText(const char *s, float x, float y, bool shadowed);
+	
+		/// add quads for a wide char string to the page batches,
+		/// returns new x position
+		float addText(const char32_t *s, size_t len, float x, float y, bool shadowed);
+	
+		/// draw all pending quads
+		void flush();
+	
+		/// draw the pending quads for a page
+		void flushPage(Page &page, bool shadow, bool text);
+	
+		/// rasterize the pre-warm codepoint ranges
+		void prewarm();
+	
+		/// upload the dirty atlas region of a page to its texture
+		void uploadAtlas(Page &page);
+	
+		/// restore the atlas pages & glyph tables from the cache,
+		/// returns false if not found or invalid
+		bool loadCache();
+	
+		/// rasterize an SDF glyph into a page atlas & insert it into the fontstash
+		/// glyph lookup table, falls back to a bitmap glyph if it's too large
+		/// returns NULL if the glyph could not be added
+		struct FONSglyph* rasterizeSignedDistanceGlyph(struct FONScontext *context, int font, unsigned int codepoint);
+	
+		/// draw a vertex batch from an atlas with the renderer
+		void drawBatch(int atlas, const float* verts, const float* tcoords, const unsigned int* colors, int nverts);
+	
+		/// fontstash atlas texture callbacks, forwarded to the renderer
+		static int atlasCreate(void* uptr, int width, int height);
+		static int atlasResize(void* uptr, int width, int height);
+		static void atlasUpdate(void* uptr, int* rect, const unsigned char* data);
+		static void atlasDelete(void* uptr);
 	
 		/// static C error handler
 		static void stashError(void* uptr, int error, int val);
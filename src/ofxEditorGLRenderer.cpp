@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#include "ofxEditorGLRenderer.h"
+
+#include "ofMain.h"
+
+// SDF glyph shader, edges are smoothed over about one screen pixel using
+// the screen space derivative of the distance so they stay sharp at any scale
+static const char *sdfVertSource =
+	"#version 120\n"
+	"void main() {\n"
+	"	gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+	"	gl_FrontColor = gl_Color;\n"
+	"	gl_Position = ftransform();\n"
+	"}\n";
+static const char *sdfFragSource =
+	"#version 120\n"
+	"uniform sampler2D tex;\n"
+	"void main() {\n"
+	"	float dist = texture2D(tex, gl_TexCoord[0].st).a;\n"
+	"	float width = max(fwidth(dist)*0.7, 0.001);\n"
+	"	float alpha = smoothstep(0.5-width, 0.5+width, dist);\n"
+	"	gl_FragColor = vec4(gl_Color.rgb, gl_Color.a*alpha);\n"
+	"}\n";
+
+//--------------------------------------------------------------
+ofxEditorGLRenderer::ofxEditorGLRenderer() {
+	sdfFailed = false;
+}
+
+//--------------------------------------------------------------
+ofxEditorGLRenderer::~ofxEditorGLRenderer() {}
+
+// FRAME
+
+//--------------------------------------------------------------
+void ofxEditorGLRenderer::begin() {
+	ofPushStyle();
+	ofPushView();
+	ofEnableAlphaBlending(); // for fontstash
+}
+
+//--------------------------------------------------------------
+void ofxEditorGLRenderer::end() {
+	ofPopView();
+	ofPopStyle();
+}
+
+//--------------------------------------------------------------
+void ofxEditorGLRenderer::setViewport(int x, int y, int width, int height) {
+	ofViewport(x, y, width, height);
+}
+
+// TRANSFORM
+
+//--------------------------------------------------------------
+void ofxEditorGLRenderer::pushMatrix() {
+	ofPushMatrix();
+}
+
+//--------------------------------------------------------------
+void ofxEditorGLRenderer::popMatrix() {
+	ofPopMatrix();
+}
+
+//--------------------------------------------------------------
+void ofxEditorGLRenderer::translate(float x, float y) {
+	ofTranslate(x, y);
+}
+
+//--------------------------------------------------------------
+void ofxEditorGLRenderer::scale(float x, float y) {
+	ofScale(x, y);
+}
+
+// DRAWING
+
+//--------------------------------------------------------------
+void ofxEditorGLRenderer::drawRectangle(float x, float y, float width, float height,
+                                        const ofColor &color, bool filled) {
+	ofSetColor(color);
+	ofFillFlag fill = ofGetFill();
+	if(filled) {
+		ofFill();
+	}
+	else {
+		ofNoFill();
+	}
+	ofRectMode rectMode = ofGetRectMode();
+	ofSetRectMode(OF_RECTMODE_CORNER);
+	ofDrawRectangle(x, y, width, height);
+	ofSetRectMode(rectMode);
+	if(fill == OF_FILLED) {
+		ofFill();
+	}
+	else {
+		ofNoFill();
+	}
+}
+
+//--------------------------------------------------------------
+void ofxEditorGLRenderer::drawGlyphs(int atlas, const float *verts, const float *tcoords,
+                                     const unsigned int *colors, int nverts,
+                                     bool signedDistance) {
+	if(signedDistance) {
+		if(!supportsSignedDistanceField()) {
+			return;
+		}
+		sdfShader.begin();
+		sdfShader.setUniform1i("tex", 0);
+	}
+	
+	// same as glfontstash
+	glBindTexture(GL_TEXTURE_2D, atlas);
+	glEnable(GL_TEXTURE_2D);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	
+	glVertexPointer(2, GL_FLOAT, sizeof(float)*2, verts);
+	glTexCoordPointer(2, GL_FLOAT, sizeof(float)*2, tcoords);
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(unsigned int), colors);
+	
+	glDrawArrays(GL_TRIANGLES, 0, nverts);
+	
+	glDisable(GL_TEXTURE_2D);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	
+	if(signedDistance) {
+		sdfShader.end();
+	}
+}
+
+// GLYPH ATLASES
+
+//--------------------------------------------------------------
+int ofxEditorGLRenderer::createAtlas(int width, int height) {
+	GLuint tex = 0;
+	glGenTextures(1, &tex);
+	if(!tex) {
+		ofLogError("ofxEditorGLRenderer") << "couldn't create atlas texture";
+		return 0;
+	}
+	glBindTexture(GL_TEXTURE_2D, tex);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, width, height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	return tex;
+}
+
+//--------------------------------------------------------------
+void ofxEditorGLRenderer::updateAtlas(int atlas, const int *rect, const unsigned char *data, int stride) {
+	int w = rect[2] - rect[0];
+	int h = rect[3] - rect[1];
+	if(atlas == 0 || w <= 0 || h <= 0) {
+		return;
+	}
+	glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+	glBindTexture(GL_TEXTURE_2D, atlas);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, stride);
+	glPixelStorei(GL_UNPACK_SKIP_PIXELS, rect[0]);
+	glPixelStorei(GL_UNPACK_SKIP_ROWS, rect[1]);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, rect[0], rect[1], w, h, GL_ALPHA, GL_UNSIGNED_BYTE, data);
+	glPopClientAttrib();
+}
+
+//--------------------------------------------------------------
+void ofxEditorGLRenderer::deleteAtlas(int atlas) {
+	GLuint tex = atlas;
+	if(tex) {
+		glDeleteTextures(1, &tex);
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxEditorGLRenderer::supportsSignedDistanceField() {
+	if(sdfFailed) {
+		return false;
+	}
+	if(sdfShader.isLoaded()) {
+		return true;
+	}
+	if(!sdfShader.setupShaderFromSource(GL_VERTEX_SHADER, sdfVertSource) ||
+	   !sdfShader.setupShaderFromSource(GL_FRAGMENT_SHADER, sdfFragSource) ||
+	   !sdfShader.linkProgram()) {
+		ofLogError("ofxEditorGLRenderer") << "couldn't compile signed distance field shader";
+		sdfShader.unload();
+		sdfFailed = true;
+		return false;
+	}
+	return true;
+}
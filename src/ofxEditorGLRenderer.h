@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#pragma once
+
+#include "ofxEditorRenderer.h"
+#include "ofShader.h"
+
+/// openFrameworks GL renderer, the default
+///
+/// atlases are GL_ALPHA textures drawn with client vertex arrays like
+/// glfontstash, signed distance field glyphs use a small GLSL 120 shader
+class ofxEditorGLRenderer : public ofxEditorRenderer {
+
+	public:
+	
+		ofxEditorGLRenderer();
+		virtual ~ofxEditorGLRenderer();
+	
+	/// \section Frame
+	
+		void begin();
+		void end();
+		void setViewport(int x, int y, int width, int height);
+	
+	/// \section Transform
+	
+		void pushMatrix();
+		void popMatrix();
+		void translate(float x, float y);
+		void scale(float x, float y);
+	
+	/// \section Drawing
+	
+		void drawRectangle(float x, float y, float width, float height,
+		                   const ofColor &color, bool filled=true);
+		void drawGlyphs(int atlas, const float *verts, const float *tcoords,
+		                const unsigned int *colors, int nverts,
+		                bool signedDistance);
+	
+	/// \section Glyph Atlases
+	
+		int createAtlas(int width, int height);
+		void updateAtlas(int atlas, const int *rect, const unsigned char *data, int stride);
+		void deleteAtlas(int atlas);
+		bool supportsSignedDistanceField();
+	
+	protected:
+	
+		ofShader sdfShader; //< SDF glyph shader
+		bool sdfFailed;     //< couldn't compile the SDF shader?
+};
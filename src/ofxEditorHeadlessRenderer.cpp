@@ -0,0 +1,337 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#include "ofxEditorHeadlessRenderer.h"
+
+#include "ofMain.h"
+
+#include <cfloat>
+
+// recorded commands reserved up front, so recording a frame with a few more
+// commands than the last one doesn't allocate
+#define RESERVED_COMMANDS 256
+
+//--------------------------------------------------------------
+ofxEditorHeadlessRenderer::ofxEditorHeadlessRenderer() {
+	commands.reserve(RESERVED_COMMANDS);
+	nextAtlas = 1;
+	transform.x = 0;
+	transform.y = 0;
+	transform.scaleX = 1;
+	transform.scaleY = 1;
+}
+
+//--------------------------------------------------------------
+ofxEditorHeadlessRenderer::~ofxEditorHeadlessRenderer() {}
+
+// IMAGE
+
+//--------------------------------------------------------------
+void ofxEditorHeadlessRenderer::allocate(int width, int height) {
+	if(width <= 0 || height <= 0) {
+		pixels.clear();
+		viewport = ofRectangle();
+		return;
+	}
+	pixels.allocate(width, height, OF_PIXELS_RGBA);
+	viewport = ofRectangle(0, 0, width, height);
+	clear();
+}
+
+//--------------------------------------------------------------
+void ofxEditorHeadlessRenderer::clear(const ofColor &color) {
+	if(pixels.isAllocated()) {
+		pixels.setColor(color);
+	}
+}
+
+//--------------------------------------------------------------
+const ofPixels& ofxEditorHeadlessRenderer::getPixels() {
+	return pixels;
+}
+
+//--------------------------------------------------------------
+int ofxEditorHeadlessRenderer::compare(const ofPixels &a, const ofPixels &b, int tolerance) {
+	if(a.getWidth() != b.getWidth() || a.getHeight() != b.getHeight() ||
+	   a.getNumChannels() != b.getNumChannels()) {
+		return -1;
+	}
+	int count = 0;
+	size_t channels = a.getNumChannels();
+	const unsigned char *pa = a.getData(), *pb = b.getData();
+	for(size_t i = 0; i < a.size(); i += channels) {
+		for(size_t c = 0; c < channels; ++c) {
+			if(abs((int)pa[i+c] - (int)pb[i+c]) > tolerance) {
+				count++;
+				break;
+			}
+		}
+	}
+	return count;
+}
+
+// COMMANDS
+
+//--------------------------------------------------------------
+const std::vector<ofxEditorHeadlessRenderer::Command>& ofxEditorHeadlessRenderer::getCommands() {
+	return commands;
+}
+
+//--------------------------------------------------------------
+void ofxEditorHeadlessRenderer::clearCommands() {
+	commands.clear();
+}
+
+//--------------------------------------------------------------
+int ofxEditorHeadlessRenderer::getNumAtlases() {
+	return atlases.size();
+}
+
+// FRAME
+
+//--------------------------------------------------------------
+void ofxEditorHeadlessRenderer::begin() {
+	Frame frame;
+	frame.transform = transform;
+	frame.viewport = viewport;
+	frame.depth = transforms.size();
+	frames.push_back(frame);
+}
+
+//--------------------------------------------------------------
+void ofxEditorHeadlessRenderer::end() {
+	if(frames.empty()) {
+		ofLogWarning("ofxEditorHeadlessRenderer") << "end() without begin()";
+		return;
+	}
+	Frame &frame = frames.back();
+	transform = frame.transform;
+	viewport = frame.viewport;
+	transforms.resize(frame.depth);
+	frames.pop_back();
+}
+
+//--------------------------------------------------------------
+void ofxEditorHeadlessRenderer::setViewport(int x, int y, int width, int height) {
+	viewport = ofRectangle(x, y, width, height);
+	Command command = {Command::VIEWPORT, viewport, ofColor(), false, 0, 0, false};
+	commands.push_back(command);
+}
+
+// TRANSFORM
+
+//--------------------------------------------------------------
+void ofxEditorHeadlessRenderer::pushMatrix() {
+	transforms.push_back(transform);
+}
+
+//--------------------------------------------------------------
+void ofxEditorHeadlessRenderer::popMatrix() {
+	if(transforms.empty()) {
+		ofLogWarning("ofxEditorHeadlessRenderer") << "popMatrix() without pushMatrix()";
+		return;
+	}
+	transform = transforms.back();
+	transforms.pop_back();
+}
+
+//--------------------------------------------------------------
+void ofxEditorHeadlessRenderer::translate(float x, float y) {
+	transform.x += x * transform.scaleX;
+	transform.y += y * transform.scaleY;
+}
+
+//--------------------------------------------------------------
+void ofxEditorHeadlessRenderer::scale(float x, float y) {
+	transform.scaleX *= x;
+	transform.scaleY *= y;
+}
+
+// DRAWING
+
+//--------------------------------------------------------------
+void ofxEditorHeadlessRenderer::drawRectangle(float x, float y, float width, float height,
+                                              const ofColor &color, bool filled) {
+	float x0 = viewport.x + transform.x + x * transform.scaleX;
+	float y0 = viewport.y + transform.y + y * transform.scaleY;
+	float x1 = x0 + width * transform.scaleX;
+	float y1 = y0 + height * transform.scaleY;
+	Command command = {Command::RECTANGLE, ofRectangle(x0, y0, x1-x0, y1-y0), color, filled, 0, 0, false};
+	commands.push_back(command);
+	if(!pixels.isAllocated()) {
+		return;
+	}
+	if(filled) {
+		fill(x0, y0, x1, y1, color);
+	}
+	else {
+		// 1 pixel outline
+		fill(x0, y0, x1, y0+1, color);
+		fill(x0, y1-1, x1, y1, color);
+		fill(x0, y0+1, x0+1, y1-1, color);
+		fill(x1-1, y0+1, x1, y1-1, color);
+	}
+}
+
+//--------------------------------------------------------------
+void ofxEditorHeadlessRenderer::drawGlyphs(int atlas, const float *verts, const float *tcoords,
+                                           const unsigned int *colors, int nverts,
+                                           bool signedDistance) {
+	Command command = {Command::GLYPHS, ofRectangle(), ofColor(), false, atlas, nverts, signedDistance};
+	float bx0 = FLT_MAX, by0 = FLT_MAX, bx1 = -FLT_MAX, by1 = -FLT_MAX;
+	std::map<int, Atlas>::iterator iter = atlases.find(atlas);
+	bool rasterize = pixels.isAllocated() && iter != atlases.end();
+	for(int i = 0; i+5 < nverts; i += 6) {
+	
+		// the quad is the bounds of its 2 triangles
+		const float *v = &verts[i*2], *t = &tcoords[i*2];
+		float qx0 = v[0], qy0 = v[1], qx1 = v[0], qy1 = v[1];
+		float s0 = t[0], t0 = t[1], s1 = t[0], t1 = t[1];
+		for(int j = 1; j < 6; ++j) {
+			if(v[j*2] < qx0)   {qx0 = v[j*2];   s0 = t[j*2];}
+			if(v[j*2] > qx1)   {qx1 = v[j*2];   s1 = t[j*2];}
+			if(v[j*2+1] < qy0) {qy0 = v[j*2+1]; t0 = t[j*2+1];}
+			if(v[j*2+1] > qy1) {qy1 = v[j*2+1]; t1 = t[j*2+1];}
+		}
+		qx0 = viewport.x + transform.x + qx0 * transform.scaleX;
+		qy0 = viewport.y + transform.y + qy0 * transform.scaleY;
+		qx1 = viewport.x + transform.x + qx1 * transform.scaleX;
+		qy1 = viewport.y + transform.y + qy1 * transform.scaleY;
+		bx0 = MIN(bx0, qx0);
+		by0 = MIN(by0, qy0);
+		bx1 = MAX(bx1, qx1);
+		by1 = MAX(by1, qy1);
+		if(!rasterize || qx1 <= qx0 || qy1 <= qy0) {
+			continue;
+		}
+		
+		unsigned int c = colors[i];
+		unsigned char r = c & 0xFF, g = (c >> 8) & 0xFF, b = (c >> 16) & 0xFF;
+		float a = ((c >> 24) & 0xFF) / 255.0f;
+		float du = (s1 - s0) / (qx1 - qx0); // texture coord change per pixel
+		float dv = (t1 - t0) / (qy1 - qy0);
+		int px0 = MAX(ceilf(qx0 - 0.5f), viewport.x);
+		int py0 = MAX(ceilf(qy0 - 0.5f), viewport.y);
+		int px1 = MIN(ceilf(qx1 - 0.5f), viewport.getRight());
+		int py1 = MIN(ceilf(qy1 - 0.5f), viewport.getBottom());
+		for(int py = py0; py < py1; ++py) {
+			float tv = t0 + (py + 0.5f - qy0) * dv;
+			for(int px = px0; px < px1; ++px) {
+				float tu = s0 + (px + 0.5f - qx0) * du;
+				float alpha = sample(iter->second, tu, tv);
+				if(signedDistance) {
+					// same as the GL shader, fwidth from the neighboring pixels
+					float dx = sample(iter->second, tu + du, tv) - alpha;
+					float dy = sample(iter->second, tu, tv + dv) - alpha;
+					float width = MAX((fabsf(dx) + fabsf(dy)) * 0.7f, 0.001f);
+					float e = ofClamp((alpha - (0.5f - width)) / (width * 2), 0, 1);
+					alpha = e * e * (3 - 2 * e); // smoothstep
+				}
+				if(alpha > 0) {
+					blend(px, py, r, g, b, a * alpha);
+				}
+			}
+		}
+	}
+	if(nverts >= 6) {
+		command.bounds = ofRectangle(bx0, by0, bx1-bx0, by1-by0);
+	}
+	commands.push_back(command);
+}
+
+// GLYPH ATLASES
+
+//--------------------------------------------------------------
+int ofxEditorHeadlessRenderer::createAtlas(int width, int height) {
+	Atlas atlas;
+	atlas.width = width;
+	atlas.height = height;
+	atlas.data.assign(width * height, 0);
+	atlases[nextAtlas] = atlas;
+	return nextAtlas++;
+}
+
+//--------------------------------------------------------------
+void ofxEditorHeadlessRenderer::updateAtlas(int atlas, const int *rect, const unsigned char *data, int stride) {
+	std::map<int, Atlas>::iterator iter = atlases.find(atlas);
+	if(iter == atlases.end()) {
+		return;
+	}
+	Atlas &a = iter->second;
+	int x0 = MAX(rect[0], 0), y0 = MAX(rect[1], 0);
+	int x1 = MIN(rect[2], a.width), y1 = MIN(rect[3], a.height);
+	for(int y = y0; y < y1; ++y) {
+		memcpy(&a.data[x0 + y * a.width], &data[x0 + y * stride], MAX(x1 - x0, 0));
+	}
+}
+
+//--------------------------------------------------------------
+void ofxEditorHeadlessRenderer::deleteAtlas(int atlas) {
+	atlases.erase(atlas);
+}
+
+//--------------------------------------------------------------
+bool ofxEditorHeadlessRenderer::supportsSignedDistanceField() {
+	return true;
+}
+
+// PROTECTED
+
+//--------------------------------------------------------------
+void ofxEditorHeadlessRenderer::fill(float x0, float y0, float x1, float y1, const ofColor &color) {
+	int px0 = MAX(ceilf(MIN(x0, x1) - 0.5f), viewport.x);
+	int py0 = MAX(ceilf(MIN(y0, y1) - 0.5f), viewport.y);
+	int px1 = MIN(ceilf(MAX(x0, x1) - 0.5f), viewport.getRight());
+	int py1 = MIN(ceilf(MAX(y0, y1) - 0.5f), viewport.getBottom());
+	float a = color.a / 255.0f;
+	for(int py = py0; py < py1; ++py) {
+		for(int px = px0; px < px1; ++px) {
+			blend(px, py, color.r, color.g, color.b, a);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofxEditorHeadlessRenderer::blend(int x, int y, unsigned char r, unsigned char g, unsigned char b, float a) {
+	if(x < 0 || y < 0 || x >= (int)pixels.getWidth() || y >= (int)pixels.getHeight()) {
+		return;
+	}
+	
+	// GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA for all channels
+	unsigned char *p = &pixels.getData()[(x + y * pixels.getWidth()) * 4];
+	float src[4] = {(float)r, (float)g, (float)b, a * 255.0f};
+	for(int i = 0; i < 4; ++i) {
+		p[i] = (unsigned char)ofClamp(src[i] * a + p[i] * (1 - a) + 0.5f, 0, 255);
+	}
+}
+
+//--------------------------------------------------------------
+float ofxEditorHeadlessRenderer::sample(const Atlas &atlas, float u, float v) {
+	
+	// GL_LINEAR with clamp to edge
+	float x = u * atlas.width - 0.5f, y = v * atlas.height - 0.5f;
+	int x0 = floorf(x), y0 = floorf(y);
+	float fx = x - x0, fy = y - y0;
+	int ix0 = ofClamp(x0, 0, atlas.width-1), ix1 = ofClamp(x0+1, 0, atlas.width-1);
+	int iy0 = ofClamp(y0, 0, atlas.height-1), iy1 = ofClamp(y0+1, 0, atlas.height-1);
+	const unsigned char *d = atlas.data.data();
+	float top = d[ix0 + iy0 * atlas.width] * (1 - fx) + d[ix1 + iy0 * atlas.width] * fx;
+	float bottom = d[ix0 + iy1 * atlas.width] * (1 - fx) + d[ix1 + iy1 * atlas.width] * fx;
+	return (top * (1 - fy) + bottom * fy) / 255.0f;
+}
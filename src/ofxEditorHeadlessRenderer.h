@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#pragma once
+
+#include "ofxEditorRenderer.h"
+#include "ofPixels.h"
+#include "ofRectangle.h"
+
+#include <map>
+
+/// CPU renderer for running without a GPU, ie. benchmarks & golden image
+/// tests on headless machines
+///
+/// draw commands are recorded and, when an image is allocated, rasterized
+/// into RGBA pixels by sampling the glyph atlases with the same alpha
+/// blending as ofEnableAlphaBlending()
+///
+/// only translation & scaling are supported which is all the editor uses
+class ofxEditorHeadlessRenderer : public ofxEditorRenderer {
+
+	public:
+	
+		ofxEditorHeadlessRenderer();
+		virtual ~ofxEditorHeadlessRenderer();
+	
+	/// \section Image
+	
+		/// allocate the RGBA image to rasterize into, cleared to transparent
+		/// black, a 0 size disables rasterizing & only records commands
+		void allocate(int width, int height);
+	
+		/// clear the image to a color
+		void clear(const ofColor &color=ofColor(0, 0, 0, 0));
+	
+		/// get the rasterized image
+		const ofPixels& getPixels();
+	
+		/// returns the number of pixels where any channel differs by more than
+		/// tolerance, for comparing against golden images, returns -1 if the
+		/// image sizes or formats differ
+		static int compare(const ofPixels &a, const ofPixels &b, int tolerance=0);
+	
+	/// \section Commands
+	
+		/// recorded draw command
+		struct Command {
+			enum Type {
+				VIEWPORT,  //< viewport set
+				RECTANGLE, //< rectangle drawn
+				GLYPHS     //< glyph quads drawn
+			};
+			Type type;
+			ofRectangle bounds; //< transformed bounds in pixels
+			ofColor color;      //< rectangle color
+			bool filled;        //< filled rectangle?
+			int atlas;          //< glyph atlas handle
+			int numVertices;    //< glyph vertices
+			bool signedDistance; //< SDF glyphs?
+		};
+	
+		/// get the draw commands recorded since the last clearCommands()
+		const std::vector<Command>& getCommands();
+	
+		/// clear the recorded draw commands
+		void clearCommands();
+	
+		/// get the number of atlases currently created
+		int getNumAtlases();
+	
+	/// \section Frame
+	
+		void begin();
+		void end();
+		void setViewport(int x, int y, int width, int height);
+	
+	/// \section Transform
+	
+		void pushMatrix();
+		void popMatrix();
+		void translate(float x, float y);
+		void scale(float x, float y);
+	
+	/// \section Drawing
+	
+		void drawRectangle(float x, float y, float width, float height,
+		                   const ofColor &color, bool filled=true);
+		void drawGlyphs(int atlas, const float *verts, const float *tcoords,
+		                const unsigned int *colors, int nverts,
+		                bool signedDistance);
+	
+	/// \section Glyph Atlases
+	
+		int createAtlas(int width, int height);
+		void updateAtlas(int atlas, const int *rect, const unsigned char *data, int stride);
+		void deleteAtlas(int atlas);
+		bool supportsSignedDistanceField();
+	
+	protected:
+	
+		/// translation & scale
+		struct Transform {
+			float x, y;
+			float scaleX, scaleY;
+		};
+	
+		/// saved state from begin()
+		struct Frame {
+			Transform transform;
+			ofRectangle viewport;
+			size_t depth; //< transform stack depth
+		};
+	
+		/// atlas texture copy
+		struct Atlas {
+			int width, height;
+			std::vector<unsigned char> data;
+		};
+	
+		/// fill pixels whose centers are inside a transformed rectangle
+		void fill(float x0, float y0, float x1, float y1, const ofColor &color);
+	
+		/// blend a color into a pixel
+		void blend(int x, int y, unsigned char r, unsigned char g, unsigned char b, float a);
+	
+		/// sample an atlas with bilinear filtering, u & v are 0-1
+		float sample(const Atlas &atlas, float u, float v);
+	
+		ofPixels pixels; //< rasterized image
+		std::vector<Command> commands; //< recorded draw commands
+		std::map<int, Atlas> atlases; //< atlases by handle
+		int nextAtlas; //< next atlas handle
+		Transform transform; //< current transform
+		std::vector<Transform> transforms; //< pushed transforms
+		std::vector<Frame> frames; //< pushed frames
+		ofRectangle viewport; //< clip area in pixels
+};
@@ -0,0 +1,371 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#include "ofxEditorHistory.h"
+
+#include "ofMain.h"
+#include "Unicode.h"
+
+#include <algorithm>
+#include <cstdio>
+
+// default max number of entries
+#define DEFAULT_MAX_SIZE 10000
+
+// utils
+static std::string escape(const std::string &s);
+static std::string unescape(const std::string &s);
+
+/// pack 3 codepoints (21 bits each) into a trigram index key
+static inline uint64_t trigram(const char32_t *c) {
+	return ((uint64_t)c[0] << 42) | ((uint64_t)c[1] << 21) | (uint64_t)c[2];
+}
+
+//--------------------------------------------------------------
+ofxEditorHistory::ofxEditorHistory() {
+	m_maxSize = DEFAULT_MAX_SIZE;
+}
+
+//--------------------------------------------------------------
+ofxEditorHistory::~ofxEditorHistory() {
+	if(m_loader.joinable()) {
+		m_loader.join();
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxEditorHistory::setFile(const std::string &path) {
+	waitForLoad();
+	if(m_stream.is_open()) {
+		m_stream.close();
+	}
+	m_data = Data();
+	m_file = path;
+	m_path = "";
+	if(path == "") {
+		return true;
+	}
+	std::string absPath = ofToDataPath(path, true);
+	m_stream.open(absPath, std::ios::out | std::ios::app | std::ios::binary);
+	if(!m_stream.is_open()) {
+		ofLogError("ofxEditorHistory") << "couldn't open \""
+			<< ofFilePath::getFileName(path) << "\"";
+		return false;
+	}
+	m_path = absPath;
+
+	// only load what's there now, new entries are appended while loading
+	std::ifstream file(absPath, std::ios::in | std::ios::binary | std::ios::ate);
+	size_t bytes = (file.is_open() ? (size_t)file.tellg() : 0);
+	m_loader = std::thread(&ofxEditorHistory::load, this, absPath, bytes, m_maxSize);
+	return true;
+}
+
+//--------------------------------------------------------------
+std::string ofxEditorHistory::getFile() {
+	return m_file;
+}
+
+//--------------------------------------------------------------
+void ofxEditorHistory::setMaxSize(size_t size) {
+	waitForLoad();
+	m_maxSize = std::max(size, (size_t)1);
+	removeOldest(m_data, m_data.entries.size() > m_maxSize ? m_data.entries.size() - m_maxSize : 0);
+}
+
+//--------------------------------------------------------------
+size_t ofxEditorHistory::getMaxSize() {
+	return m_maxSize;
+}
+
+//--------------------------------------------------------------
+void ofxEditorHistory::add(const std::u32string &entry) {
+	if(entry.empty()) {
+		return;
+	}
+	if(m_loader.joinable()) { // still loading
+		if(!m_pending.empty() && m_pending.back() == entry) {
+			return;
+		}
+		m_pending.push_back(entry);
+	}
+	else {
+		if(!m_data.entries.empty() && m_data.entries.back() == entry) {
+			return;
+		}
+		addEntry(m_data, entry);
+		removeOldest(m_data, m_data.entries.size() > m_maxSize ? 1 : 0);
+	}
+	if(m_stream.is_open()) {
+		m_stream << escape(wstring_to_string(entry)) << '\n';
+		m_stream.flush();
+		m_data.fileLines++;
+		if(!m_loader.joinable() && m_data.fileLines > m_maxSize * 2) {
+			compact();
+		}
+	}
+}
+
+//--------------------------------------------------------------
+size_t ofxEditorHistory::size() {
+	waitForLoad();
+	return m_data.entries.size();
+}
+
+//--------------------------------------------------------------
+const std::u32string& ofxEditorHistory::get(size_t index) {
+	waitForLoad();
+	return m_data.entries[index];
+}
+
+//--------------------------------------------------------------
+void ofxEditorHistory::clear() {
+	waitForLoad();
+	m_data = Data();
+	if(m_path != "") {
+		m_stream.close();
+		m_stream.open(m_path, std::ios::out | std::ios::trunc | std::ios::binary);
+	}
+}
+
+//--------------------------------------------------------------
+void ofxEditorHistory::trim(size_t num) {
+	waitForLoad();
+	removeOldest(m_data, std::min(num, m_data.entries.size()));
+}
+
+//--------------------------------------------------------------
+bool ofxEditorHistory::search(const std::u32string &text, size_t &index) {
+	waitForLoad();
+	const std::deque<std::u32string> &entries = m_data.entries;
+	size_t before = std::min(index, entries.size());
+	if(text.empty() || before == 0) {
+		return false;
+	}
+
+	// too short for the index, scan
+	if(text.size() < 3) {
+		for(size_t i = before; i > 0; --i) {
+			if(entries[i-1].find(text) != std::u32string::npos) {
+				index = i-1;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// candidates from the shortest trigram list, all trigrams must match
+	const std::vector<uint32_t> *ids = NULL;
+	for(size_t i = 0; i+2 < text.size(); ++i) {
+		auto iter = m_data.index.find(trigram(&text[i]));
+		if(iter == m_data.index.end()) {
+			return false;
+		}
+		if(!ids || iter->second.size() < ids->size()) {
+			ids = &iter->second;
+		}
+	}
+	uint32_t beforeId = m_data.firstId + before;
+	auto iter = std::lower_bound(ids->begin(), ids->end(), beforeId);
+	while(iter != ids->begin()) {
+		--iter;
+		if(*iter < m_data.firstId) { // removed
+			break;
+		}
+		if(entries[*iter - m_data.firstId].find(text) != std::u32string::npos) {
+			index = *iter - m_data.firstId;
+			return true;
+		}
+	}
+	return false;
+}
+
+//--------------------------------------------------------------
+size_t ofxEditorHistory::getMemoryUsage() {
+	size_t bytes = 0; // loading data isn't counted
+	for(auto &entry : m_data.entries) {
+		bytes += sizeof(std::u32string) + entry.capacity() * sizeof(char32_t);
+	}
+	bytes += m_data.index.bucket_count() * sizeof(void*);
+	for(auto &ids : m_data.index) {
+		bytes += sizeof(ids) + 2 * sizeof(void*) + ids.second.capacity() * sizeof(uint32_t);
+	}
+	for(auto &entry : m_pending) {
+		bytes += sizeof(std::u32string) + entry.capacity() * sizeof(char32_t);
+	}
+	return bytes;
+}
+
+// PRIVATE
+
+//--------------------------------------------------------------
+void ofxEditorHistory::addEntry(Data &data, const std::u32string &entry) {
+	uint32_t id = data.firstId + data.entries.size();
+	data.entries.push_back(entry);
+	for(size_t i = 0; i+2 < entry.size(); ++i) {
+		std::vector<uint32_t> &ids = data.index[trigram(&entry[i])];
+		if(ids.empty() || ids.back() != id) {
+			ids.push_back(id);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofxEditorHistory::rebuildIndex(Data &data) {
+	data.index.clear();
+	data.staleIds = 0;
+	uint32_t id = data.firstId;
+	for(auto &entry : data.entries) {
+		for(size_t i = 0; i+2 < entry.size(); ++i) {
+			std::vector<uint32_t> &ids = data.index[trigram(&entry[i])];
+			if(ids.empty() || ids.back() != id) {
+				ids.push_back(id);
+			}
+		}
+		id++;
+	}
+}
+
+//--------------------------------------------------------------
+void ofxEditorHistory::removeOldest(Data &data, size_t num) {
+	if(num == 0) {
+		return;
+	}
+	data.entries.erase(data.entries.begin(), data.entries.begin()+num);
+	data.firstId += num;
+	data.staleIds += num;
+
+	// removed ids are skipped by search, rebuild once they outnumber the
+	// entries so the cost is spread over many removals
+	if(data.staleIds > data.entries.size()) {
+		rebuildIndex(data);
+	}
+}
+
+//--------------------------------------------------------------
+void ofxEditorHistory::load(const std::string &path, size_t bytes, size_t maxSize) {
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+	if(!file.is_open() || bytes == 0) {
+		return;
+	}
+	std::string buffer(bytes, '\0');
+	file.read(&buffer[0], bytes);
+	buffer.resize(file.gcount());
+
+	// only the newest entries are kept, find where they start
+	std::vector<size_t> starts;
+	size_t start = 0;
+	for(size_t i = 0; i < buffer.size(); ++i) {
+		if(buffer[i] == '\n') {
+			starts.push_back(start);
+			start = i+1;
+		}
+	}
+	m_loaded.fileLines = starts.size();
+	size_t first = (starts.size() > maxSize ? starts.size() - maxSize : 0);
+	for(size_t i = first; i < starts.size(); ++i) {
+		size_t end = buffer.find('\n', starts[i]);
+		std::u32string entry = string_to_wstring(unescape(buffer.substr(starts[i], end - starts[i])));
+		if(!entry.empty()) {
+			addEntry(m_loaded, entry);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofxEditorHistory::waitForLoad() {
+	if(!m_loader.joinable()) {
+		return;
+	}
+	m_loader.join();
+	size_t fileLines = m_data.fileLines; // appended while loading
+	m_data = std::move(m_loaded);
+	m_loaded = Data();
+	m_data.fileLines += fileLines;
+	for(auto &entry : m_pending) {
+		if(m_data.entries.empty() || m_data.entries.back() != entry) {
+			addEntry(m_data, entry);
+		}
+	}
+	m_pending.clear();
+	removeOldest(m_data, m_data.entries.size() > m_maxSize ? m_data.entries.size() - m_maxSize : 0);
+	if(m_data.fileLines > m_maxSize * 2) {
+		compact();
+	}
+}
+
+//--------------------------------------------------------------
+void ofxEditorHistory::compact() {
+	std::string tempPath = m_path + ".tmp";
+	std::ofstream temp(tempPath, std::ios::out | std::ios::trunc | std::ios::binary);
+	if(!temp.is_open()) {
+		return;
+	}
+	for(auto &entry : m_data.entries) {
+		temp << escape(wstring_to_string(entry)) << '\n';
+	}
+	temp.close();
+	if(!temp) {
+		std::remove(tempPath.c_str());
+		return;
+	}
+	m_stream.close();
+	if(std::rename(tempPath.c_str(), m_path.c_str()) != 0) {
+		std::remove(m_path.c_str()); // rename doesn't replace on Windows
+		std::rename(tempPath.c_str(), m_path.c_str());
+	}
+	m_stream.open(m_path, std::ios::out | std::ios::app | std::ios::binary);
+	m_data.fileLines = m_data.entries.size();
+}
+
+// UTIL
+
+//--------------------------------------------------------------
+std::string escape(const std::string &s) {
+	std::string escaped;
+	escaped.reserve(s.size());
+	for(char c : s) {
+		switch(c) {
+			case '\\': escaped += "\\\\"; break;
+			case '\n': escaped += "\\n"; break;
+			case '\r': escaped += "\\r"; break;
+			default: escaped += c; break;
+		}
+	}
+	return escaped;
+}
+
+//--------------------------------------------------------------
+std::string unescape(const std::string &s) {
+	std::string unescaped;
+	unescaped.reserve(s.size());
+	for(size_t i = 0; i < s.size(); ++i) {
+		if(s[i] == '\\' && i+1 < s.size()) {
+			switch(s[++i]) {
+				case 'n': unescaped += '\n'; break;
+				case 'r': unescaped += '\r'; break;
+				default: unescaped += s[i]; break;
+			}
+		}
+		else if(s[i] != '\r') { // CRLF
+			unescaped += s[i];
+		}
+	}
+	return unescaped;
+}
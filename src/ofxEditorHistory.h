@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#pragma once
+
+#include <deque>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/// command history with an optional append-only file & a trigram index for
+/// substring search
+///
+/// the file has one entry per line with newlines & backslashes escaped, it is
+/// loaded on a background thread & the first access waits until it's done,
+/// new entries are appended right away
+class ofxEditorHistory {
+
+	public:
+
+		ofxEditorHistory();
+		virtual ~ofxEditorHistory(); //< waits for loading
+
+		/// set the file to load from & append to, relative to the data path,
+		/// replaces the current entries & starts loading in the background,
+		/// "" for no file, returns false if the file couldn't be opened
+		bool setFile(const std::string &path);
+		std::string getFile();
+
+		/// set/get the max number of entries, the oldest are removed when
+		/// over, default 10000
+		void setMaxSize(size_t size);
+		size_t getMaxSize();
+
+		/// add an entry & append it to the file, ignores an empty entry or a
+		/// repeat of the newest entry
+		void add(const std::u32string &entry);
+
+		/// get the number of entries, waits for loading
+		size_t size();
+
+		/// get an entry, 0 is the oldest, waits for loading
+		const std::u32string& get(size_t index);
+
+		/// remove all entries & empty the file
+		void clear();
+
+		/// remove the oldest entries from memory, the file is left as is
+		void trim(size_t num);
+
+		/// find the newest entry before index which contains text,
+		/// sets index to the match & returns true if found
+		bool search(const std::u32string &text, size_t &index);
+
+		/// get the approximate heap memory used in bytes
+		size_t getMemoryUsage();
+
+	private:
+
+		/// entries & index, built by the loader thread while loading
+		struct Data {
+			std::deque<std::u32string> entries; //< oldest first
+			uint32_t firstId = 0; //< id of the oldest entry
+			uint32_t staleIds = 0; //< removed entry ids still in the index
+			/// entry ids per trigram, ascending
+			std::unordered_map<uint64_t, std::vector<uint32_t>> index;
+			size_t fileLines = 0; //< number of entries in the file
+		};
+
+		/// add an entry to data & the index
+		void addEntry(Data &data, const std::u32string &entry);
+
+		/// rebuild the index without removed entries
+		void rebuildIndex(Data &data);
+
+		/// remove the oldest num entries
+		void removeOldest(Data &data, size_t num);
+
+		/// load file entries into data, loader thread
+		void load(const std::string &path, size_t bytes, size_t maxSize);
+
+		/// wait for loading & merge the loaded entries
+		void waitForLoad();
+
+		/// rewrite the file with the current entries, ie. once it's grown to
+		/// more than twice the max size
+		void compact();
+
+		Data m_data; //< entries & index
+		Data m_loaded; //< loader thread data
+		std::vector<std::u32string> m_pending; //< entries added while loading
+		size_t m_maxSize; //< max number of entries
+
+		std::string m_path; //< absolute file path, "" if none
+		std::string m_file; //< file path as set
+		std::ofstream m_stream; //< file append stream
+		std::thread m_loader; //< loader thread, joinable while loading
+};
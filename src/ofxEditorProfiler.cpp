@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#include "ofxEditorProfiler.h"
+
+#include <algorithm>
+
+// default rolling window size, 2 seconds at 60 fps
+#define DEFAULT_WINDOW_SIZE 120
+
+unsigned int ofxEditorProfiler::s_windowSize = DEFAULT_WINDOW_SIZE;
+ofxEditorProfiler::Samples ofxEditorProfiler::s_samples[ofxEditorProfiler::NUM_PHASES];
+float ofxEditorProfiler::s_current[ofxEditorProfiler::NUM_PHASES] = {0};
+
+//--------------------------------------------------------------
+ofxEditorProfiler::Stats ofxEditorProfiler::getStats(Phase phase) {
+	if(phase < 0 || phase >= NUM_PHASES) {
+		return Stats();
+	}
+	return s_samples[phase].getStats();
+}
+
+//--------------------------------------------------------------
+const char* ofxEditorProfiler::getPhaseName(Phase phase) {
+	switch(phase) {
+		case DRAW:                return "draw";
+		case DRAW_SCROLL:         return "draw scroll";
+		case DRAW_MATCHING_CHARS: return "draw matching chars";
+		case DRAW_TEXT:           return "draw text";
+		case DRAW_LINE_NUMBERS:   return "draw line numbers";
+		case DRAW_GLYPHS:         return "draw glyphs";
+		case DRAW_AUTO_FOCUS:     return "draw auto focus";
+		case TEXT_UPDATE:         return "text update";
+		case TEXT_PARSE:          return "text parse";
+		default:                  return "unknown";
+	}
+}
+
+//--------------------------------------------------------------
+void ofxEditorProfiler::setWindowSize(unsigned int size) {
+	s_windowSize = std::max(size, 1u);
+	for(int i = 0; i < NUM_PHASES; ++i) {
+		s_samples[i].setSize(s_windowSize);
+		s_current[i] = 0;
+	}
+}
+
+//--------------------------------------------------------------
+unsigned int ofxEditorProfiler::getWindowSize() {
+	return s_windowSize;
+}
+
+//--------------------------------------------------------------
+void ofxEditorProfiler::clear() {
+	for(int i = 0; i < NUM_PHASES; ++i) {
+		s_samples[i].clear();
+		s_current[i] = 0;
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxEditorProfiler::isEnabled() {
+#ifdef OFXEDITOR_PROFILING
+	return true;
+#else
+	return false;
+#endif
+}
+
+//--------------------------------------------------------------
+void ofxEditorProfiler::add(Phase phase, float us) {
+	s_current[phase] += us;
+}
+
+//--------------------------------------------------------------
+void ofxEditorProfiler::commit(Phase first, Phase last) {
+	for(int i = first; i <= last; ++i) {
+		s_samples[i].add(s_current[i]);
+		s_current[i] = 0;
+	}
+}
+
+// SAMPLES
+
+//--------------------------------------------------------------
+ofxEditorProfiler::Samples::Samples() : times(s_windowSize, 0), next(0), count(0) {}
+
+//--------------------------------------------------------------
+void ofxEditorProfiler::Samples::add(float us) {
+	times[next] = us;
+	next = (next + 1) % times.size();
+	if(count < times.size()) {
+		count++;
+	}
+}
+
+//--------------------------------------------------------------
+ofxEditorProfiler::Stats ofxEditorProfiler::Samples::getStats() const {
+	Stats stats;
+	if(count == 0) {
+		return stats;
+	}
+	std::vector<float> sorted(times.begin(), times.begin()+count);
+	std::sort(sorted.begin(), sorted.end());
+	float sum = 0;
+	for(unsigned int i = 0; i < sorted.size(); ++i) {
+		sum += sorted[i];
+	}
+	stats.mean = sum / sorted.size();
+	stats.p95 = sorted[(sorted.size()-1) * 95 / 100];
+	stats.max = sorted.back();
+	stats.last = times[(next + times.size() - 1) % times.size()];
+	stats.count = count;
+	return stats;
+}
+
+//--------------------------------------------------------------
+void ofxEditorProfiler::Samples::clear() {
+	next = 0;
+	count = 0;
+}
+
+//--------------------------------------------------------------
+void ofxEditorProfiler::Samples::setSize(unsigned int size) {
+	times.assign(std::max(size, 1u), 0);
+	clear();
+}
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#pragma once
+
+#include "ofxEditorTracer.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// uncomment or define in your project's compiler flags to time the editor
+// draw & parse phases, otherwise the timers are compiled out completely
+//#define OFXEDITOR_PROFILING
+
+// the phase timers are also compiled in when tracing so the draw & parse
+// phases show up in traces
+#if defined(OFXEDITOR_PROFILING) || defined(OFXEDITOR_TRACING)
+	/// time the enclosing scope as the given ofxEditorProfiler::Phase
+	#define OFXEDITOR_PROFILE_SCOPE(phase) \
+		ofxEditorProfiler::Scope ofxEditorProfilerScope_##phase(ofxEditorProfiler::phase)
+	/// start timing a phase which does not match a scope, stop with
+	/// OFXEDITOR_PROFILE_END in the same scope
+	#define OFXEDITOR_PROFILE_BEGIN(phase) OFXEDITOR_PROFILE_SCOPE(phase)
+	#define OFXEDITOR_PROFILE_END(phase) ofxEditorProfilerScope_##phase.stop()
+#else
+	#define OFXEDITOR_PROFILE_SCOPE(phase)
+	#define OFXEDITOR_PROFILE_BEGIN(phase)
+	#define OFXEDITOR_PROFILE_END(phase)
+#endif
+
+#ifdef OFXEDITOR_PROFILING
+	/// push the accumulated times for a range of phases as new samples
+	#define OFXEDITOR_PROFILE_COMMIT(first, last) \
+		ofxEditorProfiler::commit(ofxEditorProfiler::first, ofxEditorProfiler::last)
+#else
+	#define OFXEDITOR_PROFILE_COMMIT(first, last)
+#endif
+
+/// rolling per-phase timing statistics for the editor draw & parse functions
+///
+/// times within a scope are accumulated per phase, ie. the line numbers for a
+/// frame, and pushed into a fixed size sample window when committed at the
+/// end of ofxEditor::draw() or ofxEditor::textBufferUpdated()
+///
+/// nested phases are inclusive: DRAW_TEXT includes DRAW_LINE_NUMBERS & DRAW
+/// includes everything
+///
+/// the timers are only compiled in when OFXEDITOR_PROFILING is defined,
+/// otherwise the stats are always empty
+class ofxEditorProfiler {
+
+	public:
+
+		/// timed phases
+		enum Phase {
+			DRAW = 0,            //< entire ofxEditor::draw()
+			DRAW_SCROLL,         //< horizontal scroll update
+			DRAW_MATCHING_CHARS, //< parseMatchingChars()
+			DRAW_TEXT,           //< text block walk & glyph quad collection
+			DRAW_LINE_NUMBERS,   //< line number glyphs
+			DRAW_GLYPHS,         //< glyph batch flush to the renderer
+			DRAW_AUTO_FOCUS,     //< auto focus bounding box & scaling
+			TEXT_UPDATE,         //< entire ofxEditor::textBufferUpdated()
+			TEXT_PARSE,          //< parseTextBlocks() syntax parsing
+			NUM_PHASES
+		};
+
+		/// rolling stats for a phase in microseconds
+		struct Stats {
+			float mean;         //< mean time
+			float p95;          //< 95th percentile time
+			float max;          //< max time
+			float last;         //< most recent time
+			unsigned int count; //< number of samples in the window
+			Stats() : mean(0), p95(0), max(0), last(0), count(0) {}
+		};
+
+		/// rolling window of samples in microseconds, also used for the
+		/// per-editor keystroke latency
+		class Samples {
+			public:
+				Samples(); //< window size from getWindowSize()
+				void add(float us);  //< push a sample, overwrites the oldest
+				Stats getStats() const;
+				void clear();
+				void setSize(unsigned int size); //< clears samples
+				unsigned int getSize() const {return times.size();}
+			private:
+				std::vector<float> times; //< sample ring buffer
+				unsigned int next;        //< next ring buffer write index
+				unsigned int count;       //< number of valid samples
+		};
+
+		/// get the rolling stats for a phase
+		static Stats getStats(Phase phase);
+
+		/// get a short phase name for printing, ie. "draw text"
+		static const char* getPhaseName(Phase phase);
+
+		/// set the number of samples in the phase rolling windows, default 120
+		/// (2 seconds at 60 fps), clears the current samples
+		static void setWindowSize(unsigned int size);
+		static unsigned int getWindowSize();
+
+		/// clear all samples
+		static void clear();
+
+		/// returns true if the timers were compiled in
+		static bool isEnabled();
+
+		/// add to the time accumulated for a phase in microseconds
+		static void add(Phase phase, float us);
+
+		/// push the accumulated times of a range of phases as new samples
+		/// & reset the accumulators
+		static void commit(Phase first, Phase last);
+
+	#if defined(OFXEDITOR_PROFILING) || defined(OFXEDITOR_TRACING)
+		/// scoped timer which adds its lifetime to a phase on destruction or
+		/// when stopped early, use the OFXEDITOR_PROFILE_* macros so it can be
+		/// compiled out
+		class Scope {
+			public:
+				Scope(Phase phase) : phase(phase), running(true),
+					start(std::chrono::steady_clock::now()) {}
+				~Scope() {stop();}
+				void stop() {
+					if(!running) {
+						return;
+					}
+					std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+				#ifdef OFXEDITOR_PROFILING
+					add(phase, std::chrono::duration<float, std::micro>(end - start).count());
+				#endif
+				#ifdef OFXEDITOR_TRACING
+					// line numbers are drawn per line, too fine grained for a trace
+					if(phase != DRAW_LINE_NUMBERS && ofxEditorTracer::isTracing()) {
+						int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+						ofxEditorTracer::complete(getPhaseName(phase), "editor",
+							ofxEditorTracer::now() - us, us);
+					}
+				#endif
+					running = false;
+				}
+			private:
+				Phase phase;
+				bool running;
+				std::chrono::steady_clock::time_point start;
+		};
+	#endif
+
+	private:
+
+		static Samples s_samples[NUM_PHASES]; //< committed phase times
+		static float s_current[NUM_PHASES];   //< time accumulated since last commit
+		static unsigned int s_windowSize;     //< phase ring buffer size
+};
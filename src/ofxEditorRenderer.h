@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#pragma once
+
+#include "ofColor.h"
+
+/// editor drawing backend
+///
+/// ofxEditor, ofxFileDialog, & ofxEditorFont draw everything through the
+/// current renderer: rectangles for highlights & the cursor, glyph quads from
+/// the fontstash atlas pages, the transform stack, and the viewport
+///
+/// see ofxEditorGLRenderer for the default openFrameworks GL backend and
+/// ofxEditorHeadlessRenderer for drawing into memory without a GPU
+class ofxEditorRenderer {
+
+	public:
+	
+		virtual ~ofxEditorRenderer() {}
+	
+	/// \section Frame
+	
+		/// begin drawing, saves the current style, transform, & viewport
+		virtual void begin() = 0;
+	
+		/// end drawing, restores the style, transform, & viewport saved by begin()
+		virtual void end() = 0;
+	
+		/// set the viewport, drawing is clipped to this area
+		virtual void setViewport(int x, int y, int width, int height) = 0;
+	
+	/// \section Transform
+	
+		virtual void pushMatrix() = 0;
+		virtual void popMatrix() = 0;
+		virtual void translate(float x, float y) = 0;
+		virtual void scale(float x, float y) = 0;
+	
+	/// \section Drawing
+	
+		/// draw a rectangle from the top left corner, alpha blended
+		virtual void drawRectangle(float x, float y, float width, float height,
+		                           const ofColor &color, bool filled=true) = 0;
+	
+		/// draw glyph quads from an atlas, alpha blended
+		///
+		/// each quad is 2 triangles (6 vertices) with 2 floats per vertex
+		/// position & texture coordinate and one color per vertex packed as
+		/// r | g << 8 | b << 16 | a << 24
+		///
+		/// signedDistance is true when the atlas holds signed distance field
+		/// glyphs which need to be thresholded
+		virtual void drawGlyphs(int atlas, const float *verts, const float *tcoords,
+		                        const unsigned int *colors, int nverts,
+		                        bool signedDistance) = 0;
+	
+	/// \section Glyph Atlases
+	
+		/// create an 8 bit alpha glyph atlas texture,
+		/// returns an atlas handle or 0 on failure
+		virtual int createAtlas(int width, int height) = 0;
+	
+		/// update a region of an atlas from the fontstash atlas data,
+		/// rect is x0, y0, x1, y1 & stride is the data row length
+		virtual void updateAtlas(int atlas, const int *rect, const unsigned char *data, int stride) = 0;
+	
+		/// delete an atlas
+		virtual void deleteAtlas(int atlas) = 0;
+	
+		/// returns true if signed distance field glyphs can be drawn
+		virtual bool supportsSignedDistanceField() = 0;
+};
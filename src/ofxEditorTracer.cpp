@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#include "ofxEditorTracer.h"
+
+#include "ofMain.h"
+
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// default max events per thread, 48 bytes each on 64 bit
+#define DEFAULT_BUFFER_SIZE 262144
+
+/// recorded event, name, category, & argName point to string literals
+struct TraceEvent {
+	const char *name;
+	const char *category;
+	const char *argName;
+	int64_t start;
+	int64_t duration;
+	int64_t arg;
+};
+
+/// single producer event buffer owned by one thread, events below count are
+/// complete & can be read from any thread
+struct TraceBuffer {
+	std::unique_ptr<TraceEvent[]> events;
+	unsigned int size;
+	unsigned int generation; //< registry generation when created
+	std::atomic<unsigned int> count;
+	std::atomic<unsigned int> dropped;
+	std::thread::id thread;
+	TraceBuffer(unsigned int size, unsigned int generation) :
+		events(new TraceEvent[size]), size(size), generation(generation),
+		count(0), dropped(0), thread(std::this_thread::get_id()) {}
+};
+
+/// thread buffers, only locked when a thread records its first event after a
+/// clear & when saving, saves to the exit path on destruction
+struct TraceRegistry {
+	std::mutex mutex;
+	std::vector<std::shared_ptr<TraceBuffer>> buffers;
+	std::atomic<unsigned int> generation{0}; //< incremented by clear()
+	unsigned int bufferSize = DEFAULT_BUFFER_SIZE;
+	std::thread::id mainThread = std::this_thread::get_id();
+	std::string exitPath; //< absolute path, empty if not saving on exit
+	~TraceRegistry();
+	bool write(const std::string &path);
+};
+
+static TraceRegistry s_registry;
+// shared with the registry so a thread still recording during clear() writes
+// to its old buffer, which is freed when the thread replaces it or exits
+static thread_local std::shared_ptr<TraceBuffer> t_buffer;
+
+std::atomic<bool> ofxEditorTracer::s_tracing(false);
+std::chrono::steady_clock::time_point ofxEditorTracer::s_epoch = std::chrono::steady_clock::now();
+
+//--------------------------------------------------------------
+void ofxEditorTracer::start(const std::string &exitPath) {
+	{
+		std::lock_guard<std::mutex> lock(s_registry.mutex);
+		s_registry.exitPath = (exitPath == "" ? "" : ofToDataPath(exitPath, true));
+	}
+	s_tracing.store(true);
+}
+
+//--------------------------------------------------------------
+void ofxEditorTracer::stop() {
+	s_tracing.store(false);
+}
+
+//--------------------------------------------------------------
+bool ofxEditorTracer::save(const std::string &path) {
+	if(!s_registry.write(ofToDataPath(path))) {
+		ofLogError("ofxEditorTracer") << "couldn't save \""
+			<< ofFilePath::getFileName(path) << "\"";
+		return false;
+	}
+	ofLogVerbose("ofxEditorTracer") << "saved " << getNumEvents()
+		<< " events to \"" << ofFilePath::getFileName(path) << "\"";
+	return true;
+}
+
+//--------------------------------------------------------------
+void ofxEditorTracer::clear() {
+	std::lock_guard<std::mutex> lock(s_registry.mutex);
+	s_registry.buffers.clear();
+	s_registry.generation.fetch_add(1, std::memory_order_relaxed);
+	t_buffer.reset();
+}
+
+//--------------------------------------------------------------
+void ofxEditorTracer::setBufferSize(unsigned int size) {
+	std::lock_guard<std::mutex> lock(s_registry.mutex);
+	s_registry.bufferSize = MAX(size, 1);
+}
+
+//--------------------------------------------------------------
+unsigned int ofxEditorTracer::getBufferSize() {
+	return s_registry.bufferSize;
+}
+
+//--------------------------------------------------------------
+unsigned int ofxEditorTracer::getNumEvents() {
+	std::lock_guard<std::mutex> lock(s_registry.mutex);
+	unsigned int num = 0;
+	for(auto &buffer : s_registry.buffers) {
+		num += buffer->count.load(std::memory_order_acquire);
+	}
+	return num;
+}
+
+//--------------------------------------------------------------
+unsigned int ofxEditorTracer::getNumDropped() {
+	std::lock_guard<std::mutex> lock(s_registry.mutex);
+	unsigned int num = 0;
+	for(auto &buffer : s_registry.buffers) {
+		num += buffer->dropped.load(std::memory_order_relaxed);
+	}
+	return num;
+}
+
+//--------------------------------------------------------------
+void ofxEditorTracer::complete(const char *name, const char *category,
+                               int64_t start, int64_t duration,
+                               const char *argName, int64_t arg) {
+	TraceBuffer *buffer = t_buffer.get();
+	if(!buffer || buffer->generation != s_registry.generation.load(std::memory_order_relaxed)) {
+		// first event on this thread or since clear()
+		std::lock_guard<std::mutex> lock(s_registry.mutex);
+		t_buffer = std::make_shared<TraceBuffer>(s_registry.bufferSize,
+			s_registry.generation.load(std::memory_order_relaxed));
+		s_registry.buffers.push_back(t_buffer);
+		buffer = t_buffer.get();
+	}
+	unsigned int index = buffer->count.load(std::memory_order_relaxed);
+	if(index >= buffer->size) {
+		buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	TraceEvent &event = buffer->events[index];
+	event.name = name;
+	event.category = category;
+	event.argName = argName;
+	event.start = start;
+	event.duration = duration;
+	event.arg = arg;
+	buffer->count.store(index+1, std::memory_order_release); // publish
+}
+
+// TRACE REGISTRY
+
+//--------------------------------------------------------------
+TraceRegistry::~TraceRegistry() {
+	if(exitPath != "") {
+		write(exitPath);
+	}
+}
+
+//--------------------------------------------------------------
+// Chrome trace-event format: https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+bool TraceRegistry::write(const std::string &path) {
+	std::ofstream file(path, std::ios::out | std::ios::trunc);
+	if(!file.is_open()) {
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(mutex);
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first = true;
+	for(unsigned int t = 0; t < buffers.size(); ++t) {
+		TraceBuffer &buffer = *buffers[t];
+		unsigned int tid = t+1;
+
+		// thread name metadata
+		file << (first ? "\n" : ",\n");
+		first = false;
+		file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+		     << ",\"args\":{\"name\":\"";
+		if(buffer.thread == mainThread) {
+			file << "main";
+		}
+		else {
+			file << "thread " << tid;
+		}
+		file << "\"}}";
+
+		// complete events
+		unsigned int count = buffer.count.load(std::memory_order_acquire);
+		for(unsigned int i = 0; i < count; ++i) {
+			const TraceEvent &event = buffer.events[i];
+			file << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category
+			     << "\",\"ph\":\"X\",\"ts\":" << event.start << ",\"dur\":" << event.duration
+			     << ",\"pid\":1,\"tid\":" << tid;
+			if(event.argName) {
+				file << ",\"args\":{\"" << event.argName << "\":" << event.arg << "}";
+			}
+			file << "}";
+		}
+	}
+	file << "\n]}\n";
+	return file.good();
+}
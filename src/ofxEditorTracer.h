@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2015 Dan Wilcox <danomatika@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * See https://github.com/Akira-Hayasaka/ofxGLEditor for more info.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// uncomment or define in your project's compiler flags to compile in the
+// editor trace points, otherwise they are compiled out completely
+//#define OFXEDITOR_TRACING
+
+#ifdef OFXEDITOR_TRACING
+	/// trace the enclosing scope as a complete event, name & category must be
+	/// string literals or otherwise outlive the tracer
+	#define OFXEDITOR_TRACE_SCOPE(name, category) \
+		ofxEditorTracer::Scope ofxEditorTraceScope(name, category)
+	/// trace the enclosing scope with a named integer argument
+	#define OFXEDITOR_TRACE_SCOPE_ARG(name, category, argName, arg) \
+		ofxEditorTracer::Scope ofxEditorTraceScope(name, category, argName, arg)
+#else
+	#define OFXEDITOR_TRACE_SCOPE(name, category)
+	#define OFXEDITOR_TRACE_SCOPE_ARG(name, category, argName, arg)
+#endif
+
+/// records editor activity as Chrome trace events which can be loaded into
+/// chrome://tracing or https://ui.perfetto.dev to correlate editor hitches
+/// with script evaluation
+///
+/// traced: key events, text updates & parsing, script evals, file i/o, and
+/// drawing, the individual draw phases are included when OFXEDITOR_PROFILING
+/// is also defined
+///
+/// each thread records into its own fixed size buffer without locking,
+/// events are dropped when a buffer is full
+///
+/// the trace points are only compiled in when OFXEDITOR_TRACING is defined
+/// and only record between start() & stop()
+class ofxEditorTracer {
+
+	public:
+
+		/// start recording, optionally saving to a file path on exit
+		static void start(const std::string &exitPath="");
+
+		/// stop recording, recorded events are kept until cleared
+		static void stop();
+
+		/// is the tracer currently recording?
+		static bool isTracing() {
+			return s_tracing.load(std::memory_order_relaxed);
+		}
+
+		/// write the recorded events to a Chrome trace-event JSON file,
+		/// can be called while recording
+		/// returns false if the file could not be written
+		static bool save(const std::string &path);
+
+		/// clear the recorded events & free the thread buffers, call when
+		/// stopped, a thread allocates a new buffer when it next records
+		static void clear();
+
+		/// set the max number of events per thread buffer, default 262144
+		/// (~12 MB), only affects buffers created after clear() or for new
+		/// threads
+		static void setBufferSize(unsigned int size);
+		static unsigned int getBufferSize();
+
+		/// get the number of recorded events
+		static unsigned int getNumEvents();
+
+		/// get the number of events dropped due to full buffers
+		static unsigned int getNumDropped();
+
+		/// record a complete event with a start time & duration in microseconds
+		/// relative to the tracer epoch, argName is optional
+		static void complete(const char *name, const char *category,
+		                     int64_t start, int64_t duration,
+		                     const char *argName=nullptr, int64_t arg=0);
+
+		/// get the current time in microseconds since the tracer epoch
+		static int64_t now() {
+			return std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now() - s_epoch).count();
+		}
+
+		/// scoped complete event, use the OFXEDITOR_TRACE_* macros so it can
+		/// be compiled out
+		class Scope {
+			public:
+				Scope(const char *name, const char *category,
+				      const char *argName=nullptr, int64_t arg=0) :
+					name(name), category(category), argName(argName), arg(arg),
+					start(isTracing() ? now() : -1) {}
+				~Scope() {
+					if(start >= 0 && isTracing()) {
+						complete(name, category, start, now()-start, argName, arg);
+					}
+				}
+			private:
+				const char *name;
+				const char *category;
+				const char *argName;
+				int64_t arg;
+				int64_t start; //< -1 if not tracing when created
+		};
+
+	private:
+
+		static std::atomic<bool> s_tracing; //< recording?
+		static std::chrono::steady_clock::time_point s_epoch; //< time zero
+};
@@ -23,16 +23,24 @@
 #include "ofxFileDialog.h"
 
 #include "ofxEditorFont.h"
+#include "ofxEditorRenderer.h"
 #include "Unicode.h"
 
 //const unsigned int ofxFileDialog::s_fileDisplayRange = 10;
 u32string ofxFileDialog::s_saveAsText = U"Save as (esc to exit)";
 u32string ofxFileDialog::s_newFolderText = U"New Folder (esc to exit)";
 u32string ofxFileDialog::s_newFolderButtonText = U"New Folder";
+u32string ofxFileDialog::s_quickOpenText = U"Quick open (esc to exit)";
+
+// drawn after the path while loading
+static const u32string s_loadingText = U" ...";
 
 //--------------------------------------------------------------
 ofxFileDialog::ofxFileDialog() : ofxEditor() {
 	m_currentFile = 0;
+	m_numDirs = 0;
+	m_currentMatch = 0;
+	bNewQuery = false;
 	m_path = string_to_wstring(ofFilePath::getUserHomeDir());
 	m_mode = SAVEAS;
 	m_active = false;
@@ -43,6 +51,9 @@ ofxFileDialog::ofxFileDialog() : ofxEditor() {
 //--------------------------------------------------------------
 ofxFileDialog::ofxFileDialog(ofxEditorSettings &sharedSettings) : ofxEditor(sharedSettings) {
 	m_currentFile = 0;
+	m_numDirs = 0;
+	m_currentMatch = 0;
+	bNewQuery = false;
 	m_path = string_to_wstring(ofFilePath::getUserHomeDir());
 	m_mode = SAVEAS;
 	m_active = false
@@ -58,33 +69,42 @@ ofxFileDialog::~ofxFileDialog() {
 //--------------------------------------------------------------
 void ofxFileDialog::draw() {
 	if(!m_active) {return;}
+	OFXEDITOR_TRACE_SCOPE("ofxFileDialog::draw", "draw");
+	updateListing();
+	updateMatches();
 	
 	// default size if not set
 	if(m_width == 0 || m_height == 0) {
 		resize(ofGetWidth(), ofGetHeight());
 	}
 
-	ofPushStyle();
-	ofPushView();
-		ofEnableAlphaBlending(); // for fontstash
-		ofViewport(0, 0, m_width, m_height);
-		ofFill();
+	s_renderer->begin();
+		s_renderer->setViewport(0, 0, m_width, m_height);
 	
 		// font color
 		s_font->setColor(m_settings->getTextColor(), m_settings->getAlpha());
 		s_font->setShadowColor(m_settings->getTextShadowColor(), m_settings->getAlpha());
 	
 		// draw current path
-		int pathWidth = s_font->stringWidth(m_path);
-		if(pathWidth > m_visibleWidth) { // make sure right side is visible
-			s_font->drawString(m_path, m_visibleWidth-pathWidth, s_charHeight);
+		u32string path = m_path;
+		bool loading = m_lister.isListing();
+		if(m_mode == QUICKOPEN) {
+			path = string_to_wstring(m_index.getRoot());
+			loading = m_index.isIndexing() || m_index.isSearching();
 		}
-		else {
-			s_font->drawString(m_path, 0, s_charHeight);
+		int pathWidth = s_font->stringWidth(path);
+		int loadingWidth = (loading ? s_font->stringWidth(s_loadingText) : 0);
+		int x = 0;
+		if(pathWidth + loadingWidth > m_visibleWidth) { // make sure right side is visible
+			x = m_visibleWidth-pathWidth-loadingWidth;
+		}
+		s_font->drawString(path, x, s_charHeight);
+		if(loading) {
+			s_font->drawString(s_loadingText, x+pathWidth, s_charHeight);
 		}
 	
 		// indent and draw dialogs
-		ofTranslate(s_charWidth * 4, 0);
+		s_renderer->translate(s_charWidth * 4, 0);
 		switch(m_mode) {
 			case SAVEAS:
 				drawSaveAs();
@@ -95,10 +115,12 @@ void ofxFileDialog::draw() {
 			case NEWFOLDER:
 				drawNewFolder();
 				break;
+			case QUICKOPEN:
+				drawQuickOpen();
+				break;
 		}
 	
-	ofPopView();
-	ofPopStyle();
+	s_renderer->end();
 
 	// update animation timestamps
 	updateTimestamps();
@@ -127,6 +149,9 @@ void ofxFileDialog::keyPressed(int key) {
 		case NEWFOLDER:
 			keyPressedNewFolder(key);
 			break;
+		case QUICKOPEN:
+			keyPressedQuickOpen(key);
+			break;
 	}
 }
 
@@ -144,6 +169,7 @@ void ofxFileDialog::setPath(std::string path) {
 	else {
 		m_path = string_to_wstring(path);
 	}
+	m_currentFile = 0;
 	refresh();
 }
 
@@ -164,6 +190,17 @@ void ofxFileDialog::setMode(ofxFileDialog::Mode mode) {
 	if(mode == SAVEAS) {
 		m_saveAsState = FILENAME;
 	}
+	else if(mode == QUICKOPEN) {
+		clearText();
+		m_index.search(U"");
+		m_matches.clear();
+		m_currentMatch = 0;
+		bNewQuery = true;
+		std::string path = (m_quickOpenPath != "" ? m_quickOpenPath : wstring_to_string(m_path));
+		if(!m_index.setRoot(path) && !m_index.isWatching() && !m_index.isIndexing()) {
+			m_index.refresh();
+		}
+	}
 }
 
 //--------------------------------------------------------------
@@ -186,42 +223,72 @@ void ofxFileDialog::refresh() {
 	
 	ofLogVerbose("ofxFileDialog") << "loading path: " << wstring_to_string(m_path);
 	
+	// reselect the current file once listed, ie. when reopening the dialog
+	if(m_prevBasename == U"" && m_currentFile > 0 && m_currentFile < m_filenames.size()) {
+		m_prevBasename = m_filenames[m_currentFile];
+	}
+	m_currentFile = 0;
 	m_filenames.clear();
 	m_directories.clear();
-	
-	ofDirectory dir(wstring_to_string(m_path));
-	dir.listDir();
-	vector<ofFile> files = dir.getFiles();
-	ofLogVerbose("ofxFileDialog") << files.size() << " files: ";
+	m_numDirs = 0;
 	
 	// one level up
 	if(m_path != U"/") {
-		m_directories.insert(0);
+		m_directories.push_back(true);
 		m_filenames.push_back(U"..");
+		m_numDirs = 1;
 	}
-	
-	// first dirs
-	for(int i = 0; i < files.size(); ++i) {
-		if(files[i].isDirectory()) {
-			m_directories.insert(m_filenames.size());
-			m_filenames.push_back(string_to_wstring(files[i].getFileName()));
-			ofLogVerbose("ofxFileDialog") << "\t" << wstring_to_string(m_filenames.back());
-			// select previous dir
-			if(m_prevBasename != U"" && m_filenames.back() == m_prevBasename) {
-				m_currentFile = m_filenames.size()-1;
-			}
-		}
+	m_lister.list(wstring_to_string(m_path));
+}
+
+//--------------------------------------------------------------
+bool ofxFileDialog::isLoading() {
+	return m_lister.isListing();
+}
+
+//--------------------------------------------------------------
+void ofxFileDialog::setCacheSize(unsigned int size) {
+	m_lister.setCacheSize(size);
+}
+
+//--------------------------------------------------------------
+unsigned int ofxFileDialog::getCacheSize() {
+	return m_lister.getCacheSize();
+}
+
+//--------------------------------------------------------------
+bool ofxFileDialog::clearCache() {
+	return m_lister.clearCache();
+}
+
+//--------------------------------------------------------------
+void ofxFileDialog::setQuickOpenPath(std::string path) {
+	m_quickOpenPath = path;
+	if(m_index.getRoot() != "") { // already used
+		m_index.setRoot(path);
 	}
-	
-	// then files
-	for(int i = 0; i < files.size(); ++i) {
-		if(!files[i].isDirectory()) {
-			m_filenames.push_back(string_to_wstring(files[i].getFileName()));
-			ofLogVerbose("ofxFileDialog") << "\t" << wstring_to_string(m_filenames.back());
-		}
+}
+
+//--------------------------------------------------------------
+std::string ofxFileDialog::getQuickOpenPath() {
+	return m_quickOpenPath;
+}
+
+//--------------------------------------------------------------
+ofxEditor::MemoryUsage ofxFileDialog::getMemoryUsage() {
+	MemoryUsage usage = ofxEditor::getMemoryUsage();
+	usage.listing = m_filenames.capacity() * sizeof(std::u32string);
+	for(auto &filename : m_filenames) {
+		usage.listing += stringMemory(filename);
 	}
-	
-	m_prevBasename = U"";
+	usage.listing += m_directories.capacity() / 8;
+	usage.listing += m_lister.getMemoryUsage();
+	usage.listing += m_index.getMemoryUsage();
+	usage.listing += m_matches.capacity() * sizeof(std::u32string);
+	for(auto &match : m_matches) {
+		usage.listing += stringMemory(match);
+	}
+	return usage;
 }
 
 //--------------------------------------------------------------
@@ -308,6 +375,26 @@ std::string ofxFileDialog::getNewFolderButton() {
 	return wstring_to_string(s_newFolderButtonText);;
 }
 
+//--------------------------------------------------------------
+void ofxFileDialog::setQuickOpenText(const std::u32string &text) {
+	s_quickOpenText = text;
+}
+
+//--------------------------------------------------------------
+void ofxFileDialog::setQuickOpenText(const std::string &text) {
+	s_quickOpenText = string_to_wstring(text);
+}
+
+//--------------------------------------------------------------
+std::u32string& ofxFileDialog::getWideQuickOpenText() {
+	return s_quickOpenText;
+}
+
+//--------------------------------------------------------------
+std::string ofxFileDialog::getQuickOpenText() {
+	return wstring_to_string(s_quickOpenText);
+}
+
 // PROTECTED
 
 //--------------------------------------------------------------
@@ -322,8 +409,8 @@ void ofxFileDialog::drawSaveAs() {
 		drawNewFolder();
 	}
 	else {
-		ofPushMatrix();
-		ofTranslate(0, s_charHeight*2);
+		s_renderer->pushMatrix();
+		s_renderer->translate(0, s_charHeight*2);
 
 		// info text
 		s_font->drawString(s_saveAsText, x, y, s_textShadow);
@@ -348,17 +435,14 @@ void ofxFileDialog::drawSaveAs() {
 		}
 		
 		drawFilenames(5, 2, m_saveAsState == BROWSER);
-		ofPopMatrix();
+		s_renderer->popMatrix();
 		
 		y = m_height-s_charHeight;
 		if(m_saveAsState == FOLDER) {
 			int width = s_font->stringWidth(s_newFolderButtonText);
-			ofSetColor(m_settings->getCursorColor().r, m_settings->getCursorColor().g,
-							   m_settings->getCursorColor().b, m_settings->getCursorColor().a * m_settings->getAlpha());
-			ofRectMode rectMode = ofGetRectMode();
-			ofSetRectMode(OF_RECTMODE_CORNER);
-			ofDrawRectangle(x, y-s_charWidth, width, s_charHeight);
-			ofSetRectMode(rectMode);
+			ofColor color = m_settings->getCursorColor();
+			color.a *= m_settings->getAlpha();
+			s_renderer->drawRectangle(x, y-s_charWidth, width, s_charHeight, color);
 		}
 		s_font->drawString(s_newFolderButtonText, 0, y, s_textShadow);
 	}
@@ -377,7 +461,7 @@ void ofxFileDialog::drawNewFolder() {
 	s_font->setColor(m_settings->getTextColor(), m_settings->getAlpha());
 	s_font->setShadowColor(m_settings->getTextShadowColor(), m_settings->getAlpha());
 	
-	ofTranslate(0, m_visibleLines*0.5*s_charHeight);
+	s_renderer->translate(0, m_visibleLines*0.5*s_charHeight);
 
 	// info text
 	s_font->drawString(s_newFolderText, x, y, s_textShadow);
@@ -402,6 +486,37 @@ void ofxFileDialog::drawNewFolder() {
 	}
 }
 
+//--------------------------------------------------------------
+void ofxFileDialog::drawQuickOpen() {
+
+	bool drawnCursor = false;
+	int x = 0, y = s_charHeight;
+	s_font->setColor(m_settings->getTextColor(), m_settings->getAlpha());
+	s_font->setShadowColor(m_settings->getTextShadowColor(), m_settings->getAlpha());
+
+	s_renderer->pushMatrix();
+	s_renderer->translate(0, s_charHeight*2);
+
+	// info text
+	s_font->drawString(s_quickOpenText, x, y, s_textShadow);
+
+	// query with cursor
+	y += s_charHeight*2;
+	for(unsigned int i = 0; i < m_text.size(); ++i) {
+		if(i == m_position) {
+			drawCursor(x, y);
+			drawnCursor = true;
+		}
+		x = s_font->drawCharacter(m_text[i], x, y, s_textShadow);
+	}
+	if(!drawnCursor) {
+		drawCursor(x, y);
+	}
+
+	drawList(m_matches, m_currentMatch, 5, 0, true);
+	s_renderer->popMatrix();
+}
+
 //--------------------------------------------------------------
 void ofxFileDialog::keyPressedSaveAs(int key) {
 	
@@ -464,6 +579,7 @@ void ofxFileDialog::keyPressedSaveAs(int key) {
 
 //--------------------------------------------------------------
 void ofxFileDialog::keyPressedOpen(int key, bool saveAs) {
+	m_prevBasename = U""; // don't reselect after moving
 	
 	switch(key) {
 	
@@ -511,7 +627,10 @@ void ofxFileDialog::keyPressedOpen(int key, bool saveAs) {
 			break;
 
 		case OF_KEY_RETURN:
-			if(m_directories.find(m_currentFile) != m_directories.end()) {
+			if(m_currentFile >= m_filenames.size()) { // still loading
+				break;
+			}
+			if(m_directories[m_currentFile]) {
 				if(m_filenames[m_currentFile] == U"..") { // go back?
 					m_prevBasename = string_to_wstring(ofSplitString(ofFilePath::removeTrailingSlash(wstring_to_string(m_path)), "/").back());
 				}
@@ -550,12 +669,7 @@ void ofxFileDialog::keyPressedNewFolder(int key, bool saveAs) {
 			else {
 				ofLogVerbose("ofxFileDialog") << "created new folder: \"" << wstring_to_string(m_text) << "\"";
 				refresh();
-				for(int i = 0; i < m_filenames.size(); ++i) {
-					if(m_filenames[i] == m_text) {
-						m_currentFile = i;
-						break;
-					}
-				}
+				m_prevBasename = m_text; // select once listed
 				if(SAVEAS) {
 					m_saveAsState = BROWSER;
 				}
@@ -578,8 +692,64 @@ void ofxFileDialog::keyPressedNewFolder(int key, bool saveAs) {
 	}
 }
 
+//--------------------------------------------------------------
+void ofxFileDialog::keyPressedQuickOpen(int key) {
+	
+	switch(key) {
+		
+		case OF_KEY_UP:
+			if(!m_matches.empty()) {
+				m_currentMatch = (m_currentMatch == 0 ? m_matches.size()-1 : m_currentMatch-1);
+			}
+			return;
+			
+		case OF_KEY_DOWN:
+			if(!m_matches.empty()) {
+				m_currentMatch = (m_currentMatch+1) % m_matches.size();
+			}
+			return;
+			
+		case OF_KEY_PAGE_UP:
+			m_currentMatch = (m_currentMatch > 10 ? m_currentMatch-10 : 0);
+			return;
+			
+		case OF_KEY_PAGE_DOWN:
+			if(!m_matches.empty()) {
+				m_currentMatch = MIN(m_currentMatch+10, (unsigned int)m_matches.size()-1);
+			}
+			return;
+			
+		case OF_KEY_RETURN:
+			if(m_currentMatch < m_matches.size()) {
+				m_selectedPath = string_to_wstring(m_index.getRoot()) + m_matches[m_currentMatch];
+				m_active = false;
+			}
+			return;
+			
+		case OF_KEY_ESC:
+			m_active = false;
+			return;
+			
+		default: {
+			u32string text = m_text;
+			keyPressedText(key);
+			if(m_text != text) {
+				m_index.search(m_text);
+				bNewQuery = true;
+			}
+			break;
+		}
+	}
+}
+
 //--------------------------------------------------------------
 void ofxFileDialog::drawFilenames(int offset, int bottomOffset, bool highlight) {
+	drawList(m_filenames, m_currentFile, offset, bottomOffset, highlight);
+}
+
+//--------------------------------------------------------------
+void ofxFileDialog::drawList(const std::vector<std::u32string> &names, unsigned int current,
+                             int offset, int bottomOffset, bool highlight) {
 	
 	int x = 0;
 	float center = (m_height-s_charHeight*offset)*0.5;
@@ -588,54 +758,147 @@ void ofxFileDialog::drawFilenames(int offset, int bottomOffset, bool highlight)
 	int displayRange = m_visibleLines-offset;
 	
 	// center vertically
-	ofPushMatrix();
-	ofTranslate(0, m_visibleLines*0.5*s_charHeight);
-	
-	// start drawing based on current file location in file list so selection remains centered
-	float y = (m_currentFile/(float)m_filenames.size()) * -s_charHeight * (float)m_filenames.size() + s_charHeight;
-	unsigned int count = 0;
-	for(vector<u32string>::iterator i = m_filenames.begin(); i != m_filenames.end(); i++) {
-	
-		m_numLines = 0;
-		bool isDir = m_directories.find(count) != m_directories.end();
+	s_renderer->pushMatrix();
+	s_renderer->translate(0, m_visibleLines*0.5*s_charHeight);
+	
+	// start drawing based on current name location in the list so selection
+	// remains centered, only the files within the display range are visited
+	int first = MAX(0, (int)current - displayRange + 1);
+	int last = MIN((int)names.size(), (int)current + displayRange);
+	float y = (first - (int)current + 1) * s_charHeight;
+	m_numLines = 0;
+	for(int i = first; i < last; ++i, y += s_charHeight) {
 		
+		// don't draw beyond bottom
+		if(y > bottom) {
+			break;
+		}
+	
 		// don't draw on top of path
 		if(y < top) {
-			y += s_charHeight;
-			count++;
 			continue;
 		}
 		
-		// only show numbers in the display range
-		if(((int)count > ((int)m_currentFile - (int)displayRange)) &&
-		   ((int)count < ((int)m_currentFile + (int)displayRange))) {
-			
-			for(int c = 0; c < i->size(); ++c) {
+		const u32string &filename = names[i];
+		for(int c = 0; c < filename.size(); ++c) {
+		
+			// current file background
+			if(highlight && i == (int)current) {
+				ofColor color = m_settings->getCursorColor();
+				color.a *= m_settings->getAlpha();
+				s_renderer->drawRectangle(x, y-s_charHeight, characterWidth(filename[c]), s_charHeight, color);
+			}
 			
-				// current file background
-				if(highlight && count == m_currentFile) {
-					ofSetColor(m_settings->getCursorColor().r, m_settings->getCursorColor().g,
-					       m_settings->getCursorColor().b, m_settings->getCursorColor().a * m_settings->getAlpha());
-					ofRectMode rectMode = ofGetRectMode();
-					ofSetRectMode(OF_RECTMODE_CORNER);
-					ofDrawRectangle(x, y-s_charHeight, characterWidth((*i)[c]), s_charHeight);
-					ofSetRectMode(rectMode);
-				}
-				
-				// file or dir name
-				x = s_font->drawCharacter((*i)[c], x, y, s_textShadow);
+			// file or dir name
+			x = s_font->drawCharacter(filename[c], x, y, s_textShadow);
+		}
+		x = 0;
+	}
+	s_renderer->popMatrix();
+}
+
+//--------------------------------------------------------------
+void ofxFileDialog::updateListing() {
+	ofxEditorDirLister::Result result = m_lister.pop(m_listed);
+	if(result == ofxEditorDirLister::NONE) {
+		return;
+	}
+	
+	// replace the partial list with the sorted list & keep the selection
+	if(result == ofxEditorDirLister::DONE) {
+		u32string selected = m_prevBasename;
+		if(selected == U"" && m_currentFile < m_filenames.size()) {
+			selected = m_filenames[m_currentFile];
+		}
+		unsigned int first = (m_path != U"/" ? 1 : 0); // keep ..
+		m_filenames.resize(first);
+		m_directories.resize(first);
+		m_numDirs = first;
+		m_filenames.reserve(first + m_listed.size());
+		m_directories.reserve(first + m_listed.size());
+		for(auto &entry : m_listed) {
+			if(entry.directory) {
+				m_numDirs++;
 			}
-			x = 0;
+			m_directories.push_back(entry.directory);
+			m_filenames.push_back(std::move(entry.name));
 		}
-		y += s_charHeight;
-		count++;
-		
-		// don't draw beyond bottom
-		if(y > bottom) {
-			break;
+		m_currentFile = 0;
+		for(unsigned int i = 0; i < m_filenames.size(); ++i) {
+			if(m_filenames[i] == selected) {
+				m_currentFile = i;
+				break;
+			}
+		}
+		m_prevBasename = U"";
+		m_listed.clear();
+		ofLogVerbose("ofxFileDialog") << m_filenames.size() - first << " files";
+		return;
+	}
+	
+	// new dirs go after the listed dirs, new files at the end
+	unsigned int numDirs = 0;
+	for(auto &entry : m_listed) {
+		if(entry.directory) {
+			numDirs++;
+		}
+	}
+	if(numDirs > 0) {
+		m_filenames.insert(m_filenames.begin()+m_numDirs, numDirs, U"");
+		m_directories.insert(m_directories.begin()+m_numDirs, numDirs, true);
+		if(m_currentFile >= m_numDirs && m_currentFile < m_filenames.size()-numDirs) {
+			m_currentFile += numDirs; // keep the selected file
+		}
+	}
+	unsigned int dir = m_numDirs;
+	for(auto &entry : m_listed) {
+		unsigned int index = (entry.directory ? dir++ : m_filenames.size());
+		if(m_prevBasename != U"" && entry.name == m_prevBasename) {
+			m_currentFile = index; // select previous file or dir
+		}
+		if(entry.directory) {
+			m_filenames[index] = std::move(entry.name);
+		}
+		else {
+			m_directories.push_back(false);
+			m_filenames.push_back(std::move(entry.name));
+		}
+	}
+	m_numDirs += numDirs;
+	m_listed.clear();
+}
+
+//--------------------------------------------------------------
+void ofxFileDialog::updateMatches() {
+	if(!m_index.getResults(m_results)) {
+		return;
+	}
+	u32string selected;
+	if(m_currentMatch < m_matches.size()) {
+		selected.swap(m_matches[m_currentMatch]);
+	}
+	m_matches.clear();
+	for(auto &result : m_results) {
+		m_matches.push_back(std::move(result.path));
+	}
+	m_results.clear();
+	
+	// searches rerun as the index changes, so keep the selected match unless
+	// the query changed
+	if(bNewQuery) {
+		m_currentMatch = 0;
+		bNewQuery = false;
+	}
+	else {
+		unsigned int current = 0;
+		for(unsigned int i = 0; i < m_matches.size(); ++i) {
+			if(m_matches[i] == selected) {
+				current = i;
+				break;
+			}
 		}
+		m_currentMatch = current;
 	}
-	ofPopMatrix();
 }
 
 //--------------------------------------------------------------
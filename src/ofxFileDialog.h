@@ -23,6 +23,8 @@
 #pragma once
 
 #include "ofxEditor.h"
+#include "ofxEditorDirLister.h"
+#include "ofxEditorFileIndex.h"
 
 /// key events
 ///
@@ -30,6 +32,9 @@
 /// RETURN: open/save file
 /// ESC: exit file dialog
 ///
+/// in quick open mode, typing fuzzy searches every file under the quick open
+/// path & ARROWS select a match
+///
 class ofxFileDialog : public ofxEditor {
 
 	public:
@@ -38,7 +43,8 @@ class ofxFileDialog : public ofxEditor {
 		enum Mode {
 			OPEN,
 			SAVEAS,
-			NEWFOLDER
+			NEWFOLDER,
+			QUICKOPEN
 		};
 
 		ofxFileDialog();
@@ -60,7 +66,35 @@ class ofxFileDialog : public ofxEditor {
 		void setPath(std::string path);
 
 		/// refresh directory contents
+		///
+		/// the directory is listed on a worker thread & the entries are
+		/// added as they arrive while drawing, the partial list can be
+		/// navigated & the complete list is sorted once finished
 		void refresh();
+	
+		/// returns true while the directory contents are loading
+		bool isLoading();
+	
+		/// set/get the max number of cached directory listings, 0 to disable,
+		/// default 16
+		///
+		/// reopening a cached directory is instant, cached listings are
+		/// invalidated when the directory changes
+		void setCacheSize(unsigned int size);
+		unsigned int getCacheSize();
+	
+		/// remove all cached directory listings, returns false if there were none
+		bool clearCache();
+	
+		/// set/get the quick open path, every file under it is indexed on a
+		/// worker thread when quick open is first used, the current path is
+		/// used if not set
+		void setQuickOpenPath(std::string path);
+		std::string getQuickOpenPath();
+	
+		/// get the memory used by the dialog, the directory contents,
+		/// cached listings, & quick open index are counted as listing
+		MemoryUsage getMemoryUsage();
 
 		/// get the currently selected path
 		string getSelectedPath();
@@ -69,6 +103,9 @@ class ofxFileDialog : public ofxEditor {
 		void clearSelectedPath();
 	
 		/// set the current mode, sets active to true
+		///
+		/// QUICKOPEN clears the text & starts indexing the quick open path if
+		/// needed, it's rescanned each time when changes can't be watched
 		void setMode(Mode mode);
 	
 		/// get current mode
@@ -105,39 +142,69 @@ class ofxFileDialog : public ofxEditor {
 		static void setNewFolderButton(const std::string &text);
 		static std::u32string& getWideNewFolderButton();
 		static std::string getNewFolderButton();
+	
+		/// set/get the quick open info text, default: "Quick open (esc to exit)"
+		static void setQuickOpenText(const std::u32string &text);
+		static void setQuickOpenText(const std::string &text);
+		static std::u32string& getWideQuickOpenText();
+		static std::string getQuickOpenText();
 
 	protected:
 
 		void drawSaveAs();
 		void drawOpen();
 		void drawNewFolder();
+		void drawQuickOpen();
 		void keyPressedSaveAs(int key);
 		void keyPressedOpen(int key, bool saveAs=false);
 		void keyPressedNewFolder(int key, bool saveAs=false);
+		void keyPressedQuickOpen(int key);
 	
 		/// draw filenames & directory list centered on the current file
 		/// topOffset = num vert chars from top constraint
 		/// bottomOffset = num vert chars from bottom constraint
 		/// highlight = highlight current file?
 		void drawFilenames(int topOffset=2, int bottomOffset=0, bool highlight=true);
+	
+		/// draw a list of names centered on the current name, see drawFilenames()
+		void drawList(const std::vector<std::u32string> &names, unsigned int current,
+		              int topOffset, int bottomOffset, bool highlight);
 
 		/// handle text input into the buffer
 		void keyPressedText(int key);
+	
+		/// add the directory entries listed since the last call
+		void updateListing();
+	
+		/// replace the quick open matches with new search results
+		void updateMatches();
 
 		Mode m_mode; //< current dialog mode
 		bool m_active; //< is the dialog active?
 	
 		unsigned int m_currentFile;    //< index of the current file
 		std::vector<std::u32string> m_filenames; //< filenames & directories
-		std::set<int> m_directories;        //< which indexes are directories
+		std::vector<bool> m_directories;    //< is each filename a directory? packed bits
+		unsigned int m_numDirs;             //< number of directories, listed first
 		std::u32string m_path;              //< current path
 		std::u32string m_selectedPath;      //< selected path on enter
-		std::u32string m_prevBasename;      //< previous path basename
+		std::u32string m_prevBasename;      //< previous path basename, selected when listed
+	
+		ofxEditorDirLister m_lister; //< background directory lister
+		std::vector<ofxEditorDirLister::Entry> m_listed; //< listed entries buffer
+	
+		std::string m_quickOpenPath; //< quick open path
+		ofxEditorFileIndex m_index; //< quick open file index
+		std::vector<ofxEditorFileIndex::Match> m_results; //< search results buffer
+		std::vector<std::u32string> m_matches; //< quick open matching paths
+		unsigned int m_currentMatch; //< index of the current match
+		bool bNewQuery; //< has the query changed since the last results?
 	
 		/// number of files to show above and below open file cursor
 		static std::u32string s_saveAsText; //< save as info text
 		static std::u32string s_newFolderText; //< new folder info text
 		static std::u32string s_newFolderButtonText; //< save as new folder "button"
+		static std::u32string s_quickOpenText; //< quick open info text
 	
 		/// save as dialog states
 		enum SaveAsState {
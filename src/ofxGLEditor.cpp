@@ -19,15 +19,37 @@
  */
 #include "ofxGLEditor.h"
 
+// how often the memory soft limit is checked in ms
+#define MEMORY_CHECK_INTERVAL 1000
+
+// min time between memory soft limit warnings in ms
+#define MEMORY_WARNING_INTERVAL 10000
+
+// undo actions the current editor keeps when trimming to the memory soft limit
+#define MEMORY_MIN_UNDO 4
+
 //--------------------------------------------------------------
 ofxGLEditor::ofxGLEditor() {
 	m_listener = NULL;
 	m_fileDialog = NULL;
 	m_saveFiles.resize(s_numEditors);
+	m_saveErrors.resize(s_numEditors);
 	m_currentEditor = 0;
+	bFileReloading = true;
 	bModifierPressed = false;
 	bHideEditor = false;
 	bFlashEvalSelection = false;
+	m_memorySoftLimit = 0;
+	m_memoryCheckTime = 0;
+	m_memoryTrimmedUsage = 0;
+	m_memoryWarningTime = 0;
+	m_memoryTrimmedBytes = 0;
+	bKeyRecording = false;
+	bKeyReplaying = false;
+	m_replayPos = 0;
+	m_replayRate = 20;
+	m_replayStart = 0;
+	m_evalQueue = std::make_shared<ofxEditorEvalQueue>();
 }
 
 //--------------------------------------------------------------
@@ -49,6 +71,7 @@ void ofxGLEditor::setup(ofxGLEditorListener *listener, bool enableRepl) {
 	if(enableRepl) {
 		ofxRepl *repl = new ofxRepl(m_settings);
 		repl->setup(listener);
+		repl->setEvalQueue(m_evalQueue);
 		m_editors.push_back(repl);
 	}
 	else {
@@ -61,6 +84,7 @@ void ofxGLEditor::setup(ofxGLEditorListener *listener, bool enableRepl) {
 	
 	m_fileDialog = new ofxFileDialog(m_settings);
 	m_fileDialog->setPath(ofToDataPath(""));
+	m_fileDialog->setQuickOpenPath(ofToDataPath(""));
 	
 	resize();
 	setAutoFocus(true);
@@ -76,6 +100,11 @@ void ofxGLEditor::clear() {
 			delete m_editors[i];
 	}
 	m_editors.clear();
+	for(auto &file : m_saveFiles) {
+		file = "";
+	}
+	m_fileWatcher.clear();
+	m_pendingSaves.clear(); // still written but not reported
 	if(m_fileDialog != NULL) {
 		delete m_fileDialog;
 	}
@@ -83,6 +112,25 @@ void ofxGLEditor::clear() {
 
 //--------------------------------------------------------------
 void ofxGLEditor::draw() {
+	OFXEDITOR_TRACE_SCOPE("ofxGLEditor::draw", "draw");
+	if(bKeyReplaying) {
+		updateKeyReplay();
+	}
+	if(m_memorySoftLimit > 0) {
+		checkMemorySoftLimit();
+	}
+	updateSaves();
+	if(bFileReloading) {
+		updateFileReloads();
+	}
+	if(m_editors[0]) { // print log messages & output while the repl is hidden too
+		((ofxRepl*) m_editors[0])->flushLog();
+		((ofxRepl*) m_editors[0])->flushEval();
+		((ofxRepl*) m_editors[0])->flushOutput();
+	}
+	else {
+		updateEvalQueue();
+	}
 	ofPushView();
 	ofPushMatrix();
 	ofPushStyle();
@@ -123,10 +171,16 @@ void ofxGLEditor::draw() {
 
 //--------------------------------------------------------------
 void ofxGLEditor::keyPressed(int key) {
+	OFXEDITOR_TRACE_SCOPE_ARG("ofxGLEditor::keyPressed", "input", "key", key);
+	ofxEditor::markKeyPressed(key);
 
 	// check modifier keys
 	bModifierPressed = ofxEditor::getSuperAsModifier() ? ofGetKeyPressed(OF_KEY_SUPER) : ofGetKeyPressed(OF_KEY_CONTROL);
 	
+	if(bKeyRecording && !bKeyReplaying && !bModifierPressed) {
+		m_keyRecording.push_back(key);
+	}
+	
 	// also check for ascii control chars: http://ascii-table.com/control-chars.php
 	if(bModifierPressed) {
 		switch(key) {
@@ -136,9 +190,19 @@ void ofxGLEditor::keyPressed(int key) {
 					if(bFlashEvalSelection && m_editors[m_currentEditor]->isSelection()) {
 						m_editors[m_currentEditor]->flashSelection();
 					}
-					string script = getText();
 					if(m_listener) {
-						m_listener->executeScriptEvent(m_currentEditor);
+						ofxEditorEvalQueue::Executor executor = m_listener->getEvalExecutor();
+						if(executor == ofxEditorEvalQueue::SYNC) {
+							OFXEDITOR_TRACE_SCOPE_ARG("executeScriptEvent", "eval", "editor", m_currentEditor);
+							m_listener->executeScriptTextEvent(m_currentEditor, getText());
+						}
+						else {
+							ofxGLEditorListener *listener = m_listener;
+							m_evalQueue->push(m_currentEditor, getText(), executor,
+								[listener](const ofxEditorEvalQueue::Request &request) {
+									listener->executeScriptTextEvent(request.editor, request.text);
+								}, true);
+						}
 					}
 				}
 				return;
@@ -147,6 +211,10 @@ void ofxGLEditor::keyPressed(int key) {
 				bHideEditor = !bHideEditor;
 				return;
 			
+			case '.':
+				cancelEval();
+				return;
+			
 			case 's': case 19:
 				if(m_currentEditor != 0) {
 					// show save as dialog on empty name
@@ -154,11 +222,7 @@ void ofxGLEditor::keyPressed(int key) {
 						m_fileDialog->setMode(ofxFileDialog::SAVEAS);
 					}
 					else {
-						if(saveFile(m_saveFiles[m_currentEditor])) {
-							if(m_listener) {
-								m_listener->saveFileEvent(m_currentEditor);
-							}
-						}
+						saveFile(m_saveFiles[m_currentEditor]);
 					}
 				}
 				return;
@@ -174,6 +238,15 @@ void ofxGLEditor::keyPressed(int key) {
 					m_fileDialog->setMode(ofxFileDialog::OPEN);
 					m_fileDialog->refresh();
 				}
+				else {
+					expandReplOutput();
+				}
+				return;
+				
+			case 'p': case 16:
+				if(m_currentEditor != 0) {
+					m_fileDialog->setMode(ofxFileDialog::QUICKOPEN);
+				}
 				return;
 				
 			case '-':
@@ -184,7 +257,12 @@ void ofxGLEditor::keyPressed(int key) {
 				m_settings.setAlpha(m_settings.getAlpha()+0.05);
 				return;
 				
-			case 'r': case '0': case 18: // Repl
+			case 'r': case 18: // Repl, reverse history search when in the Repl
+				if(m_currentEditor == 0) {
+					break;
+				}
+				// fallthrough
+			case '0':
 				if(m_editors[0]) {
 					m_currentEditor = 0;
 				}
@@ -209,16 +287,11 @@ void ofxGLEditor::keyPressed(int key) {
 		m_fileDialog->keyPressed(key);
 		if(m_fileDialog->getSelectedPath() != "") {
 			if(m_fileDialog->getMode() == ofxFileDialog::SAVEAS) {
-				m_saveFiles[m_currentEditor] = m_fileDialog->getSelectedPath();
-				if(saveFile(m_saveFiles[m_currentEditor])) {
-					if(m_listener) {
-						m_listener->saveFileEvent(m_currentEditor);
-					}
-				}
+				setSaveFile(m_currentEditor, m_fileDialog->getSelectedPath());
+				saveFile(m_saveFiles[m_currentEditor]);
 			}
 			else {
 				if(openFile(m_fileDialog->getSelectedPath())) {
-					m_saveFiles[m_currentEditor] = m_fileDialog->getSelectedPath();
 					if(m_listener) {
 						m_listener->openFileEvent(m_currentEditor);
 					}
@@ -268,7 +341,8 @@ bool ofxGLEditor::openFile(std::string filename, int editor) {
 		<< "\" into editor " << editor;
 	bool ret = m_editors[editor]->openFile(filename);
 	if(ret) {
-		m_saveFiles[editor] = ofToDataPath(filename);
+		m_editors[editor]->setReadOnly(false);
+		setSaveFile(editor, ofToDataPath(filename));
 	}
 	return ret;
 }
@@ -291,11 +365,11 @@ bool ofxGLEditor::saveFile(std::string filename, int editor) {
 	
 	ofLogVerbose("ofxGLEditor") << "saving editor " << editor
 		<< " to \"" << ofFilePath::getFileName(filename) << "\"";
-	bool ret = m_editors[editor]->saveFile(filename);
-	if(ret) {
-		m_saveFiles[editor] = ofToDataPath(filename);
-	}
-	return ret;
+	m_editors[editor]->updateFileSyntax(filename);
+	setSaveFile(editor, ofToDataPath(filename));
+	unsigned int id = m_fileSaver.save(m_saveFiles[editor], m_editors[editor]->getWideText());
+	m_pendingSaves[id] = editor;
+	return true;
 }
 
 //--------------------------------------------------------------
@@ -369,14 +443,16 @@ void ofxGLEditor::clearText(int editor) {
 	 // reset filename
 	ofLogVerbose("ofxGLEditor") << "cleared text in editor" << m_currentEditor;
 	m_editors[editor]->clearText();
-	m_saveFiles[editor] = "";
+	m_editors[editor]->setReadOnly(false);
+	setSaveFile(editor, "");
 }
 
 //--------------------------------------------------------------
 void ofxGLEditor::clearAllText() {
 	for(int i = 1; i < (int) m_editors.size(); i++) {
 		m_editors[i]->clearText();
-		m_saveFiles[i] = "";
+		m_editors[i]->setReadOnly(false);
+		setSaveFile(i, "");
 	}
 	ofLogVerbose("ofxGLEditor") << "cleared text in all editors";
 }
@@ -412,7 +488,7 @@ void ofxGLEditor::setEditorFilename(int editor, std::string filename) {
 	ofLogVerbose("ofxGLEditor") << "setting filename for editor " << editor
 		<< " to \"" << ofFilePath::getFileName(filename) << "\"";
 
-	m_saveFiles[editor] = ofToDataPath(filename);
+	setSaveFile(editor, ofToDataPath(filename));
 }
 	
 //--------------------------------------------------------------
@@ -427,6 +503,16 @@ std::string ofxGLEditor::getEditorFilename(int editor) {
 	return m_saveFiles[editor];
 }
 
+//--------------------------------------------------------------
+std::string ofxGLEditor::getSaveFileError(int editor) {
+	editor = getEditorIndex(editor);
+	if(editor == -1) {
+		ofLogError("ofxGLEditor") << "cannot get save error for unknown editor " << editor;
+		return "";
+	}
+	return m_saveErrors[editor];
+}
+
 //--------------------------------------------------------------
 bool ofxGLEditor::isSelection(int editor) {
 	editor = getEditorIndex(editor);
@@ -506,10 +592,10 @@ unsigned int ofxGLEditor::getCurrentPos(int editor) {
 }
 
 //--------------------------------------------------------------
-void ofxGLEditor::evalReplReturn(const string &text) {
+void ofxGLEditor::evalReplReturn(const string &text, unsigned int id) {
 	if(m_editors[0]) {
 		ofxRepl *repl = (ofxRepl*) m_editors[0];
-		repl->printEvalReturn(text);
+		repl->printEvalReturn(text, id);
 	}
 }
 
@@ -531,15 +617,126 @@ void ofxGLEditor::clearReplHistory() {
 	}
 }
 
+//--------------------------------------------------------------
+bool ofxGLEditor::setReplHistoryFile(const std::string &path) {
+	if(m_editors[0]) {
+		ofxRepl *repl = (ofxRepl*) m_editors[0];
+		return repl->setHistoryFile(path);
+	}
+	return false;
+}
+
+//--------------------------------------------------------------
+void ofxGLEditor::setReplOutputBudget(unsigned int linesPerFrame, unsigned int linesPerSecond) {
+	if(m_editors[0]) {
+		ofxRepl *repl = (ofxRepl*) m_editors[0];
+		repl->setMaxOutputLinesPerFrame(linesPerFrame);
+		repl->setMaxOutputLinesPerSecond(linesPerSecond);
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxGLEditor::setReplOutputSpillFile(const std::string &path) {
+	if(m_editors[0]) {
+		ofxRepl *repl = (ofxRepl*) m_editors[0];
+		return repl->setOutputSpillFile(path);
+	}
+	return false;
+}
+
+//--------------------------------------------------------------
+void ofxGLEditor::setReplMaxInlineOutput(unsigned int lines, size_t chars) {
+	if(m_editors[0]) {
+		ofxRepl *repl = (ofxRepl*) m_editors[0];
+		repl->setMaxInlineOutput(lines, chars);
+	}
+}
+
+//--------------------------------------------------------------
+int ofxGLEditor::expandReplOutput(unsigned int id) {
+	if(!m_editors[0]) {
+		return -1;
+	}
+	ofxRepl *repl = (ofxRepl*) m_editors[0];
+	if(id == 0) {
+		id = repl->getStoredOutputId();
+	}
+	std::u32string text;
+	if(!repl->getStoredOutput(id, text)) {
+		ofLogWarning("ofxGLEditor") << "repl output " << id << " not found";
+		return -1;
+	}
+	for(int i = 1; i < (int) m_editors.size(); i++) {
+		if(m_saveFiles[i] == "" && m_editors[i]->getNumLines() == 0 && m_editors[i]->getWideText().empty()) {
+			ofLogVerbose("ofxGLEditor") << "expanding repl output " << id << " into editor " << i;
+			m_editors[i]->setSyntax(repl->getSyntax());
+			m_editors[i]->setText(text);
+			m_editors[i]->setReadOnly(true);
+			m_editors[i]->setCurrentPos(0);
+			m_currentEditor = i;
+			return i;
+		}
+	}
+	ofLogWarning("ofxGLEditor") << "no empty editor to expand repl output " << id << " into";
+	return -1;
+}
+
+//--------------------------------------------------------------
+void ofxGLEditor::cancelEval() {
+	m_evalQueue->cancelAll();
+}
+
+//--------------------------------------------------------------
+bool ofxGLEditor::isEvalBusy() {
+	return m_evalQueue->isBusy();
+}
+
+//--------------------------------------------------------------
+void ofxGLEditor::setEvalTimeout(float seconds) {
+	m_evalQueue->setTimeout(seconds);
+}
+
+//--------------------------------------------------------------
+float ofxGLEditor::getEvalTimeout() {
+	return m_evalQueue->getTimeout();
+}
+
 //--------------------------------------------------------------
 void ofxGLEditor::setPath(std::string path) {
 	// make sure there is a trailing /
 	m_fileDialog->setPath(ofFilePath::addTrailingSlash(path));
+	m_fileDialog->setQuickOpenPath(path);
 	if(m_fileDialog->isActive()) {
 		m_fileDialog->refresh();
 	}
 }
 
+//--------------------------------------------------------------
+void ofxGLEditor::setFileDialogCacheSize(unsigned int size) {
+	m_fileDialog->setCacheSize(size);
+}
+
+//--------------------------------------------------------------
+void ofxGLEditor::setFileReloading(bool reload) {
+	if(reload == bFileReloading) {
+		return;
+	}
+	bFileReloading = reload;
+	if(bFileReloading) {
+		for(auto &file : m_saveFiles) {
+			m_fileWatcher.watch(file);
+		}
+	}
+	else {
+		m_fileWatcher.clear();
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxGLEditor::getFileReloading() {
+	return bFileReloading;
+}
+
 //--------------------------------------------------------------
 void ofxGLEditor::setHidden(bool hidden) {
 	bHideEditor = !bHideEditor;
@@ -555,6 +752,139 @@ void ofxGLEditor::drawString(const std::string& s, ofPoint& p) {
 	drawString(s, p.x, p.y);
 }
 
+// MEMORY
+
+//--------------------------------------------------------------
+ofxEditor::MemoryUsage ofxGLEditor::getMemoryUsage() {
+	ofxEditor::MemoryUsage usage;
+	for(int i = 0; i < (int) m_editors.size(); i++) {
+		if(m_editors[i]) usage += m_editors[i]->getMemoryUsage();
+	}
+	if(m_fileDialog) {
+		usage += m_fileDialog->getMemoryUsage();
+	}
+	usage.text += m_fileSaver.getMemoryUsage();
+	usage.atlas += ofxEditor::getFontMemoryUsage();
+	return usage;
+}
+
+//--------------------------------------------------------------
+ofxEditor::MemoryUsage ofxGLEditor::getEditorMemoryUsage(int editor) {
+	editor = getEditorIndex(editor);
+	if(editor < 0 || !m_editors[editor]) {
+		ofLogError("ofxGLEditor") << "cannot get memory usage from unknown editor " << editor;
+		return ofxEditor::MemoryUsage();
+	}
+	return m_editors[editor]->getMemoryUsage();
+}
+
+//--------------------------------------------------------------
+void ofxGLEditor::setMemorySoftLimit(size_t bytes) {
+	m_memorySoftLimit = bytes;
+	m_memoryCheckTime = 0; // check on the next draw
+	m_memoryTrimmedUsage = 0;
+}
+
+//--------------------------------------------------------------
+size_t ofxGLEditor::getMemorySoftLimit() {
+	return m_memorySoftLimit;
+}
+
+// PROFILING
+
+//--------------------------------------------------------------
+ofxEditorProfiler::Stats ofxGLEditor::getKeyLatency(int editor) {
+	editor = getEditorIndex(editor);
+	if(editor < 0 || !m_editors[editor]) {
+		ofLogError("ofxGLEditor") << "cannot get key latency from unknown editor " << editor;
+		return ofxEditorProfiler::Stats();
+	}
+	return m_editors[editor]->getKeyLatency();
+}
+
+//--------------------------------------------------------------
+void ofxGLEditor::drawProfiler(float x, float y) {
+	ofxEditor::drawProfiler(x, y, m_editors[m_currentEditor]);
+}
+
+//--------------------------------------------------------------
+void ofxGLEditor::startKeyRecording() {
+	m_keyRecording.clear();
+	bKeyRecording = true;
+}
+
+//--------------------------------------------------------------
+void ofxGLEditor::stopKeyRecording() {
+	bKeyRecording = false;
+}
+
+//--------------------------------------------------------------
+bool ofxGLEditor::isKeyRecording() {
+	return bKeyRecording;
+}
+
+//--------------------------------------------------------------
+const std::vector<int>& ofxGLEditor::getKeyRecording() {
+	return m_keyRecording;
+}
+
+//--------------------------------------------------------------
+void ofxGLEditor::replayKeys(const std::vector<int> &keys, float rate) {
+	if(rate <= 0) {
+		ofLogError("ofxGLEditor") << "cannot replay keys at rate " << rate;
+		return;
+	}
+	m_replayKeys = keys;
+	m_replayPos = 0;
+	m_replayRate = rate;
+	m_replayStart = ofGetElapsedTimeMicros();
+	bKeyReplaying = !keys.empty();
+}
+
+//--------------------------------------------------------------
+void ofxGLEditor::stopKeyReplay() {
+	bKeyReplaying = false;
+	m_replayKeys.clear();
+	m_replayPos = 0;
+}
+
+//--------------------------------------------------------------
+bool ofxGLEditor::isKeyReplaying() {
+	return bKeyReplaying;
+}
+
+//--------------------------------------------------------------
+bool ofxGLEditor::saveKeys(const std::string &filename, const std::vector<int> &keys) {
+	ofFile file;
+	if(!file.open(ofToDataPath(filename), ofFile::WriteOnly)) {
+		ofLogError("ofxGLEditor") << "couldn't save keys to \""
+			<< ofFilePath::getFileName(filename) << "\"";
+		return false;
+	}
+	for(int i = 0; i < keys.size(); ++i) {
+		file << keys[i] << "\n";
+	}
+	file.close();
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ofxGLEditor::loadKeys(const std::string &filename, std::vector<int> &keys) {
+	ofFile file;
+	if(!file.open(ofToDataPath(filename), ofFile::ReadOnly)) {
+		ofLogError("ofxGLEditor") << "couldn't load keys from \""
+			<< ofFilePath::getFileName(filename) << "\"";
+		return false;
+	}
+	keys.clear();
+	int key;
+	while(file >> key) {
+		keys.push_back(key);
+	}
+	file.close();
+	return true;
+}
+
 // SETTINGS
 
 //--------------------------------------------------------------
@@ -673,3 +1003,160 @@ int ofxGLEditor::getEditorIndex(int editor) {
 	}
 	return editor;
 }
+
+//--------------------------------------------------------------
+void ofxGLEditor::setSaveFile(int editor, const std::string &path) {
+	if(path == m_saveFiles[editor]) {
+		return;
+	}
+	if(bFileReloading) {
+		m_fileWatcher.unwatch(m_saveFiles[editor]);
+		m_fileWatcher.watch(path);
+	}
+	m_saveFiles[editor] = path;
+}
+
+//--------------------------------------------------------------
+void ofxGLEditor::updateSaves() {
+	std::vector<ofxEditorFileSaver::Result> results;
+	if(!m_fileSaver.pop(results)) {
+		return;
+	}
+	for(auto &result : results) {
+		auto iter = m_pendingSaves.find(result.id);
+		if(iter == m_pendingSaves.end()) {
+			continue;
+		}
+		int editor = iter->second;
+		m_pendingSaves.erase(iter);
+		m_saveErrors[editor] = result.error;
+		if(result.error == "") {
+			m_fileWatcher.update(result.path); // don't reload our own save
+		}
+		if(m_listener) {
+			m_listener->saveFileEvent(editor);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofxGLEditor::updateFileReloads() {
+	std::vector<ofxEditorFileWatcher::Change> changes;
+	if(!m_fileWatcher.pop(changes)) {
+		return;
+	}
+	for(auto &change : changes) {
+		if(m_fileSaver.isSaving(change.path)) {
+			continue; // our own save, not finished yet
+		}
+		for(int i = 1; i < (int) m_editors.size(); i++) {
+			if(m_saveFiles[i] != change.path) {
+				continue;
+			}
+			ofLogVerbose("ofxGLEditor") << "reloading \"" << ofFilePath::getFileName(change.path)
+				<< "\" into editor " << i;
+			m_editors[i]->reloadText(change.text);
+			if(m_listener) {
+				m_listener->reloadFileEvent(i);
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofxGLEditor::updateEvalQueue() {
+	m_evalQueue->update();
+	ofxEditorEvalQueue::Result result;
+	while(m_evalQueue->pop(result)) {
+		switch(result.status) {
+			case ofxEditorEvalQueue::CANCELLED:
+				ofLogWarning("ofxGLEditor") << "script " << result.id << " cancelled";
+				break;
+			case ofxEditorEvalQueue::TIMED_OUT:
+				ofLogWarning("ofxGLEditor") << "script " << result.id << " timed out after "
+					<< ofToString(result.seconds, 1) << "s";
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofxGLEditor::checkMemorySoftLimit() {
+	
+	// summing the usage walks all undo & history strings, so sample it
+	uint64_t now = ofGetElapsedTimeMillis();
+	if(m_memoryCheckTime > 0 && now - m_memoryCheckTime < MEMORY_CHECK_INTERVAL) {
+		return;
+	}
+	m_memoryCheckTime = now;
+	size_t before = getMemoryUsage().total();
+	if(before <= m_memorySoftLimit) {
+		m_memoryTrimmedUsage = 0;
+		return;
+	}
+	
+	// trimmed before & still over, what's left can't be trimmed further
+	// so wait until usage grows again
+	if(m_memoryTrimmedUsage > 0 && before <= m_memoryTrimmedUsage) {
+		return;
+	}
+	size_t total = before;
+	
+	// cached directory listings first, they are listed again when needed
+	if(m_fileDialog && m_fileDialog->clearCache()) {
+		total = getMemoryUsage().total();
+	}
+	
+	// then repl scrollback, history, & stored outputs
+	if(total > m_memorySoftLimit && m_editors[0] &&
+	   ((ofxRepl*) m_editors[0])->trimScrollback()) {
+		total = getMemoryUsage().total();
+	}
+	
+	// undo history last as it can't be rebuilt & may hold edits replaced by a
+	// file reload, oldest half per pass, the current editor keeps its most
+	// recent actions
+	bool trimmed = true;
+	while(total > m_memorySoftLimit && trimmed) {
+		trimmed = false;
+		for(int i = 0; i < (int) m_editors.size(); i++) {
+			if(!m_editors[i]) {
+				continue;
+			}
+			unsigned int num = m_editors[i]->getNumUndoActions();
+			unsigned int keep = (i == m_currentEditor ? MEMORY_MIN_UNDO : 0);
+			if(num > keep) {
+				m_editors[i]->trimUndo(MAX(num/2, keep));
+				trimmed = true;
+			}
+		}
+		if(trimmed) {
+			total = getMemoryUsage().total();
+		}
+	}
+	m_memoryTrimmedUsage = total;
+	
+	if(total < before) {
+		m_memoryTrimmedBytes += before - total;
+		if(m_memoryWarningTime == 0 || now - m_memoryWarningTime >= MEMORY_WARNING_INTERVAL) {
+			ofLogWarning("ofxGLEditor") << "memory soft limit of " << m_memorySoftLimit
+				<< " bytes exceeded, trimmed " << m_memoryTrimmedBytes << " bytes";
+			m_memoryWarningTime = now;
+			m_memoryTrimmedBytes = 0;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofxGLEditor::updateKeyReplay() {
+	uint64_t elapsed = ofGetElapsedTimeMicros() - m_replayStart;
+	unsigned int due = MIN(elapsed * m_replayRate / 1000000 + 1, m_replayKeys.size());
+	while(m_replayPos < due && bKeyReplaying) { // key handlers may stop the replay
+		keyPressed(m_replayKeys[m_replayPos++]);
+	}
+	if(m_replayPos >= m_replayKeys.size()) {
+		stopKeyReplay();
+	}
+}
@@ -21,6 +21,8 @@
 
 #include "ofxRepl.h"
 #include "ofxFileDialog.h"
+#include "ofxEditorFileWatcher.h"
+#include "ofxEditorFileSaver.h"
 
 /// multi editor event listener
 class ofxGLEditorListener : public ofxReplListener {
@@ -31,14 +33,36 @@ class ofxGLEditorListener : public ofxReplListener {
 		/// returns the index of the current editor
 		virtual void openFileEvent(int &whichEditor) {}
 	
-		/// triggered when saving a file via CTRL/Super + s & CTRL/Super + d
-		/// returns the index of the current editor
+		/// triggered when saving a file via CTRL/Super + s & CTRL/Super + d or
+		/// ofxGLEditor::saveFile() has finished, files are saved in the
+		/// background so check ofxGLEditor::getSaveFileError() for failure
+		/// returns the index of the saved editor
 		virtual void saveFileEvent(int &whichEditor) {}
 	
+		/// triggered when the file open in an editor was changed on disk &
+		/// has been reloaded, see ofxGLEditor::setFileReloading()
+		/// returns the index of the editor
+		virtual void reloadFileEvent(int &whichEditor) {}
+	
 		/// triggered when CTRL/Super + e is pressed
 		/// returns the index of the current editor
+		///
+		/// see executeScriptTextEvent() for queued evals
 		virtual void executeScriptEvent(int &whichEditor) {}
 	
+		/// triggered when CTRL/Super + e is pressed
+		/// returns the index of the current editor & its text, or the
+		/// selection, copied when the key was pressed
+		///
+		/// also queued if getEvalExecutor() is not SYNC, finished when this
+		/// returns, override this instead of the above on a WORKER as calling
+		/// getText() there races with editing on the main thread
+		///
+		/// calls executeScriptEvent(int&) by default
+		virtual void executeScriptTextEvent(int whichEditor, const std::string &text) {
+			executeScriptEvent(whichEditor);
+		}
+	
 		/// this event is triggered when Enter is pressed in the Repl console
 		/// returns the text to be evaluated
 		virtual void evalReplEvent(const std::string &text) {}
@@ -76,11 +100,13 @@ class ofxGLEditor {
 		///
 		/// MOD + t: toggle whether to show or hide the editor
 		/// MOD + r & MOD + 0: switch to REPL (console), if enabled
+		/// MOD + r: reverse search the REPL history, when in the REPL
 		/// MOD + 1 to MOD + 9: switch to editor 1 - 9
 		///
 		/// ARROWS + SHIFT: select text
 		///
 		/// MOD + e: trigger an executeScript event
+		/// MOD + .: cancel running & queued evals
 		/// MOD + b: blow up the cursor
 		/// MOD + a: select all text in the current editor
 		/// MOD + a + SHIFT: clear all text in the current editor
@@ -90,6 +116,10 @@ class ofxGLEditor {
 		/// MOD + s: save file, shows save as dialog if no filename has been set
 		/// MOD + d: save as dialog, saves in current path (default: data path)
 		/// MOD + o: open a file via a file browser, starts in current path
+		/// MOD + o: expand a stored output into an empty editor, when in the
+		///          REPL, see expandReplOutput()
+		/// MOD + p: quick open a file by fuzzy searching every file under the
+		///          path set with setPath()
 		///
 		/// MOD + z: undo last key input action
 		/// MOD + y: redo last key input action
@@ -116,20 +146,30 @@ class ofxGLEditor {
 		/// returns true on success
 		bool openFile(std::string filename, int editor=0);
 		
-		/// save the text in an editor to a file
+		/// save the text in an editor to a file in the background
+		///
+		/// the text is copied right away, then encoded & written on a worker
+		/// thread, replacing the file atomically, see ofxEditorFileSaver,
+		/// a saveFileEvent is triggered once finished
 		///
 		/// set editor to 0 for the current editor or an editor index from 1- 9
 		///
-		/// returns true on success
+		/// returns true if the save was started
 		bool saveFile(std::string filename, int editor=0);
 	
-		/// save the text in an editor to the current filename
+		/// save the text in an editor to the current filename in the background
 		///
 		/// set editor to 0 for the current editor or an editor index from 1- 9
 		///
-		/// returns true on success
+		/// returns true if the save was started
 		bool saveFile(int editor=0);
 	
+		/// get the error of the last finished save of an editor,
+		/// returns "" if it succeeded
+		///
+		/// set editor to 0 for the current editor or an editor index from 1- 9
+		std::string getSaveFileError(int editor=0);
+	
 		/// get the contents of an editor or contents of editor selection
 		///
 		/// set editor to 0 for the current editor
@@ -201,8 +241,11 @@ class ofxGLEditor {
 		/// **important**: this must be called after an evalReplEvent in order to
 		/// print the next prompt ...
 		///
+		/// for a queued eval returning after evalReplEvent exits, pass the id
+		/// from ofxEditorEvalQueue::getCurrentId() captured in evalReplEvent
+		///
 		/// note: this does nothing if the repl was not enabled in setup()
-		void evalReplReturn(const std::string &text="");
+		void evalReplReturn(const std::string &text="", unsigned int id=0);
 		
 		/// clears text in Repl buffer, does not clear history
 		void clearRepl();
@@ -210,6 +253,48 @@ class ofxGLEditor {
 		/// clears Repl history, does not clear buffer text
 		void clearReplHistory();
 	
+		/// set a file to persist the Repl command history across sessions,
+		/// "" for none, returns false if the file couldn't be opened
+		bool setReplHistoryFile(const std::string &path);
+	
+		/// set the max number of Repl output lines printed per frame & per
+		/// second, 0 for no limit, see ofxRepl::setMaxOutputLinesPerFrame()
+		void setReplOutputBudget(unsigned int linesPerFrame, unsigned int linesPerSecond=0);
+	
+		/// set a file to append all Repl output to, including suppressed lines,
+		/// "" to close, returns false if the file couldn't be opened
+		bool setReplOutputSpillFile(const std::string &path);
+	
+		/// set the max size of a single Repl output, larger outputs are stored
+		/// out of the console & only previewed, see ofxRepl::setMaxInlineOutput()
+		void setReplMaxInlineOutput(unsigned int lines, size_t chars);
+	
+		/// expand a stored Repl output into the first empty editor & switch
+		/// to it, the editor is read only until a file is opened into it or
+		/// it's cleared
+		///
+		/// set id to 0 for the output previewed on the Repl cursor line or
+		/// the newest output
+		///
+		/// returns the editor index or -1 if there is no such output or empty
+		/// editor
+		int expandReplOutput(unsigned int id=0);
+	
+	/// \section Eval Queue
+	
+		/// cancel the running & queued repl evals & scripts, a running eval
+		/// can't be interrupted so its result is dropped when it returns
+		void cancelEval();
+	
+		/// returns true if an eval or script is queued or running
+		bool isEvalBusy();
+	
+		/// set/get the max running time of a queued eval or script in seconds,
+		/// the next one is started once the worker is free, 0 for no timeout,
+		/// default 0
+		void setEvalTimeout(float seconds);
+		float getEvalTimeout();
+	
 	/// \section Display Settings
 
 		/// access to the internal settings object
@@ -297,9 +382,25 @@ class ofxGLEditor {
 		
 	/// \section Util
 		
-		/// set the file browser path, default: data path when setup() is called
+		/// set the file browser & quick open path,
+		/// default: data path when setup() is called
 		void setPath(std::string path);
 	
+		/// set the max number of cached file browser directory listings,
+		/// 0 to disable, default 16
+		void setFileDialogCacheSize(unsigned int size);
+	
+		/// enable/disable reloading the files open in the editors when they
+		/// are changed on disk, triggers a reloadFileEvent, default: true
+		///
+		/// the file is read on a worker thread & the cursor & scroll position
+		/// stay on the same lines, unsaved edits can be brought back with undo,
+		/// see ofxEditor::reloadText()
+		void setFileReloading(bool reload=true);
+	
+		/// get file reloading value
+		bool getFileReloading();
+	
 		/// the current modifier as set in setup(), either CTRL (default) or Super
 		inline bool isModifierPressed() {return bModifierPressed;}
 		
@@ -316,6 +417,79 @@ class ofxGLEditor {
 		void drawString(const std::string& s, float x, float y);
 		void drawString(const std::string& s, ofPoint& p);
 	
+	/// \section Memory
+	
+		/// get the approximate memory used by all editors, the repl, the file
+		/// dialog, & the editor font in bytes per category
+		ofxEditor::MemoryUsage getMemoryUsage();
+	
+		/// get the approximate memory used by an editor, excluding the font
+		/// set editor to 0 for the current editor
+		ofxEditor::MemoryUsage getEditorMemoryUsage(int editor=0);
+	
+		/// set a soft memory limit in bytes, 0 disables (default)
+		///
+		/// checked once a second in draw(), when exceeded the cached file
+		/// browser listings are cleared & the repl scrollback is trimmed, then
+		/// the undo history of all editors is trimmed by half until the total
+		/// is under the limit, the current editor keeps its 4 most recent undo
+		/// actions, text & the font atlas are never trimmed
+		///
+		/// if the total is still over the limit afterwards, nothing is trimmed
+		/// again until it grows past the usage left after trimming
+		void setMemorySoftLimit(size_t bytes);
+	
+		/// get the soft memory limit in bytes, 0 if disabled
+		size_t getMemorySoftLimit();
+	
+	/// \section Profiling
+	
+		/// get the keystroke latency stats for an editor in microseconds,
+		/// see ofxEditor::getKeyLatency()
+		/// set editor to 0 for the current editor
+		ofxEditorProfiler::Stats getKeyLatency(int editor=0);
+	
+		/// draw the profiler stats table including the keystroke latency of the
+		/// current editor, see ofxEditor::drawProfiler()
+		void drawProfiler(float x, float y);
+	
+		/// start recording the keys passed to keyPressed(), clears the previous
+		/// recording
+		///
+		/// keys pressed with the modifier are skipped as the modifier state
+		/// can't be replayed
+		void startKeyRecording();
+	
+		/// stop recording keys
+		void stopKeyRecording();
+	
+		/// are keys being recorded?
+		bool isKeyRecording();
+	
+		/// get the recorded key sequence
+		const std::vector<int>& getKeyRecording();
+	
+		/// replay a key sequence into keyPressed() at a fixed rate in keys per
+		/// second for reproducible keystroke latency measurements
+		///
+		/// keys are sent from draw(), so keys due within the same frame are
+		/// sent together if the rate is higher than the frame rate
+		void replayKeys(const std::vector<int> &keys, float rate=20);
+	
+		/// stop replaying keys
+		void stopKeyReplay();
+	
+		/// are keys being replayed?
+		bool isKeyReplaying();
+	
+		/// save a key sequence to a text file, one key code per line
+		/// returns true on success
+		static bool saveKeys(const std::string &filename, const std::vector<int> &keys);
+	
+		/// load a key sequence from a text file, one key code per line
+		/// returns true on success
+		static bool loadKeys(const std::string &filename, std::vector<int> &keys);
+	
 	private:
 	
 		/// checks given index and autodecrements
@@ -325,16 +499,60 @@ class ofxGLEditor {
 	
 		ofxGLEditorListener *m_listener; //< event listener
 	
+		/// start the next queued eval & handle finished ones without a repl
+		void updateEvalQueue();
+	
+		/// eval queue shared with the repl so evals & scripts run in order
+		std::shared_ptr<ofxEditorEvalQueue> m_evalQueue;
+	
 		ofxEditorSettings m_settings; //< shared editor settings
 		vector<ofxEditor*> m_editors; //< editor instances, repl is at index 0
 		ofxFileDialog *m_fileDialog; //< file dialog instance
 	
 		int m_currentEditor; //< current editor, repl is at index 0
 		std::vector<std::string> m_saveFiles; //< one for each editor
+	
+		/// set the filename of an editor & watch the file if reloading
+		void setSaveFile(int editor, const std::string &path);
+	
+		/// reload changed files into their editors
+		void updateFileReloads();
+	
+		/// handle finished saves
+		void updateSaves();
+	
+		ofxEditorFileSaver m_fileSaver; //< writes files in the background
+		std::map<unsigned int, int> m_pendingSaves; //< editor by save id
+		std::vector<std::string> m_saveErrors; //< last save error for each editor
+	
+		ofxEditorFileWatcher m_fileWatcher; //< watches the editor files
+		bool bFileReloading; //< reload changed files?
 		
 		bool bModifierPressed; //< is the editor modifier key being pressed?
 		
 		bool bHideEditor;     //< hide the editor?
 	
 		bool bFlashEvalSelection; //< flash selection on eval?
+	
+		/// trim cached listings, repl scrollback, & undo history if over the
+		/// soft memory limit
+		void checkMemorySoftLimit();
+	
+		size_t m_memorySoftLimit; //< soft memory limit in bytes, 0 if disabled
+		uint64_t m_memoryCheckTime; //< last soft limit check in ms
+		size_t m_memoryTrimmedUsage; //< usage after the last trim, 0 if under the limit
+		uint64_t m_memoryWarningTime; //< last soft limit warning in ms
+		size_t m_memoryTrimmedBytes; //< bytes trimmed since the last warning
+	
+		/// send replay keys which are due
+		void updateKeyReplay();
+	
+		bool bKeyRecording; //< record keys?
+		std::vector<int> m_keyRecording; //< recorded keys
+	
+		bool bKeyReplaying; //< replay keys?
+		std::vector<int> m_replayKeys; //< keys to replay
+		unsigned int m_replayPos; //< next replay key index
+		float m_replayRate; //< replay keys per second
+		uint64_t m_replayStart; //< replay start time in us
 };
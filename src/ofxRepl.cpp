@@ -21,14 +21,40 @@
  * Copyright (C) Dave Griffiths
  */
 #include "ofxRepl.h"
+#include "ofxEditorFont.h"
 
 #include "Unicode.h"
 
+#include <climits>
+
+// default max console lines
 #define MAX_TEXT_LINES	256
-#define MAX_HISTORY_LEN	256
+
+// max log messages queued between frames, must be a power of 2
+#define LOG_QUEUE_SIZE 1024
+
+// pending output size in chars which is committed right away instead of
+// waiting for the next frame
+#define OUTPUT_COMMIT_SIZE 65536
+
+// min time between suppressed output markers while output is suppressed
+#define SUPPRESSED_MARKER_MS 1000
+
+// default max size of a single output printed to the console
+#define MAX_INLINE_OUTPUT_LINES 256
+#define MAX_INLINE_OUTPUT_CHARS 65536
+
+// default max memory used by outputs stored out of the console, 64 MB
+#define MAX_STORED_OUTPUT_BYTES 67108864
+
+// number of lines & max chars per line in a stored output preview
+#define OUTPUT_PREVIEW_LINES 8
+#define OUTPUT_PREVIEW_LINE_CHARS 256
 
 // utils
 bool isEmpty(u32string s);
+std::string formatCount(uint64_t count);
+std::string formatBytes(uint64_t bytes);
 
 std::u32string ofxRepl::s_banner = U"";
 std::u32string ofxRepl::s_prompt = U"> ";
@@ -40,7 +66,34 @@ ofxRepl::ofxRepl() : ofxEditor() {
 	m_selectAllStartPos = 0;
 	m_insertPos = 0;
 	m_historyNavStarted = false;
+	m_historyPos = 0;
+	m_historySearching = false;
+	m_historyMatch = 0;
+	m_historySearchFailed = false;
 	m_linePos = 0;
+	m_logDropped = 0;
+	m_maxScrollbackLines = MAX_TEXT_LINES;
+	m_maxScrollbackBytes = 0;
+	m_outputBeforePrompt = false;
+	m_maxOutputLinesPerFrame = 0;
+	m_maxOutputLinesPerSecond = 0;
+	m_outputFrame = 0;
+	m_outputFrameLines = 0;
+	m_outputSecond = 0;
+	m_outputSecondLines = 0;
+	m_suppressing = false;
+	m_suppressedLines = 0;
+	m_suppressedFrame = 0;
+	m_suppressedMarkerTime = 0;
+	m_suppressedBeforePrompt = false;
+	m_numSuppressedLines = 0;
+	m_spillDirty = false;
+	m_storedOutputBytes = 0;
+	m_maxStoredOutputBytes = MAX_STORED_OUTPUT_BYTES;
+	m_nextOutputId = 1;
+	m_maxInlineOutputLines = MAX_INLINE_OUTPUT_LINES;
+	m_maxInlineOutputChars = MAX_INLINE_OUTPUT_CHARS;
+	m_evalQueue = std::make_shared<ofxEditorEvalQueue>();
 }
 
 //--------------------------------------------------------------
@@ -50,7 +103,34 @@ ofxRepl::ofxRepl(ofxEditorSettings &sharedSettings) : ofxEditor(sharedSettings)
 	m_selectAllStartPos = 0;
 	m_insertPos = 0;
 	m_historyNavStarted = false;
+	m_historyPos = 0;
+	m_historySearching = false;
+	m_historyMatch = 0;
+	m_historySearchFailed = false;
 	m_linePos = 0;
+	m_logDropped = 0;
+	m_maxScrollbackLines = MAX_TEXT_LINES;
+	m_maxScrollbackBytes = 0;
+	m_outputBeforePrompt = false;
+	m_maxOutputLinesPerFrame = 0;
+	m_maxOutputLinesPerSecond = 0;
+	m_outputFrame = 0;
+	m_outputFrameLines = 0;
+	m_outputSecond = 0;
+	m_outputSecondLines = 0;
+	m_suppressing = false;
+	m_suppressedLines = 0;
+	m_suppressedFrame = 0;
+	m_suppressedMarkerTime = 0;
+	m_suppressedBeforePrompt = false;
+	m_numSuppressedLines = 0;
+	m_spillDirty = false;
+	m_storedOutputBytes = 0;
+	m_maxStoredOutputBytes = MAX_STORED_OUTPUT_BYTES;
+	m_nextOutputId = 1;
+	m_maxInlineOutputLines = MAX_INLINE_OUTPUT_LINES;
+	m_maxInlineOutputChars = MAX_INLINE_OUTPUT_CHARS;
+	m_evalQueue = std::make_shared<ofxEditorEvalQueue>();
 }
 
 //--------------------------------------------------------------
@@ -63,13 +143,13 @@ void ofxRepl::setup() {
 
 	// setup our custom logger
 	m_logger = std::shared_ptr<Logger>(new Logger);
-	m_logger->m_parent = this;
+	m_logDropped = 0;
 	ofSetLoggerChannel(m_logger);
 
 	// print greeting and first prompt
 	if(s_banner != U"") {
 		resize();
-		print(s_banner);
+		queueOutput(s_banner, false);
 	}
 	printPrompt();
 }
@@ -80,8 +160,142 @@ void ofxRepl::setup(ofxReplListener *listener) {
 	m_listener = listener;
 }
 
+//--------------------------------------------------------------
+void ofxRepl::draw() {
+	flushLog();
+	flushEval();
+	flushOutput();
+	ofxEditor::draw();
+}
+
+//--------------------------------------------------------------
+void ofxRepl::flushEval() {
+	m_evalQueue->update();
+	ofxEditorEvalQueue::Result result;
+	while(m_evalQueue->pop(result)) {
+		std::string what = (result.editor == 0 ? "eval " : "script ") + ofToString(result.id);
+		switch(result.status) {
+			case ofxEditorEvalQueue::DONE:
+				if(result.editor == 0) {
+					flushLog(); // log messages from the eval come first
+					if(result.text.size() > 0) {
+						queueOutput(string_to_wstring(result.text+"\n"), true);
+					}
+				}
+				break;
+			case ofxEditorEvalQueue::CANCELLED:
+				queueOutput(string_to_wstring(what+" cancelled\n"), true);
+				break;
+			case ofxEditorEvalQueue::TIMED_OUT:
+				queueOutput(string_to_wstring(what+" timed out after "+ofToString(result.seconds, 1)+"s\n"), true);
+				break;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofxRepl::cancelEval() {
+	m_evalQueue->cancelAll();
+}
+
+//--------------------------------------------------------------
+void ofxRepl::setEvalQueue(std::shared_ptr<ofxEditorEvalQueue> queue) {
+	if(queue) {
+		m_evalQueue = queue;
+	}
+}
+
+//--------------------------------------------------------------
+std::shared_ptr<ofxEditorEvalQueue> ofxRepl::getEvalQueue() {
+	return m_evalQueue;
+}
+
+//--------------------------------------------------------------
+void ofxRepl::flushOutput() {
+	flushSuppressed();
+	if(m_spillDirty) {
+		m_spillFile.flush();
+		m_spillDirty = false;
+	}
+	if(m_output.empty()) {
+		return;
+	}
+	if(m_settings->getConvertTabs()) {
+		size_t pos = m_output.find('\t');
+		while(pos != std::u32string::npos) {
+			m_output.replace(pos, 1, m_settings->getTabWidth(), ' ');
+			pos = m_output.find('\t', pos);
+		}
+	}
+	size_t newline = m_output.rfind('\n');
+	m_linePos = (newline == std::u32string::npos ? m_linePos + m_output.length() : m_output.length() - newline - 1);
+	
+	unsigned int length = m_output.length();
+	if(m_outputBeforePrompt) {
+		unsigned int pos = MAX(0, m_promptPos-s_prompt.length());
+		m_text.insert(pos, m_output);
+		textBufferInserted(pos, length);
+		unsigned int *positions[] = {
+			&m_position, &m_promptPos, &m_insertPos, &m_selectAllStartPos,
+			&m_highlightStart, &m_highlightEnd
+		};
+		for(auto p : positions) {
+			if(*p >= pos) {
+				*p += length;
+			}
+		}
+		for(auto &action : m_undoActions) {
+			if(action.pos >= pos) {
+				action.pos += length;
+			}
+		}
+	}
+	else {
+		m_selection = NONE;
+		m_text.insert(m_position, m_output);
+		textBufferInserted(m_position, length);
+		m_position += length;
+		m_promptPos = m_position+s_prompt.length();
+		m_selectAllStartPos = m_position;
+		m_highlightStart = m_position;
+		m_highlightEnd = m_position;
+	}
+	m_output.clear();
+	
+	evictScrollback();
+	keepCursorVisible();
+}
+
+//--------------------------------------------------------------
+void ofxRepl::flushLog() {
+	if(!m_logger) {
+		return;
+	}
+	
+	// print everything queued since the last frame at once
+	while(m_logger->queue.pop(m_logMessage)) {
+		m_logText += string_to_wstring(m_logMessage);
+		m_logText += U"\n";
+	}
+	unsigned int dropped = m_logger->dropped.load(std::memory_order_relaxed);
+	if(dropped != m_logDropped) {
+		m_logText += string_to_wstring("dropped " + ofToString(dropped - m_logDropped) + " log messages\n");
+		m_logDropped = dropped;
+	}
+	if(!m_logText.empty()) {
+		print(m_logText, true);
+		m_logText.clear();
+	}
+}
+
+//--------------------------------------------------------------
+unsigned int ofxRepl::getNumDroppedLogMessages() {
+	return m_logger ? m_logger->dropped.load(std::memory_order_relaxed) : 0;
+}
+
 //--------------------------------------------------------------
 void ofxRepl::keyPressed(int key) {
+	OFXEDITOR_TRACE_SCOPE_ARG("ofxRepl::keyPressed", "input", "key", key);
 	
 	// filter out modifier key events, except SHIFT
 	switch(key) {
@@ -90,6 +304,8 @@ void ofxRepl::keyPressed(int key) {
 		case OF_KEY_SUPER: case OF_KEY_LEFT_SUPER: case OF_KEY_RIGHT_SUPER:
 			return;
 	}
+	keyLatencyBegin();
+	flushOutput();
 	bool copying = false;
 	
 	// check modifier keys
@@ -128,6 +344,21 @@ void ofxRepl::keyPressed(int key) {
 				}
 				copying = true;
 				break;
+			case '.': // cancel evals
+				cancelEval();
+				return;
+			case 'r': case 18: // reverse history search
+				historySearch();
+				return;
+		}
+	}
+	
+	if(m_historySearching) {
+		if(modifierPressed) {
+			historySearchEnd(true);
+		}
+		else if(historySearchKeyPressed(key)) {
+			return;
 		}
 	}
 	
@@ -177,55 +408,45 @@ void ofxRepl::keyPressed(int key) {
 
 //--------------------------------------------------------------
 void ofxRepl::print(const std::u32string &what, bool beforePrompt) {
-
-	// trim half of text if we overflow the max num of lines
-	if(m_numLines > MAX_TEXT_LINES) {
-		int line = (int)m_numLines*0.25;
-		int count = 0;
-		int pos = 0;
-		for(unsigned int i = 0; count <= line && i < m_text.size(); i++) {
-			if(m_text[i] == '\n') {
-				count++;
-				pos = i+1;
-			}
-		}
-		m_text.erase(0, pos);
-		textBufferUpdated();
-		m_position = m_promptPos = m_insertPos = m_text.size();
-		m_topTextPosition -= pos;
-		m_bottomTextPosition -= pos;
-	}
-
-	std::u32string to_print;
-	for(std::u32string::const_iterator i = what.begin(); i != what.end(); ++i) {
-		m_linePos++;
-		if(*i == '\n') {
-			m_linePos = 0;
-		}
-		to_print += *i;
+	
+	// the prompt is already shown during a deferred eval
+	if(ofxEditorEvalQueue::getCurrentRequest()) {
+		beforePrompt = true;
 	}
+	spillOutput(what);
 	
-	if(beforePrompt) {
-		m_text.insert(MAX(0, m_promptPos-s_prompt.length()), to_print);
-		m_position += to_print.length();
-		m_promptPos += to_print.length();
-		m_insertPos += to_print.length();
-		m_selectAllStartPos += to_print.length();
-		if(m_selection != NONE) {
-			m_highlightStart += to_print.length();
-			m_highlightEnd += to_print.length();
+	// print up to the remaining line budget & suppress the rest
+	unsigned int budget = outputBudget();
+	if(budget == UINT_MAX) {
+		queueOutput(what, beforePrompt, false);
+		return;
+	}
+	size_t end = 0;
+	unsigned int lines = 0;
+	if(budget > 0) {
+		end = what.size();
+		for(size_t i = 0; i < what.size(); ++i) {
+			if(what[i] == '\n' && ++lines == budget) {
+				end = i+1;
+				break;
+			}
 		}
 	}
-	else {
-		insertText(to_print);
-		m_promptPos = m_insertPos;
-		m_promptPos = m_position+s_prompt.length();
-		m_selectAllStartPos = m_position;
-		m_highlightStart = m_position;
-		m_highlightEnd = m_position;
+	m_outputFrameLines += lines;
+	m_outputSecondLines += lines;
+	if(end == what.size()) {
+		queueOutput(what, beforePrompt, false);
+		return;
 	}
-	
-	keepCursorVisible();
+	if(end > 0) {
+		queueOutput(what.substr(0, end), beforePrompt, false);
+	}
+	unsigned int suppressed = count(what.begin()+end, what.end(), '\n');
+	m_suppressing = true;
+	m_suppressedLines += suppressed;
+	m_numSuppressedLines += suppressed;
+	m_suppressedFrame = ofGetFrameNum();
+	m_suppressedBeforePrompt = beforePrompt;
 }
 
 //--------------------------------------------------------------
@@ -234,20 +455,166 @@ void ofxRepl::print(const std::string &what, bool beforePrompt) {
 }
 
 //--------------------------------------------------------------
-void ofxRepl::printEvalReturn(const std::u32string &what) {
+void ofxRepl::printEvalReturn(const std::u32string &what, unsigned int id) {
+	if(id > 0 ? m_evalQueue->complete(id, wstring_to_string(what)) :
+	            m_evalQueue->complete(wstring_to_string(what))) {
+		return; // queued eval, printed by flushEval()
+	}
+	flushLog();
 	if(what.size() > 0) {
-		print(what+U"\n");
+		queueOutput(what+U"\n", false);
 	}
 	printPrompt();
 }
 
 //--------------------------------------------------------------
-void ofxRepl::printEvalReturn(const std::string &what) {
+void ofxRepl::printEvalReturn(const std::string &what, unsigned int id) {
+	if(id > 0 ? m_evalQueue->complete(id, what) : m_evalQueue->complete(what)) {
+		return;
+	}
 	printEvalReturn(string_to_wstring(what));
 }
 
+//--------------------------------------------------------------
+void ofxRepl::setMaxOutputLinesPerFrame(unsigned int lines) {
+	m_maxOutputLinesPerFrame = lines;
+}
+
+//--------------------------------------------------------------
+unsigned int ofxRepl::getMaxOutputLinesPerFrame() {
+	return m_maxOutputLinesPerFrame;
+}
+
+//--------------------------------------------------------------
+void ofxRepl::setMaxOutputLinesPerSecond(unsigned int lines) {
+	m_maxOutputLinesPerSecond = lines;
+}
+
+//--------------------------------------------------------------
+unsigned int ofxRepl::getMaxOutputLinesPerSecond() {
+	return m_maxOutputLinesPerSecond;
+}
+
+//--------------------------------------------------------------
+uint64_t ofxRepl::getNumSuppressedLines() {
+	return m_numSuppressedLines;
+}
+
+//--------------------------------------------------------------
+bool ofxRepl::setOutputSpillFile(const std::string &path) {
+	if(m_spillFile.is_open()) {
+		m_spillFile.close();
+	}
+	m_spillPath = "";
+	m_spillDirty = false;
+	if(path == "") {
+		return true;
+	}
+	m_spillFile.open(ofToDataPath(path), std::ios::out | std::ios::app);
+	if(!m_spillFile.is_open()) {
+		ofLogError("ofxRepl") << "couldn't open output spill file \""
+			<< ofFilePath::getFileName(path) << "\"";
+		return false;
+	}
+	m_spillPath = path;
+	return true;
+}
+
+//--------------------------------------------------------------
+std::string ofxRepl::getOutputSpillFile() {
+	return m_spillPath;
+}
+
+//--------------------------------------------------------------
+void ofxRepl::setMaxInlineOutput(unsigned int lines, size_t chars) {
+	m_maxInlineOutputLines = lines;
+	m_maxInlineOutputChars = chars;
+}
+
+//--------------------------------------------------------------
+unsigned int ofxRepl::getMaxInlineOutputLines() {
+	return m_maxInlineOutputLines;
+}
+
+//--------------------------------------------------------------
+size_t ofxRepl::getMaxInlineOutputChars() {
+	return m_maxInlineOutputChars;
+}
+
+//--------------------------------------------------------------
+void ofxRepl::setMaxStoredOutputBytes(size_t bytes) {
+	m_maxStoredOutputBytes = bytes;
+	while(m_storedOutputs.size() > 1 && m_storedOutputBytes > m_maxStoredOutputBytes) {
+		m_storedOutputBytes -= m_storedOutputs.front().text.size();
+		m_storedOutputs.pop_front();
+	}
+}
+
+//--------------------------------------------------------------
+size_t ofxRepl::getMaxStoredOutputBytes() {
+	return m_maxStoredOutputBytes;
+}
+
+//--------------------------------------------------------------
+bool ofxRepl::getStoredOutput(unsigned int id, std::u32string &text) {
+	for(auto &output : m_storedOutputs) {
+		if(output.id == id) {
+			text = string_to_wstring(output.text);
+			return true;
+		}
+	}
+	return false;
+}
+
+//--------------------------------------------------------------
+unsigned int ofxRepl::getStoredOutputId() {
+	if(m_storedOutputs.empty()) {
+		return 0;
+	}
+	
+	// look for a preview marker on the cursor line
+	static const std::u32string marker = U"... [output ";
+	size_t start = lineStart(m_position), end = lineEnd(m_position);
+	if(end - start > marker.size() && m_text.compare(start, marker.size(), marker) == 0) {
+		unsigned int id = 0;
+		for(size_t i = start + marker.size(); i < end && m_text[i] >= '0' && m_text[i] <= '9'; ++i) {
+			id = id * 10 + (m_text[i] - '0');
+		}
+		if(id > 0) {
+			return id;
+		}
+	}
+	return m_storedOutputs.back().id;
+}
+
+//--------------------------------------------------------------
+bool ofxRepl::setHistoryFile(const std::string &path) {
+	historySearchEnd(true);
+	m_historyNavStarted = false;
+	return m_history.setFile(path);
+}
+
+//--------------------------------------------------------------
+std::string ofxRepl::getHistoryFile() {
+	return m_history.getFile();
+}
+
+//--------------------------------------------------------------
+void ofxRepl::setMaxHistorySize(size_t size) {
+	m_history.setMaxSize(size);
+	m_historyNavStarted = false;
+}
+
+//--------------------------------------------------------------
+size_t ofxRepl::getMaxHistorySize() {
+	return m_history.getMaxSize();
+}
+
 //--------------------------------------------------------------
 void ofxRepl::clearText() {
+	m_output.clear();
+	m_storedOutputs.clear();
+	m_storedOutputBytes = 0;
 	ofxEditor::clearText();
 	m_promptPos = 0;
 	m_selectAllStartPos = 0;
@@ -260,6 +627,79 @@ void ofxRepl::clearHistory() {
 	historyClear();
 }
 
+//--------------------------------------------------------------
+bool ofxRepl::trimScrollback() {
+	bool trimmed = false;
+	
+	// oldest half of the lines above the prompt
+	unsigned int end = promptLineStart();
+	int drop = count(m_text.begin(), m_text.begin()+end, '\n')/2;
+	unsigned int pos = 0;
+	for(unsigned int i = 0; drop > 0 && i < end; ++i) {
+		if(m_text[i] == '\n') {
+			drop--;
+			pos = i+1;
+		}
+	}
+	if(pos > 0) {
+		eraseScrollback(pos);
+		m_text.shrink_to_fit();
+		trimmed = true;
+	}
+	
+	// oldest half of the stored outputs
+	for(size_t i = m_storedOutputs.size()/2; i > 0; --i) {
+		m_storedOutputBytes -= m_storedOutputs.front().text.size();
+		m_storedOutputs.pop_front();
+		trimmed = true;
+	}
+	
+	// oldest half of the history, the history file is left as is
+	if(m_history.size() > 1) {
+		historySearchEnd(true);
+		m_history.trim(m_history.size()/2);
+		m_historyNavStarted = false;
+		m_historyPos = m_history.size();
+		trimmed = true;
+	}
+	return trimmed;
+}
+
+//--------------------------------------------------------------
+void ofxRepl::setMaxScrollbackLines(unsigned int lines) {
+	m_maxScrollbackLines = lines;
+	evictScrollback();
+}
+
+//--------------------------------------------------------------
+unsigned int ofxRepl::getMaxScrollbackLines() {
+	return m_maxScrollbackLines;
+}
+
+//--------------------------------------------------------------
+void ofxRepl::setMaxScrollbackBytes(size_t bytes) {
+	m_maxScrollbackBytes = bytes;
+	evictScrollback();
+}
+
+//--------------------------------------------------------------
+size_t ofxRepl::getMaxScrollbackBytes() {
+	return m_maxScrollbackBytes;
+}
+
+//--------------------------------------------------------------
+ofxEditor::MemoryUsage ofxRepl::getMemoryUsage() {
+	MemoryUsage usage = ofxEditor::getMemoryUsage();
+	usage.scrollback = usage.text + stringMemory(m_evalText) + stringMemory(m_historyPresent) +
+		m_logMessage.capacity() + stringMemory(m_logText) + stringMemory(m_output);
+	usage.text = 0;
+	usage.scrollback += m_history.getMemoryUsage();
+	for(auto &output : m_storedOutputs) {
+		usage.scrollback += sizeof(StoredOutput) + output.text.capacity();
+	}
+	return usage;
+}
+
 //--------------------------------------------------------------
 bool ofxRepl::openFile(std::string filename) {
 	ofLogWarning("ofxRepl") << "ignoring openFile";
@@ -280,11 +720,24 @@ void ofxRepl::eval() {
 		u32string defun = m_text.substr(m_promptPos);
 		if(!isEmpty(defun)) {
 			m_insertPos = m_text.length();
-			print(U"\n");
+			queueOutput(U"\n", false);
 			
 			m_evalText = defun;
+			bool queued = false;
 			if(m_listener) {
-				m_listener->evalReplEvent(wstring_to_string(m_evalText));
+				ofxEditorEvalQueue::Executor executor = m_listener->getEvalExecutor();
+				if(executor == ofxEditorEvalQueue::SYNC) {
+					OFXEDITOR_TRACE_SCOPE("evalReplEvent", "eval");
+					m_listener->evalReplEvent(wstring_to_string(m_evalText));
+				}
+				else {
+					ofxReplListener *listener = m_listener;
+					m_evalQueue->push(0, wstring_to_string(m_evalText), executor,
+						[listener](const ofxEditorEvalQueue::Request &request) {
+							listener->evalReplEvent(request.text);
+						});
+					queued = true;
+				}
 			}
 			else {
 				ofLogWarning("ofxRepl") << "listener not set";
@@ -293,15 +746,12 @@ void ofxRepl::eval() {
 			if(defun[defun.length()-1] == '\n') {
 				defun.resize(defun.length()-1, 0);
 			}
-			if(m_history.size() >= MAX_HISTORY_LEN) {
-				m_history.pop_front();
-				m_historyIter--;
-			}
-			m_history.push_back(defun);
+			m_history.add(defun);
 			m_historyNavStarted = false;
 		
-			// go to next line in case the listener isn't set
-			if(!m_listener) {
+			// go to next line in case the listener isn't set or the eval
+			// was queued, queued eval returns are printed above the prompt
+			if(!m_listener || queued) {
 				printPrompt();
 			}
 		}
@@ -310,23 +760,207 @@ void ofxRepl::eval() {
 
 //--------------------------------------------------------------
 void ofxRepl::printPrompt() {
+	flushOutput();
 	m_insertPos = m_text.length();
 	if(m_text.length() > 0 && m_text[m_insertPos-1] != '\n') {
 		m_text += '\n';
+		textBufferInserted(m_insertPos, 1);
 		m_insertPos++;
 		m_position++;
 	}
-	insertText(s_prompt);
+	m_selection = NONE;
+	m_text.insert(m_position, s_prompt);
+	textBufferInserted(m_position, s_prompt.length());
+	m_position += s_prompt.length();
 	m_promptPos = m_selectAllStartPos = m_position;
 	clearUndo(); // only allow undo actions on the current command line
 }
 
+//--------------------------------------------------------------
+void ofxRepl::queueOutput(const std::u32string &what, bool beforePrompt, bool spill) {
+	if(spill) {
+		spillOutput(what);
+	}
+	if(isLargeOutput(what)) {
+		appendOutput(storeOutput(what), beforePrompt);
+	}
+	else {
+		appendOutput(what, beforePrompt);
+	}
+}
+
+//--------------------------------------------------------------
+void ofxRepl::appendOutput(const std::u32string &what, bool beforePrompt) {
+	
+	// keep the order of output printed above & at the prompt
+	if(!m_output.empty() && beforePrompt != m_outputBeforePrompt) {
+		flushOutput();
+	}
+	m_output += what;
+	m_outputBeforePrompt = beforePrompt;
+	if(m_output.size() >= OUTPUT_COMMIT_SIZE) {
+		flushOutput();
+	}
+}
+
+//--------------------------------------------------------------
+unsigned int ofxRepl::outputBudget() {
+	if(m_maxOutputLinesPerFrame == 0 && m_maxOutputLinesPerSecond == 0) {
+		return UINT_MAX;
+	}
+	uint64_t frame = ofGetFrameNum();
+	if(frame != m_outputFrame) {
+		m_outputFrame = frame;
+		m_outputFrameLines = 0;
+	}
+	uint64_t now = ofGetElapsedTimeMillis();
+	if(now - m_outputSecond >= 1000) {
+		m_outputSecond = now;
+		m_outputSecondLines = 0;
+	}
+	unsigned int budget = UINT_MAX;
+	if(m_maxOutputLinesPerFrame > 0) {
+		budget = (m_outputFrameLines < m_maxOutputLinesPerFrame ?
+			m_maxOutputLinesPerFrame - m_outputFrameLines : 0);
+	}
+	if(m_maxOutputLinesPerSecond > 0) {
+		budget = MIN(budget, (m_outputSecondLines < m_maxOutputLinesPerSecond ?
+			m_maxOutputLinesPerSecond - m_outputSecondLines : 0));
+	}
+	return budget;
+}
+
+//--------------------------------------------------------------
+void ofxRepl::flushSuppressed() {
+	if(!m_suppressing) {
+		return;
+	}
+	
+	// summarize once the output stops or every so often while it continues
+	uint64_t now = ofGetElapsedTimeMillis();
+	if(m_suppressedFrame == ofGetFrameNum() && now - m_suppressedMarkerTime < SUPPRESSED_MARKER_MS) {
+		return;
+	}
+	std::string marker = "... " + formatCount(m_suppressedLines) + " lines suppressed";
+	if(m_spillFile.is_open()) {
+		marker += ", see " + ofFilePath::getFileName(m_spillPath);
+	}
+	m_suppressing = false;
+	m_suppressedLines = 0;
+	m_suppressedMarkerTime = now;
+	queueOutput(string_to_wstring(marker+"\n"), m_suppressedBeforePrompt, false);
+}
+
+//--------------------------------------------------------------
+void ofxRepl::spillOutput(const std::u32string &what) {
+	if(m_spillFile.is_open()) {
+		m_spillFile << wstring_to_string(what);
+		m_spillDirty = true;
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxRepl::isLargeOutput(const std::u32string &what) {
+	if(m_maxInlineOutputChars > 0 && what.size() > m_maxInlineOutputChars) {
+		return true;
+	}
+	if(m_maxInlineOutputLines == 0 || what.size() <= m_maxInlineOutputLines) {
+		return false;
+	}
+	unsigned int lines = 0;
+	for(char32_t c : what) {
+		if(c == '\n' && ++lines > m_maxInlineOutputLines) {
+			return true;
+		}
+	}
+	return false;
+}
+
+//--------------------------------------------------------------
+std::u32string ofxRepl::storeOutput(const std::u32string &what) {
+	
+	// stored as UTF-8 which is a quarter of the size for mostly ASCII output
+	// & isn't parsed until it's expanded into an editor
+	StoredOutput output;
+	output.id = m_nextOutputId++;
+	output.text = wstring_to_string(what);
+	output.text.shrink_to_fit();
+	uint64_t lines = count(what.begin(), what.end(), '\n') + (what.back() != '\n' ? 1 : 0);
+	uint64_t bytes = output.text.size();
+	m_storedOutputBytes += output.text.size();
+	m_storedOutputs.push_back(std::move(output));
+	setMaxStoredOutputBytes(m_maxStoredOutputBytes); // drop the oldest
+	
+	// first lines, long lines are cut
+	std::u32string preview;
+	size_t pos = 0;
+	for(unsigned int i = 0; i < OUTPUT_PREVIEW_LINES && pos < what.size(); ++i) {
+		size_t end = what.find('\n', pos);
+		if(end == std::u32string::npos) {
+			end = what.size();
+		}
+		if(end - pos > OUTPUT_PREVIEW_LINE_CHARS) {
+			preview.append(what, pos, OUTPUT_PREVIEW_LINE_CHARS);
+			preview += U" ...";
+		}
+		else {
+			preview.append(what, pos, end - pos);
+		}
+		preview += '\n';
+		pos = end + 1;
+	}
+	preview += string_to_wstring("... [output " + ofToString(m_nextOutputId-1) + ": " +
+		formatCount(lines) + (lines == 1 ? " line, " : " lines, ") + formatBytes(bytes) + "]\n");
+	return preview;
+}
+
+//--------------------------------------------------------------
+void ofxRepl::drawCursor(int x, int y) {
+	ofxEditor::drawCursor(x, y);
+	if(m_position < m_text.size()) {
+		return;
+	}
+	if(m_historySearching) {
+		m_status = (m_historySearchFailed ? "[failed search: " : "[search: ");
+		m_status += wstring_to_string(m_historyQuery);
+		m_status += "]";
+	}
+	else if(m_evalQueue->isBusy()) {
+		
+		// formatted into a reused buffer so drawing doesn't allocate
+		char status[64];
+		unsigned int id = m_evalQueue->getRunningId(), queued = m_evalQueue->getNumQueued();
+		if(id > 0) {
+			snprintf(status, sizeof(status), "[eval %u %.1fs", id, m_evalQueue->getRunningTime());
+		}
+		else {
+			snprintf(status, sizeof(status), "[eval");
+		}
+		m_status = status;
+		if(queued > 0) {
+			snprintf(status, sizeof(status), ", %u queued]", queued);
+		}
+		else {
+			snprintf(status, sizeof(status), "]");
+		}
+		m_status += status;
+	}
+	else {
+		return;
+	}
+	s_font->pushState();
+	s_font->setColor(m_settings->getLineNumberColor(), m_settings->getAlpha());
+	s_font->drawString(m_status, x + s_cursorWidth + s_charWidth, y, s_textShadow);
+	s_font->popState();
+}
+
 //--------------------------------------------------------------
 void ofxRepl::historyClear() {
+	historySearchEnd(true);
 	m_historyNavStarted = false;
 	m_history.clear();
 	m_insertPos = 0;
-	m_historyIter = m_history.end();
+	m_historyPos = m_history.size();
 	m_historyPresent = m_text.substr(m_promptPos);
 }
 
@@ -334,36 +968,108 @@ void ofxRepl::historyClear() {
 void ofxRepl::historyPrev() {
 	
 	if(!m_historyNavStarted) {
-		m_historyIter = m_history.end();
+		m_historyPos = m_history.size();
 		m_historyNavStarted = true;
 	}
 
-	if(m_historyIter == m_history.end()) {
+	if(m_historyPos == m_history.size()) {
 		m_historyPresent = m_text.substr(m_promptPos);
 	}
 
-	if(m_historyIter == m_history.begin()) {
+	if(m_historyPos == 0) {
 		return;
 	}
 
-	m_historyIter--;
-	historyShow(*m_historyIter);
+	m_historyPos--;
+	historyShow(m_history.get(m_historyPos));
 }
 
 //--------------------------------------------------------------
 void ofxRepl::historyNext() {
-	if(!m_historyNavStarted || (m_historyIter == m_history.end())) {
+	if(!m_historyNavStarted || (m_historyPos >= m_history.size())) {
 		return;
 	}
-	m_historyIter++;
-	historyShow((m_historyIter == m_history.end()) ? m_historyPresent : *m_historyIter);
+	m_historyPos++;
+	historyShow((m_historyPos == m_history.size()) ? m_historyPresent : m_history.get(m_historyPos));
 }
 
 //--------------------------------------------------------------
-void ofxRepl::historyShow(std::u32string what) {
-	m_text.resize(m_promptPos, 0);
-	m_text += what;
+void ofxRepl::historyShow(const std::u32string &what) {
+	std::u32string removed = m_text.substr(m_promptPos);
+	m_text.replace(m_promptPos, std::u32string::npos, what);
+	textBufferReplaced(m_promptPos, what.length(), removed);
 	m_position = m_text.length();
+	m_selection = NONE;
+}
+
+//--------------------------------------------------------------
+void ofxRepl::historySearch() {
+	if(!m_historySearching) {
+		m_historySearching = true;
+		m_historySearchFailed = false;
+		m_historyQuery.clear();
+		m_historyPresent = m_text.substr(m_promptPos);
+		m_historyMatch = m_history.size();
+		m_position = m_text.length();
+		m_selection = NONE;
+		keepCursorVisible();
+		return;
+	}
+	historySearchFind(m_historyMatch); // next older match
+}
+
+//--------------------------------------------------------------
+void ofxRepl::historySearchFind(size_t before) {
+	size_t index = before;
+	m_historySearchFailed = !m_history.search(m_historyQuery, index);
+	if(!m_historySearchFailed) {
+		m_historyMatch = index;
+		historyShow(m_history.get(index));
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxRepl::historySearchKeyPressed(int key) {
+	switch(key) {
+		case OF_KEY_SHIFT: case OF_KEY_LEFT_SHIFT: case OF_KEY_RIGHT_SHIFT:
+			return true;
+		case OF_KEY_BACKSPACE:
+			if(!m_historyQuery.empty()) {
+				m_historyQuery.pop_back();
+				if(m_historyQuery.empty()) {
+					m_historySearchFailed = false;
+					m_historyMatch = m_history.size();
+					historyShow(m_historyPresent);
+				}
+				else {
+					historySearchFind(m_history.size());
+				}
+			}
+			return true;
+		case OF_KEY_ESC:
+			historySearchEnd(false);
+			return true;
+		default:
+			if(key >= ' ' && key < 0x7F) {
+				m_historyQuery += (char32_t) key;
+				historySearchFind(m_historyMatch < m_history.size() ? m_historyMatch+1 : m_history.size());
+				return true;
+			}
+			historySearchEnd(true); // keep the match & handle the key
+			return false;
+	}
+}
+
+//--------------------------------------------------------------
+void ofxRepl::historySearchEnd(bool accept) {
+	if(!m_historySearching) {
+		return;
+	}
+	m_historySearching = false;
+	if(!accept) {
+		historyShow(m_historyPresent);
+	}
+	m_historyNavStarted = false;
 }
 
 //--------------------------------------------------------------
@@ -386,6 +1092,49 @@ void ofxRepl::keepCursorVisible() {
 	}
 }
 
+//--------------------------------------------------------------
+void ofxRepl::evictScrollback() {
+	bool overLines = m_maxScrollbackLines > 0 && m_numLines > m_maxScrollbackLines;
+	bool overBytes = m_maxScrollbackBytes > 0 && m_text.size()*sizeof(char32_t) > m_maxScrollbackBytes;
+	if(!overLines && !overBytes) {
+		return;
+	}
+	
+	// evict down to 3/4 of the capacity, but never the prompt line
+	unsigned int end = promptLineStart();
+	unsigned int pos = 0;
+	if(overLines) {
+		unsigned int drop = m_numLines - m_maxScrollbackLines*3/4;
+		for(unsigned int i = 0; drop > 0 && i < end; ++i) {
+			if(m_text[i] == '\n') {
+				drop--;
+				pos = i+1;
+			}
+		}
+	}
+	if(overBytes) {
+		size_t keep = m_maxScrollbackBytes*3/4/sizeof(char32_t);
+		size_t newline = m_text.find('\n', m_text.size()-keep-1);
+		pos = MAX(pos, (newline == std::u32string::npos ? end : newline+1));
+	}
+	eraseScrollback(MIN(pos, end));
+}
+
+//--------------------------------------------------------------
+void ofxRepl::eraseScrollback(unsigned int pos) {
+	if(pos == 0) {
+		return;
+	}
+	eraseLeadingLines(pos);
+	m_promptPos = (m_promptPos > pos ? m_promptPos - pos : 0);
+	m_insertPos = (m_insertPos > pos ? m_insertPos - pos : 0);
+}
+
+//--------------------------------------------------------------
+unsigned int ofxRepl::promptLineStart() {
+	return lineStart(MIN(m_promptPos, m_text.size()));
+}
+
 // STATIC UTILS
 
 //--------------------------------------------------------------
@@ -430,22 +1179,91 @@ std::string ofxRepl::getReplPrompt() {
 
 // PRIVATE
 
+//--------------------------------------------------------------
+ofxRepl::Logger::Logger() : queue(LOG_QUEUE_SIZE), dropped(0) {}
+
 //--------------------------------------------------------------
 void ofxRepl::Logger::log(ofLogLevel level, const std::string & module, const std::string & message){
 	ofConsoleLoggerChannel::log(level, module, message);
 	if(level >= ofGetLogLevel()) {
-		m_parent->print(string_to_wstring(message)+U"\n", true);
+		push(message);
 	}
 }
 
 //--------------------------------------------------------------
 void ofxRepl::Logger::log(ofLogLevel level, const std::string & module, const char* format, va_list args){
+	va_list copy; // args can only be read once
+	va_copy(copy, args);
 	ofConsoleLoggerChannel::log(level, module, format, args);
 	if(level >= ofGetLogLevel()) {
-		m_parent->print(string_to_wstring(ofVAArgsToString(format, args))+U"\n", true);
+		push(ofVAArgsToString(format, copy));
+	}
+	va_end(copy);
+}
+
+//--------------------------------------------------------------
+void ofxRepl::Logger::push(const std::string &message) {
+	if(!queue.push(message)) {
+		dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+// LOG QUEUE
+
+// bounded queue with a sequence number per cell, see Dmitry Vyukov's
+// bounded MPMC queue: the sequence equals the cell position when free & the
+// position+1 once a message has been published for the consumer
+
+//--------------------------------------------------------------
+ofxRepl::LogQueue::LogQueue(unsigned int size) : pushPos(0), popPos(0) {
+	size_t num = 2;
+	while(num < size) {
+		num *= 2;
+	}
+	cells.reset(new Cell[num]);
+	mask = num - 1;
+	for(size_t i = 0; i < num; ++i) {
+		cells[i].sequence.store(i, std::memory_order_relaxed);
 	}
 }
 
+//--------------------------------------------------------------
+bool ofxRepl::LogQueue::push(const std::string &message) {
+	size_t pos = pushPos.load(std::memory_order_relaxed);
+	Cell *cell;
+	while(true) {
+		cell = &cells[pos & mask];
+		size_t sequence = cell->sequence.load(std::memory_order_acquire);
+		intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+		if(diff == 0) { // free, try to claim it
+			if(pushPos.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		else if(diff < 0) { // full, still holds a message from the last lap
+			return false;
+		}
+		else { // claimed by another producer
+			pos = pushPos.load(std::memory_order_relaxed);
+		}
+	}
+	cell->message = message;
+	cell->sequence.store(pos+1, std::memory_order_release); // publish
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ofxRepl::LogQueue::pop(std::string &message) {
+	Cell &cell = cells[popPos & mask];
+	if(cell.sequence.load(std::memory_order_acquire) != popPos+1) {
+		return false; // empty or not published yet
+	}
+	message.swap(cell.message); // hand the old buffer back to the cell for reuse
+	cell.sequence.store(popPos+mask+1, std::memory_order_release); // free for the next lap
+	popPos++;
+	return true;
+}
+
 // OTHER UTIL
 
 //--------------------------------------------------------------
@@ -458,3 +1276,26 @@ bool isEmpty(u32string s) {
 	}
 	return true;
 }
+
+//--------------------------------------------------------------
+std::string formatCount(uint64_t count) {
+	std::string digits = ofToString(count), s;
+	for(size_t i = 0; i < digits.size(); ++i) {
+		if(i > 0 && (digits.size() - i) % 3 == 0) {
+			s += ',';
+		}
+		s += digits[i];
+	}
+	return s;
+}
+
+//--------------------------------------------------------------
+std::string formatBytes(uint64_t bytes) {
+	if(bytes < 1024) {
+		return ofToString(bytes) + " bytes";
+	}
+	else if(bytes < 1024 * 1024) {
+		return ofToString(bytes / 1024.0, 1) + " KB";
+	}
+	return ofToString(bytes / (1024.0 * 1024.0), 1) + " MB";
+}
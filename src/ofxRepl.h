@@ -23,6 +23,12 @@
 #pragma once
 
 #include "ofxEditor.h"
+#include "ofxEditorEvalQueue.h"
+#include "ofxEditorHistory.h"
+
+#include <atomic>
+#include <deque>
+#include <fstream>
 
 /// repl event listener
 class ofxReplListener {
@@ -32,6 +38,15 @@ class ofxReplListener {
 		/// this event is triggered when Enter is pressed in the Repl console
 		/// returns the text to be evaluated
 		virtual void evalReplEvent(const std::string &text) = 0;
+	
+		/// select where eval events are run, default: SYNC within the key event
+		///
+		/// DEFERRED & WORKER evals are queued & the next prompt is printed right
+		/// away, the eval return is printed above the prompt when it arrives,
+		/// on a WORKER use ofLog for output & don't touch the editor otherwise
+		virtual ofxEditorEvalQueue::Executor getEvalExecutor() {
+			return ofxEditorEvalQueue::SYNC;
+		}
 };
 
 /// Read-eval-print Loop
@@ -49,6 +64,44 @@ class ofxRepl : public ofxEditor {
 		/// prints greeting and first prompt
 		/// set listener to receive eval events
 		void setup(ofxReplListener *listener);
+	
+		/// draw the repl, prints any queued log messages, eval results, &
+		/// pending output first
+		void draw();
+	
+		/// start the next queued eval & print the finished eval results,
+		/// main thread only, called by draw()
+		void flushEval();
+	
+		/// cancel the running & queued evals, a running eval can't be
+		/// interrupted so its result is dropped when it returns
+		void cancelEval();
+	
+		/// set/get the eval queue, share one queue between the repl & editor
+		/// scripts so all evals run in order
+		void setEvalQueue(std::shared_ptr<ofxEditorEvalQueue> queue);
+		std::shared_ptr<ofxEditorEvalQueue> getEvalQueue();
+	
+		/// commit the pending console output now, main thread only
+		///
+		/// printed text is collected & committed once per frame by draw(),
+		/// on key events, before the next prompt, or once it reaches 64K
+		/// chars, so a script printing many lines only updates the text
+		/// buffer & syntax blocks once
+		void flushOutput();
+	
+		/// print the log messages queued by the logger since the last call,
+		/// main thread only
+		///
+		/// log messages from any thread are queued without locking & printed
+		/// once per frame by draw() so other threads never modify the text
+		/// buffer, this is also called before printing an eval return so log
+		/// messages from the eval come first
+		void flushLog();
+	
+		/// get the number of log messages dropped because the log queue was
+		/// full, ie. a worker thread logging faster than the frame rate
+		unsigned int getNumDroppedLogMessages();
 		
 		/// handles key events
 		///
@@ -58,6 +111,13 @@ class ofxRepl : public ofxEditor {
 		/// MOD + a + SHIFT: clear console
 		/// MOD + c + SHIFT: clear console history
 		///
+		/// MOD + . : cancel running & queued evals
+		///
+		/// MOD + r: reverse search the command history, type to search,
+		///          MOD + r again for the next older match, BACKSPACE edits
+		///          the search, ESC restores the line & any other key keeps
+		///          the match, ie. RETURN to eval it
+		///
 		/// UP & DOWN: step through command history
 		/// RETURN: eval current command
 		///
@@ -65,7 +125,7 @@ class ofxRepl : public ofxEditor {
 		///
 		void keyPressed(int key);
 		
-		/// add a wide string to the console,
+		/// add a wide string to the console, see flushOutput() & the output budget
 		/// set beforePrompt to true to print a line above the current prompt
 		void print(const std::u32string &what, bool beforePrompt=false);
 	
@@ -73,18 +133,103 @@ class ofxRepl : public ofxEditor {
 		/// set beforePrompt to true to print a line above the current prompt
 		void print(const std::string &what, bool beforePrompt=false);
 		
-		/// add a wide string to the console and print a return after
-		void printEvalReturn(const std::u32string &what);
+		/// add a wide string to the console and print a return after,
+		/// queued evals return via the eval queue & can call this from any
+		/// thread
+		///
+		/// set id to return a queued eval after its handler exits, see
+		/// ofxEditorEvalQueue::getCurrentId()
+		void printEvalReturn(const std::u32string &what, unsigned int id=0);
 	
-		/// add a string to the console and print a return after with string conversion
-		void printEvalReturn(const std::string &what);
+		/// add a string to the console and print a return after with string
+		/// conversion, see above
+		void printEvalReturn(const std::string &what, unsigned int id=0);
 		
 		/// clear the console
 		void clearText();
 		
-		/// clear the command history
+		/// clear the command history, also empties the history file
 		void clearHistory();
 	
+		/// set the command history file to load from & append to, relative to
+		/// the data path, "" for none, returns false if it couldn't be opened
+		///
+		/// the file is loaded in the background & read on first use, entries
+		/// are appended as they are evaluated
+		bool setHistoryFile(const std::string &path);
+		std::string getHistoryFile();
+	
+		/// set/get the max number of command history entries, default 10000
+		void setMaxHistorySize(size_t size);
+		size_t getMaxHistorySize();
+	
+		/// free memory by removing the oldest half of the console lines above
+		/// the prompt & the oldest half of the command history,
+		/// returns false if there was nothing to remove
+		bool trimScrollback();
+	
+		/// set/get the max number of console lines, 0 for no limit, default 256
+		///
+		/// when exceeded, the oldest lines are evicted down to 3/4 of the
+		/// capacity at once so the cost is spread over many prints
+		void setMaxScrollbackLines(unsigned int lines);
+		unsigned int getMaxScrollbackLines();
+	
+		/// set/get the max console text size in bytes, 0 for no limit,
+		/// default 0, evicts lines the same way as the line capacity
+		void setMaxScrollbackBytes(size_t bytes);
+		size_t getMaxScrollbackBytes();
+	
+		/// set/get the max number of output lines printed per frame,
+		/// 0 for no limit, default 0
+		///
+		/// when over budget, printed & logged lines are dropped & summarized
+		/// with a "... N lines suppressed" line once the flood stops or once
+		/// a second while it continues, eval returns are always printed
+		void setMaxOutputLinesPerFrame(unsigned int lines);
+		unsigned int getMaxOutputLinesPerFrame();
+	
+		/// set/get the max number of output lines printed per second,
+		/// 0 for no limit, default 0, suppresses output like the frame budget
+		void setMaxOutputLinesPerSecond(unsigned int lines);
+		unsigned int getMaxOutputLinesPerSecond();
+	
+		/// get the total number of output lines suppressed since startup
+		uint64_t getNumSuppressedLines();
+	
+		/// set a file to append all printed output to, including suppressed
+		/// lines, relative to the data path, "" to close, returns false if
+		/// the file couldn't be opened
+		bool setOutputSpillFile(const std::string &path);
+		std::string getOutputSpillFile();
+	
+		/// set/get the max size of a single output printed to the console,
+		/// 0 for no limit, default 256 lines & 64K chars
+		///
+		/// a larger print, log flush, or eval return is stored out of the text
+		/// buffer & only a preview of its first lines is printed, followed by
+		/// "... [output N: lines, size]", see getStoredOutput()
+		void setMaxInlineOutput(unsigned int lines, size_t chars);
+		unsigned int getMaxInlineOutputLines();
+		size_t getMaxInlineOutputChars();
+	
+		/// set/get the max memory used by stored outputs in bytes, the oldest
+		/// are dropped when over except for the newest, default 64 MB
+		void setMaxStoredOutputBytes(size_t bytes);
+		size_t getMaxStoredOutputBytes();
+	
+		/// get the full text of a stored output by id, returns false if the id
+		/// is unknown or the output was dropped
+		bool getStoredOutput(unsigned int id, std::u32string &text);
+	
+		/// get the id of the stored output preview on the cursor line or the
+		/// newest stored output otherwise, 0 if there are none
+		unsigned int getStoredOutputId();
+	
+		/// get the memory used by the repl, the console text & command history
+		/// are counted as scrollback
+		MemoryUsage getMemoryUsage();
+	
 		bool openFile(std::string filename); //< dummy implementation
 		bool saveFile(std::string filename); //< dummy implementation
 
@@ -109,8 +254,58 @@ class ofxRepl : public ofxEditor {
 		void historyPrev();
 		void historyNext();
 		void historyClear();
-		void historyShow(std::u32string what);
+		void historyShow(const std::u32string &what);
+	
+		/// start a reverse history search or find the next older match
+		void historySearch();
+	
+		/// find the newest match before an index & show it
+		void historySearchFind(size_t before);
+	
+		/// handle a key while searching, returns false if the key ended the
+		/// search & should be handled as usual
+		bool historySearchKeyPressed(int key);
+	
+		/// end the search, keeps the match if accept is true or restores the
+		/// line otherwise
+		void historySearchEnd(bool accept);
 		void keepCursorVisible();
+	
+		/// evict the oldest lines if over the scrollback capacity
+		void evictScrollback();
+	
+		/// erase the text before pos, a line start before the prompt line,
+		/// & shift the prompt positions
+		void eraseScrollback(unsigned int pos);
+	
+		/// get the start of the current prompt line
+		unsigned int promptLineStart();
+	
+		/// draw the eval or history search status after the cursor
+		void drawCursor(int x, int y);
+	
+		/// add text to the pending output without the output budget,
+		/// set spill to false if it was already written to the spill file
+		void queueOutput(const std::u32string &what, bool beforePrompt, bool spill=true);
+	
+		/// get the number of output lines left in the frame & second budget,
+		/// UINT_MAX if there is no limit
+		unsigned int outputBudget();
+	
+		/// print the suppressed output marker when due
+		void flushSuppressed();
+	
+		/// append text to the spill file, if open
+		void spillOutput(const std::u32string &what);
+	
+		/// add text to the pending output as is
+		void appendOutput(const std::u32string &what, bool beforePrompt);
+	
+		/// returns true if text is over the max inline output size
+		bool isLargeOutput(const std::u32string &what);
+	
+		/// store text out of the text buffer, returns the preview to print
+		std::u32string storeOutput(const std::u32string &what);
 
 		ofxReplListener *m_listener; //< eval event listener
 		
@@ -119,23 +314,102 @@ class ofxRepl : public ofxEditor {
 
 		std::u32string m_evalText; //< text to be evaluated when enter is pressed
 		
-		deque<std::u32string> m_history; //< line history
-		deque<std::u32string>::iterator m_historyIter; //< current position in line history
+		ofxEditorHistory m_history; //< line history
+		size_t m_historyPos; //< current position in line history, size() for live input
 		bool m_historyNavStarted; //< is the cursor within the line history?
 		std::u32string m_historyPresent; //< current history line (aka live input)
+		bool m_historySearching; //< is a reverse history search active?
+		std::u32string m_historyQuery; //< reverse history search text
+		size_t m_historyMatch; //< current search match, size() for none
+		bool m_historySearchFailed; //< did the last search fail?
 		unsigned int m_linePos; //< current line the cursor is on
 	
+		unsigned int m_maxScrollbackLines; //< max console lines, 0 for no limit
+		size_t m_maxScrollbackBytes; //< max console text bytes, 0 for no limit
+	
+		std::u32string m_output; //< pending console output
+		bool m_outputBeforePrompt; //< print pending output above the prompt?
+	
+		unsigned int m_maxOutputLinesPerFrame; //< frame output budget, 0 for none
+		unsigned int m_maxOutputLinesPerSecond; //< second output budget, 0 for none
+		uint64_t m_outputFrame; //< frame of the frame line count
+		unsigned int m_outputFrameLines; //< lines printed this frame
+		uint64_t m_outputSecond; //< start of the second line count in ms
+		unsigned int m_outputSecondLines; //< lines printed this second
+	
+		bool m_suppressing; //< has output been suppressed since the last marker?
+		uint64_t m_suppressedLines; //< lines suppressed since the last marker
+		uint64_t m_suppressedFrame; //< last frame with suppressed output
+		uint64_t m_suppressedMarkerTime; //< last marker time in ms
+		bool m_suppressedBeforePrompt; //< print the marker above the prompt?
+		uint64_t m_numSuppressedLines; //< total suppressed lines
+	
+		std::ofstream m_spillFile; //< output spill file
+		std::string m_spillPath; //< output spill file path, "" if not open
+		bool m_spillDirty; //< spill file written since the last flush?
+	
+		/// output stored out of the text buffer
+		struct StoredOutput {
+			unsigned int id;  //< unique id, starting at 1
+			std::string text; //< UTF-8 text
+		};
+		std::deque<StoredOutput> m_storedOutputs; //< oldest first
+		size_t m_storedOutputBytes; //< total stored output text size
+		size_t m_maxStoredOutputBytes; //< max stored output bytes
+		unsigned int m_nextOutputId; //< next stored output id
+		unsigned int m_maxInlineOutputLines; //< max output lines, 0 for no limit
+		size_t m_maxInlineOutputChars; //< max output chars, 0 for no limit
+	
+		std::shared_ptr<ofxEditorEvalQueue> m_evalQueue; //< queued evals
+		std::string m_status; //< eval or search status draw buffer
+	
 		static std::u32string s_banner; //< REPL header/greeting, default: ""
 		static std::u32string s_prompt; //< prompt string, default: "> "
 		
 	private:
 
-		/// custom logger to grab prints in the REPL
+		/// bounded lock-free multi producer, single consumer message queue,
+		/// producers never block & fail when the queue is full
+		class LogQueue {
+			public:
+				LogQueue(unsigned int size); //< size is rounded up to a power of 2
+				
+				/// push a message from any thread, returns false if full
+				bool push(const std::string &message);
+				
+				/// pop the oldest message, consumer thread only,
+				/// returns false if empty
+				bool pop(std::string &message);
+				
+			private:
+				/// queue cell, holds a message for the current lap when
+				/// sequence is one ahead of its position
+				struct Cell {
+					std::atomic<size_t> sequence;
+					std::string message;
+				};
+				std::unique_ptr<Cell[]> cells;
+				size_t mask; //< cell index mask
+				std::atomic<size_t> pushPos; //< next push position
+				size_t popPos; //< next pop position
+		};
+
+		/// custom logger to grab prints in the REPL, messages are queued
+		/// & printed by the repl on the main thread
 		class Logger : public ofConsoleLoggerChannel {
-		public:
-			ofxRepl *m_parent;
-			void log(ofLogLevel level, const std::string & module, const std::string & message);
-			void log(ofLogLevel level, const std::string & module, const char* format, va_list args);
+			public:
+				Logger();
+				void log(ofLogLevel level, const std::string & module, const std::string & message);
+				void log(ofLogLevel level, const std::string & module, const char* format, va_list args);
+				
+				/// queue a message, counts a drop if the queue is full
+				void push(const std::string &message);
+				
+				LogQueue queue; //< pending messages
+				std::atomic<unsigned int> dropped; //< dropped messages
 		};
 		std::shared_ptr<Logger> m_logger;
+		unsigned int m_logDropped; //< dropped messages already reported
+		std::string m_logMessage; //< flushLog() message buffer
+		std::u32string m_logText; //< flushLog() text buffer
 };